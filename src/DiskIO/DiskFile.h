@@ -27,13 +27,23 @@ public:
     class Config
     {
     public:
-        Config(): ioTimeout(0), ioRate(-1) {}
+        Config(): ioTimeout(0), ioRate(-1), ioQueueDepth(1), directIo(false) {}
 
         /// canRead/Write should return false if expected I/O delay exceeds it
         time_msec_t ioTimeout; // not enforced if zero, which is the default
 
         /// shape I/O request stream to approach that many per second
         int ioRate; // not enforced if negative, which is the default
+
+        /// keep up to that many I/O requests in flight
+        int ioQueueDepth; // one (i.e. no concurrent I/O) by default
+
+        /// bypass OS caches using O_DIRECT
+        bool directIo;
+
+        /// the file offset, I/O size, and buffer address alignment we use for
+        /// directIo; must be a multiple of the device logical block size
+        static constexpr size_t DirectIoAlignment = 4096;
     };
 
     typedef RefCount<DiskFile> Pointer;
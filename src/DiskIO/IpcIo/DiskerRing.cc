@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 47    Store Directory Routines */
+
+#include "squid.h"
+
+#if USE_IO_URING
+
+#include "base/TextException.h"
+#include "debug/Stream.h"
+#include "DiskIO/IpcIo/DiskerRing.h"
+#include "sbuf/Stream.h"
+
+#include <cerrno>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+IpcIo::DiskerRing::DiskerRing(const unsigned int depth):
+    ring(depth)
+{
+    // IORING_OP_READ and IORING_OP_WRITE appeared after io_uring itself
+    for (const auto op: {IORING_OP_READ, IORING_OP_WRITE}) {
+        if (!ring.supports(op))
+            throw TextException(ToSBuf("io_uring lacks support for operation ", static_cast<int>(op)), Here());
+    }
+
+    eventFd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+    if (eventFd < 0)
+        throw TextException(ToSBuf("eventfd(2) failure: ", xstrerr(errno)), Here());
+    if (syscall(__NR_io_uring_register, ring.fd(), IORING_REGISTER_EVENTFD, &eventFd, 1) < 0) {
+        const auto xerrno = errno;
+        close(eventFd); // the destructor is not called when the constructor throws
+        throw TextException(ToSBuf("io_uring eventfd registration failure: ", xstrerr(xerrno)), Here());
+    }
+
+    debugs(47, 2, "submission queue entries: " << ring.submissionQueueSize() << ", completion queue entries: " << ring.completionQueueSize());
+}
+
+IpcIo::DiskerRing::~DiskerRing()
+{
+    if (eventFd >= 0)
+        close(eventFd);
+}
+
+void
+IpcIo::DiskerRing::read(const int fd, char * const buf, const size_t size, const off_t offset, const uint64_t tag)
+{
+    auto &sqe = ring.nextSqe();
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(buf);
+    sqe.len = size;
+    sqe.off = offset;
+    sqe.user_data = tag;
+}
+
+void
+IpcIo::DiskerRing::write(const int fd, const char * const buf, const size_t size, const off_t offset, const uint64_t tag)
+{
+    auto &sqe = ring.nextSqe();
+    sqe.opcode = IORING_OP_WRITE;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(buf);
+    sqe.len = size;
+    sqe.off = offset;
+    sqe.user_data = tag;
+}
+
+void
+IpcIo::DiskerRing::submit()
+{
+    ring.submit();
+}
+
+void
+IpcIo::DiskerRing::wait()
+{
+    submit();
+    while (!ring.hasCompletions()) {
+        if (ring.enter(1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) {
+            const auto xerrno = errno;
+            if (xerrno != EINTR)
+                throw TextException(ToSBuf("io_uring_enter(2) failure: ", xstrerr(xerrno)), Here());
+        }
+    }
+}
+
+unsigned int
+IpcIo::DiskerRing::reap(const CompletionHandler handler)
+{
+    unsigned int count = 0;
+    while (ring.hasCompletions()) {
+        const auto cqe = ring.frontCompletion(); // a copy; the slot is reused below
+        ring.popCompletion();
+        ++count;
+        handler(cqe.user_data, cqe.res);
+    }
+    return count;
+}
+
+void
+IpcIo::DiskerRing::clearCompletionSignal()
+{
+    eventfd_t ignored;
+    (void)eventfd_read(eventFd, &ignored); // fails with EAGAIN if there was no signal
+}
+
+#endif /* USE_IO_URING */
+
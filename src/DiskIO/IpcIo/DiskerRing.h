@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_DISKIO_IPCIO_DISKERRING_H
+#define SQUID_SRC_DISKIO_IPCIO_DISKERRING_H
+
+#if USE_IO_URING
+
+#include "ipc/IoUringRing.h"
+
+#include <cstdint>
+
+namespace IpcIo
+{
+
+/// An io_uring(7) instance that lets a disker keep many reads and writes in
+/// flight. Requests are identified by caller-supplied tags. The kernel signals
+/// completions via an eventfd(2) descriptor that the caller should monitor.
+class DiskerRing
+{
+public:
+    /// creates a ring for at most depth concurrent requests; throws if the
+    /// running kernel cannot give us a usable ring
+    explicit DiskerRing(unsigned int depth);
+    ~DiskerRing();
+
+    DiskerRing(DiskerRing &&) = delete; // no copying or moving of any kind
+
+    /// queues a pread(2)-like request
+    void read(int fd, char *buf, size_t size, off_t offset, uint64_t tag);
+
+    /// queues a pwrite(2)-like request
+    void write(int fd, const char *buf, size_t size, off_t offset, uint64_t tag);
+
+    /// passes all queued requests to the kernel
+    void submit();
+
+    /// blocks until at least one request completes
+    void wait();
+
+    /// handles a completed request given its tag and the number of bytes
+    /// transferred (or a negated errno value); may queue more requests
+    using CompletionHandler = void (*)(uint64_t tag, int result);
+
+    /// calls the handler for each completed request
+    /// \returns the number of completed requests
+    unsigned int reap(CompletionHandler);
+
+    /// an eventfd(2) descriptor that becomes readable when requests complete
+    int completionFd() const { return eventFd; }
+
+    /// clears the completionFd() readiness state
+    void clearCompletionSignal();
+
+    /// the number of io_uring_enter(2) calls made so far
+    uint64_t enterCalls() const { return ring.enterCalls; }
+
+private:
+    Ipc::IoUringRing ring; ///< the submission and completion queues
+    int eventFd = -1; ///< eventfd(2) result registered with the ring
+};
+
+} // namespace IpcIo
+
+#endif /* USE_IO_URING */
+
+#endif /* SQUID_SRC_DISKIO_IPCIO_DISKERRING_H */
+
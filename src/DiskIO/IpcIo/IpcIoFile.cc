@@ -13,7 +13,10 @@
 #include "base/CodeContext.h"
 #include "base/RunnersRegistry.h"
 #include "base/TextException.h"
+#include "comm/Loops.h"
 #include "DiskIO/IORequestor.h"
+#include "DiskIO/IpcIo/DiskerRing.h"
+#include "DiskIO/IpcIo/ReplyOrder.h"
 #include "DiskIO/IpcIo/IpcIoFile.h"
 #include "DiskIO/ReadRequest.h"
 #include "DiskIO/WriteRequest.h"
@@ -28,11 +31,14 @@
 #include "ipc/StrandSearch.h"
 #include "ipc/UdsOp.h"
 #include "sbuf/SBuf.h"
+#include "sbuf/Stream.h"
 #include "SquidConfig.h"
 #include "StatCounters.h"
 #include "tools.h"
 
 #include <cerrno>
+#include <cstdlib>
+#include <vector>
 
 CBDATA_CLASS_INIT(IpcIoFile);
 
@@ -51,8 +57,9 @@ std::unique_ptr<IpcIoFile::Queue> IpcIoFile::queue;
 
 bool IpcIoFile::DiskerHandleMoreRequestsScheduled = false;
 
-static bool DiskerOpen(const SBuf &path, int flags, mode_t mode);
+static bool DiskerOpen(const SBuf &path, int flags, mode_t mode, const DiskFile::Config &);
 static void DiskerClose(const SBuf &path);
+static void DiskerStat(std::ostream &);
 
 /// IpcIo wrapper for debugs() streams; XXX: find a better class name
 struct SipcIo {
@@ -137,10 +144,12 @@ IpcIoFile::open(int flags, mode_t mode, RefCount<IORequestor> callback)
     }
 
     if (IamDiskProcess()) {
-        error_ = !DiskerOpen(SBuf(dbName.termedBuf()), flags, mode);
+        error_ = !DiskerOpen(SBuf(dbName.termedBuf()), flags, mode, config);
         if (error_)
             return;
 
+        DiskerStartIo(config);
+
         diskId = KidIdentifier;
         const bool inserted =
             IpcIoFiles.insert(std::make_pair(diskId, this)).second;
@@ -207,8 +216,10 @@ IpcIoFile::close()
 {
     assert(ioRequestor != nullptr);
 
-    if (IamDiskProcess())
+    if (IamDiskProcess()) {
+        DiskerStopIo();
         DiskerClose(SBuf(dbName.termedBuf()));
+    }
     // XXX: else nothing to do?
 
     ioRequestor->closeCompleted();
@@ -551,6 +562,9 @@ IpcIoFile::StatQueue(std::ostream &os)
         os << "SMP disk I/O queues:\n";
         queue->stat<IpcIoMsg>(os);
     }
+
+    if (IamDiskProcess())
+        DiskerStat(os);
 }
 
 /// handles open request timeout
@@ -729,98 +743,299 @@ IpcIoPendingRequest::completeIo(IpcIoMsg *const response)
 static SBuf DbName; ///< full db file name
 static int TheFile = -1; ///< db file descriptor
 
+/// a disker I/O request being executed
+class DiskerIo
+{
+public:
+    int workerId = 0; ///< the kid ID of the requesting worker
+    IpcIoMsg msg; ///< the request and, eventually, the response
+    timeval start = {}; ///< when the disker started executing the request
+
+    char *buf = nullptr; ///< the next byte to read into or write from
+    off_t offset = 0; ///< the file offset of the buf[0] byte
+    size_t size = 0; ///< the number of bytes left to read or write
+    size_t skipped = 0; ///< leading bytes read only to meet O_DIRECT alignment
+    size_t wroteSoFar = 0; ///< the number of bytes written so far
+    int attempts = 0; ///< the number of write attempts made so far
+
+    /// an aligned O_DIRECT buffer for page contents (or nil)
+    char *directBuf = nullptr;
+};
+
+/// disker I/O requests being executed, indexed by DiskerRing tags
+static std::vector<DiskerIo> DiskerIos;
+
+/// the DiskerIos indexes available for new requests
+static std::vector<size_t> IdleDiskerIos;
+
+/// finished DiskerIos waiting for earlier requests of the same worker;
+/// these stay out of IdleDiskerIos (see ReplyOrder about blocking costs)
+static IpcIo::ReplyOrder DiskerReplies;
+
+#if USE_IO_URING
+/// executes DiskerIos concurrently (or nil for synchronous I/O)
+static std::unique_ptr<IpcIo::DiskerRing> TheRing;
+#endif
+
+/// disker I/O statistics; suitable for cache manager reports
+class DiskerIoStats
+{
+public:
+    void noteStart(const size_t inFlight);
+    void noteFinish(const DiskerIo &);
+    void dump(std::ostream &) const;
+
+    uint64_t started = 0; ///< the number of I/O requests we started
+    uint64_t reads = 0; ///< the number of finished read requests
+    uint64_t writes = 0; ///< the number of finished write requests
+    uint64_t errors = 0; ///< the number of failed requests
+    uint64_t inFlightSum = 0; ///< the sum of requests in flight seen by started ones
+    size_t maxInFlight = 0; ///< the maximum number of requests in flight
+    uint64_t latencySum = 0; ///< the sum of request execution times (usec)
+    int maxLatency = 0; ///< the longest request execution time (usec)
+};
+
+static DiskerIoStats TheDiskerIoStats;
+
+void
+DiskerIoStats::noteStart(const size_t inFlight)
+{
+    ++started;
+    inFlightSum += inFlight;
+    maxInFlight = max(maxInFlight, inFlight);
+}
+
+void
+DiskerIoStats::noteFinish(const DiskerIo &io)
+{
+    if (io.msg.command == IpcIo::cmdRead)
+        ++reads;
+    else
+        ++writes;
+
+    if (io.msg.xerrno)
+        ++errors;
+
+    const auto latency = max(0, tvSubUsec(io.start, current_time));
+    latencySum += latency;
+    maxLatency = max(maxLatency, latency);
+}
+
+void
+DiskerIoStats::dump(std::ostream &os) const
+{
+    const auto finished = reads + writes;
+    os << "\tI/O requests: " << started << " started, " <<
+       reads << " reads and " << writes << " writes finished, " <<
+       errors << " failed\n";
+    os << "\tI/O requests in flight: " << (DiskerIos.size() - IdleDiskerIos.size()) <<
+       " now, " << maxInFlight << " max, " <<
+       (started ? static_cast<double>(inFlightSum)/started : 0.0) << " mean\n";
+    os << "\tI/O replies waiting for earlier requests: " << DiskerReplies.held() << "\n";
+    os << "\tI/O request execution time: " <<
+       (finished ? latencySum/1e3/finished : 0.0) << " msec mean, " <<
+       (maxLatency/1e3) << " msec max\n";
+}
+
+/// reports disker I/O configuration and statistics
 static void
-diskerRead(IpcIoMsg &ipcIo)
+DiskerStat(std::ostream &os)
 {
-    if (!Ipc::Mem::GetPage(Ipc::Mem::PageId::ioPage, ipcIo.page)) {
-        ipcIo.len = 0;
-        debugs(47,2, "run out of shared memory pages for IPC I/O");
-        return;
+    if (DiskerIos.empty())
+        return; // no open db file
+
+    os << "\nSMP disker I/O:\n";
+    os << "\tI/O queue depth: " << DiskerIos.size() <<
+#if USE_IO_URING
+       (TheRing ? " (io_uring)" : "") <<
+#endif
+       (DiskerIos.front().directBuf ? ", O_DIRECT" : "") << "\n";
+    TheDiskerIoStats.dump(os);
+#if USE_IO_URING
+    if (TheRing)
+        os << "\tio_uring_enter(2) calls: " << TheRing->enterCalls() << "\n";
+#endif
+}
+
+/// the smallest multiple of O_DIRECT alignment that is at least n
+static size_t
+DirectIoRoundUp(const size_t n)
+{
+    const auto alignment = DiskFile::Config::DirectIoAlignment;
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+/// Sets the buffer, offset, and size of the system call needed to execute the
+/// given request. Sets request results instead if the request cannot be
+/// executed. \returns whether the request should be executed
+static bool
+diskerPrepare(DiskerIo &io)
+{
+    auto &ipcIo = io.msg;
+    io.skipped = 0;
+    io.wroteSoFar = 0;
+    io.attempts = 0;
+
+    if (ipcIo.command == IpcIo::cmdRead) {
+        if (!Ipc::Mem::GetPage(Ipc::Mem::PageId::ioPage, ipcIo.page)) {
+            ipcIo.len = 0;
+            debugs(47,2, "run out of shared memory pages for IPC I/O");
+            return false;
+        }
+
+        const auto toRead = min(ipcIo.len, Ipc::Mem::PageSize());
+        if (io.directBuf) {
+            // read aligned blocks that include the requested bytes
+            io.skipped = ipcIo.offset % DiskFile::Config::DirectIoAlignment;
+            io.buf = io.directBuf;
+            io.offset = ipcIo.offset - io.skipped;
+            io.size = DirectIoRoundUp(io.skipped + toRead);
+        } else {
+            io.buf = Ipc::Mem::PagePointer(ipcIo.page);
+            io.offset = ipcIo.offset;
+            io.size = toRead;
+        }
+        return true;
+    }
+
+    // ipcIo.command == IpcIo::cmdWrite
+    const auto toWrite = min(ipcIo.len, Ipc::Mem::PageSize());
+    if (io.directBuf) {
+        if (ipcIo.offset % DiskFile::Config::DirectIoAlignment) {
+            ipcIo.xerrno = EINVAL;
+            ipcIo.len = 0;
+            debugs(47, DBG_IMPORTANT, "ERROR: " << DbName << " cannot write " <<
+                   toWrite << " bytes at unaligned offset " << ipcIo.offset << " using O_DIRECT");
+            return false;
+        }
+        // pad the last block; callers do not store anything after the data
+        io.size = DirectIoRoundUp(toWrite);
+        memcpy(io.directBuf, Ipc::Mem::PagePointer(ipcIo.page), toWrite);
+        memset(io.directBuf + toWrite, 0, io.size - toWrite);
+        io.buf = io.directBuf;
+    } else {
+        io.buf = Ipc::Mem::PagePointer(ipcIo.page);
+        io.size = toWrite;
     }
+    io.offset = ipcIo.offset;
+    return true;
+}
 
-    char *const buf = Ipc::Mem::PagePointer(ipcIo.page);
-    const ssize_t read = pread(TheFile, buf, min(ipcIo.len, Ipc::Mem::PageSize()), ipcIo.offset);
+/// sets read request results based on a pread(2)-like call result
+static void
+diskerNoteRead(DiskerIo &io, const ssize_t read, const int xerrno)
+{
+    auto &ipcIo = io.msg;
     ++statCounter.syscalls.disk.reads;
     fd_bytes(TheFile, read, IoDirection::Read);
 
     if (read >= 0) {
         ipcIo.xerrno = 0;
-        const size_t len = static_cast<size_t>(read); // safe because read > 0
+        const auto toRead = min(ipcIo.len, Ipc::Mem::PageSize());
+        const auto readNow = static_cast<size_t>(read); // safe because read >= 0
+        const auto len = readNow > io.skipped ? min(readNow - io.skipped, toRead) : 0;
+        if (io.directBuf)
+            memcpy(Ipc::Mem::PagePointer(ipcIo.page), io.directBuf + io.skipped, len);
         debugs(47,8, "disker" << KidIdentifier << " read " <<
-               (len == ipcIo.len ? "all " : "just ") << read);
+               (len == ipcIo.len ? "all " : "just ") << len);
         ipcIo.len = len;
     } else {
-        ipcIo.xerrno = errno;
+        ipcIo.xerrno = xerrno;
         ipcIo.len = 0;
         debugs(47,5, "disker" << KidIdentifier << " read error: " <<
                ipcIo.xerrno);
     }
 }
 
-/// Tries to write buffer to disk (a few times if needed);
-/// sets ipcIo results, but does no cleanup. The caller must cleanup.
-static void
-diskerWriteAttempts(IpcIoMsg &ipcIo)
-{
-    const char *buf = Ipc::Mem::PagePointer(ipcIo.page);
-    size_t toWrite = min(ipcIo.len, Ipc::Mem::PageSize());
-    size_t wroteSoFar = 0;
-    off_t offset = ipcIo.offset;
-    // Partial writes to disk do happen. It is unlikely that the caller can
-    // handle partial writes by doing something other than writing leftovers
-    // again, so we try to write them ourselves to minimize overheads.
-    const int attemptLimit = 10;
-    for (int attempts = 1; attempts <= attemptLimit; ++attempts) {
-        const ssize_t result = pwrite(TheFile, buf, toWrite, offset);
-        ++statCounter.syscalls.disk.writes;
-        fd_bytes(TheFile, result, IoDirection::Write);
-
-        if (result < 0) {
-            ipcIo.xerrno = errno;
-            assert(ipcIo.xerrno);
-            debugs(47, DBG_IMPORTANT, "ERROR: " << DbName << " failure" <<
-                   " writing " << toWrite << '/' << ipcIo.len <<
-                   " at " << ipcIo.offset << '+' << wroteSoFar <<
-                   " on " << attempts << " try: " << xstrerr(ipcIo.xerrno));
-            ipcIo.len = wroteSoFar;
-            return; // bail on error
-        }
-
-        const size_t wroteNow = static_cast<size_t>(result); // result >= 0
-        ipcIo.xerrno = 0;
+/// Sets write request results based on a pwrite(2)-like call result. Partial
+/// writes to disk do happen. It is unlikely that the caller can handle partial
+/// writes by doing something other than writing leftovers again, so we try to
+/// write them ourselves (a few times if needed) to minimize overheads.
+/// \returns whether the request needs another write attempt
+static bool
+diskerNoteWrite(DiskerIo &io, const ssize_t result, const int xerrno)
+{
+    auto &ipcIo = io.msg;
+    ++statCounter.syscalls.disk.writes;
+    fd_bytes(TheFile, result, IoDirection::Write);
+    ++io.attempts;
+
+    const auto toWrite = min(ipcIo.len, Ipc::Mem::PageSize());
+    const auto attempts = io.attempts;
+
+    if (result < 0) {
+        ipcIo.xerrno = xerrno;
+        assert(ipcIo.xerrno);
+        debugs(47, DBG_IMPORTANT, "ERROR: " << DbName << " failure" <<
+               " writing " << io.size << '/' << ipcIo.len <<
+               " at " << ipcIo.offset << '+' << io.wroteSoFar <<
+               " on " << attempts << " try: " << xstrerr(ipcIo.xerrno));
+        ipcIo.len = min(io.wroteSoFar, toWrite);
+        return false; // bail on error
+    }
 
-        debugs(47,3, "disker" << KidIdentifier << " wrote " <<
-               (wroteNow >= toWrite ? "all " : "just ") << wroteNow <<
-               " out of " << toWrite << '/' << ipcIo.len << " at " <<
-               ipcIo.offset << '+' << wroteSoFar << " on " << attempts <<
-               " try");
+    const size_t wroteNow = static_cast<size_t>(result); // result >= 0
+    ipcIo.xerrno = 0;
 
-        wroteSoFar += wroteNow;
+    debugs(47,3, "disker" << KidIdentifier << " wrote " <<
+           (wroteNow >= io.size ? "all " : "just ") << wroteNow <<
+           " out of " << io.size << '/' << ipcIo.len << " at " <<
+           ipcIo.offset << '+' << io.wroteSoFar << " on " << attempts <<
+           " try");
 
-        if (wroteNow >= toWrite) {
-            ipcIo.xerrno = 0;
-            ipcIo.len = wroteSoFar;
-            return; // wrote everything there was to write
-        }
+    io.wroteSoFar += wroteNow;
 
-        buf += wroteNow;
-        offset += wroteNow;
-        toWrite -= wroteNow;
+    if (wroteNow >= io.size) {
+        ipcIo.len = min(io.wroteSoFar, toWrite);
+        return false; // wrote everything there was to write
     }
 
+    io.buf += wroteNow;
+    io.offset += wroteNow;
+    io.size -= wroteNow;
+
+    const int attemptLimit = 10;
+    if (attempts < attemptLimit)
+        return true;
+
     debugs(47, DBG_IMPORTANT, "ERROR: " << DbName << " exhausted all " <<
            attemptLimit << " attempts while writing " <<
-           toWrite << '/' << ipcIo.len << " at " << ipcIo.offset << '+' <<
-           wroteSoFar);
-    return; // not a fatal I/O error, unless the caller treats it as such
+           io.size << '/' << ipcIo.len << " at " << ipcIo.offset << '+' <<
+           io.wroteSoFar);
+    ipcIo.len = min(io.wroteSoFar, toWrite);
+    return false; // not a fatal I/O error, unless the caller treats it as such
+}
+
+/// executes the prepared request using blocking system calls
+static void
+diskerExecute(DiskerIo &io)
+{
+    if (io.msg.command == IpcIo::cmdRead) {
+        const auto result = pread(TheFile, io.buf, io.size, io.offset);
+        diskerNoteRead(io, result, errno);
+        return;
+    }
+
+    // ipcIo.command == IpcIo::cmdWrite
+    bool writeMore = true;
+    while (writeMore) {
+        const auto result = pwrite(TheFile, io.buf, io.size, io.offset);
+        writeMore = diskerNoteWrite(io, result, errno);
+    }
 }
 
+#if USE_IO_URING
+/// asks TheRing to execute the remaining part of the prepared request
 static void
-diskerWrite(IpcIoMsg &ipcIo)
+diskerSubmit(const size_t ioIndex)
 {
-    diskerWriteAttempts(ipcIo); // may fail
-    Ipc::Mem::PutPage(ipcIo.page);
+    auto &io = DiskerIos[ioIndex];
+    if (io.msg.command == IpcIo::cmdRead)
+        TheRing->read(TheFile, io.buf, io.size, io.offset, ioIndex);
+    else
+        TheRing->write(TheFile, io.buf, io.size, io.offset, ioIndex);
 }
+#endif
 
 void
 IpcIoFile::DiskerHandleMoreRequests(void *source)
@@ -904,7 +1119,7 @@ IpcIoFile::DiskerHandleRequests()
     int popped = 0;
     int workerId = 0;
     IpcIoMsg ipcIo;
-    while (!WaitBeforePop() && queue->pop(workerId, ipcIo)) {
+    while (!IdleDiskerIos.empty() && !WaitBeforePop() && queue->pop(workerId, ipcIo)) {
         ++popped;
 
         // at least one I/O per call is guaranteed if the queue is not empty
@@ -928,10 +1143,14 @@ IpcIoFile::DiskerHandleRequests()
         }
     }
 
-    // TODO: consider using O_DIRECT with "elevator" optimization where we pop
-    // requests first, then reorder the popped requests to optimize seek time,
-    // then do I/O, then take a break, and come back for the next set of I/O
-    // requests.
+    if (IdleDiskerIos.empty())
+        debugs(47, 5, "all " << DiskerIos.size() << " I/O slots are busy");
+
+#if USE_IO_URING
+    // the kernel reorders concurrent requests to optimize seek time
+    if (TheRing)
+        TheRing->submit();
+#endif
 }
 
 /// called when disker receives an I/O request
@@ -950,15 +1169,61 @@ IpcIoFile::DiskerHandleRequest(const int workerId, IpcIoMsg &ipcIo)
            ipcIo.len << " at " << ipcIo.offset <<
            " ipcIo" << workerId << '.' << ipcIo.requestId);
 
-    const auto workerPid = ipcIo.workerPid;
-    assert(workerPid >= 0);
+    assert(ipcIo.workerPid >= 0);
+
+    Must(!IdleDiskerIos.empty());
+    const auto ioIndex = IdleDiskerIos.back();
+    IdleDiskerIos.pop_back();
+    TheDiskerIoStats.noteStart(DiskerIos.size() - IdleDiskerIos.size());
+
+    auto &io = DiskerIos[ioIndex];
+    io.workerId = workerId;
+    io.msg = ipcIo;
+    io.start = current_time;
+    DiskerReplies.started(workerId, ioIndex);
 
-    if (ipcIo.command == IpcIo::cmdRead)
-        diskerRead(ipcIo);
-    else // ipcIo.command == IpcIo::cmdWrite
-        diskerWrite(ipcIo);
+    if (!diskerPrepare(io)) {
+        DiskerFinishIo(ioIndex);
+        return;
+    }
+
+#if USE_IO_URING
+    if (TheRing) {
+        diskerSubmit(ioIndex); // DiskerHandleRequests() submits to the kernel
+        return;
+    }
+#endif
+
+    diskerExecute(io);
+    getCurrentTime(); // for accurate request execution time stats
+    DiskerFinishIo(ioIndex);
+}
+
+/// cleans up after the finished I/O request and sends its results to the
+/// worker after the results of all earlier requests from that worker
+void
+IpcIoFile::DiskerFinishIo(const size_t ioIndex)
+{
+    auto &io = DiskerIos[ioIndex];
+    if (io.msg.command == IpcIo::cmdWrite)
+        Ipc::Mem::PutPage(io.msg.page);
+
+    TheDiskerIoStats.noteFinish(io);
+
+    // Concurrent I/Os may complete in any order, but workers expect replies
+    // in request order (e.g., Rock::IoState::handleWriteCompletion()).
+    DiskerReplies.finished(io.workerId, ioIndex, &IpcIoFile::DiskerReply);
+}
 
-    assert(ipcIo.workerPid == workerPid);
+/// sends the results of the finished I/O request to the worker
+/// and frees the I/O slot for new requests
+void
+IpcIoFile::DiskerReply(const size_t ioIndex)
+{
+    const auto &io = DiskerIos[ioIndex];
+    const auto workerId = io.workerId;
+    auto ipcIo = io.msg;
+    IdleDiskerIos.push_back(ioIndex);
 
     debugs(47, 7, "pushing " << SipcIo(workerId, ipcIo, KidIdentifier));
 
@@ -976,11 +1241,128 @@ IpcIoFile::DiskerHandleRequest(const int workerId, IpcIoMsg &ipcIo)
     }
 }
 
+#if USE_IO_URING
+/// DiskerRing::CompletionHandler for TheRing
+void
+IpcIoFile::DiskerIoCompleted(const uint64_t tag, const int result)
+{
+    Must(tag < DiskerIos.size());
+    const auto ioIndex = static_cast<size_t>(tag);
+    auto &io = DiskerIos[ioIndex];
+
+    const auto xerrno = result < 0 ? -result : 0;
+    if (io.msg.command == IpcIo::cmdRead) {
+        diskerNoteRead(io, result, xerrno);
+    } else if (diskerNoteWrite(io, result, xerrno)) {
+        diskerSubmit(ioIndex); // write the leftovers
+        return;
+    }
+
+    DiskerFinishIo(ioIndex);
+}
+
+/// comm handler for TheRing completion signals
+void
+IpcIoFile::DiskerHandleCompletions(const int fd, void *)
+{
+    Must(TheRing);
+    TheRing->clearCompletionSignal();
+    getCurrentTime(); // for accurate request execution time stats
+    const auto completed = TheRing->reap(&IpcIoFile::DiskerIoCompleted);
+    TheRing->submit(); // leftovers of partial writes, if any
+    debugs(47, 7, completed << " I/Os completed");
+    Comm::SetSelect(fd, COMM_SELECT_READ, &IpcIoFile::DiskerHandleCompletions, nullptr, 0);
+
+    // we stop popping requests when all I/O slots are busy
+    if (!DiskerHandleMoreRequestsScheduled)
+        DiskerHandleRequests();
+}
+#endif
+
+/// prepares to execute up to the configured number of concurrent I/O requests
+void
+IpcIoFile::DiskerStartIo(const DiskFile::Config &cfg)
+{
+    Must(DiskerIos.empty());
+
+    size_t depth = 1;
+    if (cfg.ioQueueDepth > 1) {
+#if USE_IO_URING
+        try {
+            TheRing.reset(new IpcIo::DiskerRing(cfg.ioQueueDepth));
+            depth = cfg.ioQueueDepth;
+            const auto fd = TheRing->completionFd();
+            fd_open(fd, FD_PIPE, "disker I/O completions");
+            Comm::SetSelect(fd, COMM_SELECT_READ, &IpcIoFile::DiskerHandleCompletions, nullptr, 0);
+        } catch (...) {
+            debugs(47, DBG_IMPORTANT, "WARNING: " << DbName << " cannot use io_uring" <<
+                   "; executing one I/O request at a time instead of " << cfg.ioQueueDepth <<
+                   Debug::Extra << "problem: " << CurrentException);
+        }
+#else
+        debugs(47, DBG_IMPORTANT, "WARNING: " << DbName << " io-queue-depth requires" <<
+               " ./configure --enable-io-uring; executing one I/O request at a time");
+#endif
+    }
+
+    DiskerIos.resize(depth);
+    for (size_t i = 0; i < depth; ++i) {
+        if (cfg.directIo) {
+            void *buf = nullptr;
+            const auto bufSize = Ipc::Mem::PageSize() + DiskFile::Config::DirectIoAlignment;
+            if (const auto xerrno = posix_memalign(&buf, DiskFile::Config::DirectIoAlignment, bufSize))
+                throw TextException(ToSBuf("cannot allocate an O_DIRECT buffer: ", xstrerr(xerrno)), Here());
+            DiskerIos[i].directBuf = static_cast<char*>(buf);
+        }
+        IdleDiskerIos.push_back(depth - i - 1); // so that we start with index 0
+    }
+
+    debugs(47, 2, DbName << " I/O queue depth: " << depth << (cfg.directIo ? ", using O_DIRECT" : ""));
+}
+
+/// waits for and cleans up after I/O requests in flight
+void
+IpcIoFile::DiskerStopIo()
+{
+#if USE_IO_URING
+    if (TheRing) {
+        auto inFlight = DiskerIos.size() - IdleDiskerIos.size();
+        if (inFlight)
+            debugs(47, 3, "waiting for " << inFlight << " I/Os to complete");
+        while (DiskerIos.size() > IdleDiskerIos.size()) {
+            TheRing->wait();
+            TheRing->reap(&IpcIoFile::DiskerIoCompleted);
+            TheRing->submit();
+        }
+
+        const auto fd = TheRing->completionFd();
+        Comm::SetSelect(fd, COMM_SELECT_READ, nullptr, nullptr, 0);
+        fd_close(fd);
+        TheRing.reset();
+    }
+#endif
+
+    for (auto &io: DiskerIos)
+        free(io.directBuf);
+    DiskerIos.clear();
+    IdleDiskerIos.clear();
+    DiskerReplies.clear();
+}
+
 static bool
-DiskerOpen(const SBuf &path, int flags, mode_t)
+DiskerOpen(const SBuf &path, int flags, mode_t, const DiskFile::Config &cfg)
 {
     assert(TheFile < 0);
 
+    if (cfg.directIo) {
+#if defined(O_DIRECT)
+        flags |= O_DIRECT;
+#else
+        debugs(47, DBG_CRITICAL, "ERROR: cannot open " << path << ": direct-io is not supported on this platform");
+        return false;
+#endif
+    }
+
     DbName = path;
     TheFile = file_open(DbName.c_str(), flags);
 
@@ -126,8 +126,17 @@ private:
     static void DiskerHandleMoreRequests(void*);
     static void DiskerHandleRequests();
     static void DiskerHandleRequest(const int workerId, IpcIoMsg &ipcIo);
+    static void DiskerFinishIo(size_t ioIndex);
+    static void DiskerReply(size_t ioIndex);
     static bool WaitBeforePop();
 
+    static void DiskerStartIo(const DiskFile::Config &);
+    static void DiskerStopIo();
+#if USE_IO_URING
+    static void DiskerIoCompleted(uint64_t tag, int result);
+    static void DiskerHandleCompletions(int fd, void *);
+#endif
+
     static void HandleMessagesAtStart();
 
 private:
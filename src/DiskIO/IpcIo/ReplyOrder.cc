@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 47    Store Directory Routines */
+
+#include "squid.h"
+#include "base/TextException.h"
+#include "debug/Stream.h"
+#include "DiskIO/IpcIo/ReplyOrder.h"
+
+#include <algorithm>
+
+void
+IpcIo::ReplyOrder::started(const int workerId, const size_t tag)
+{
+    requests_[workerId].push_back(Request{tag, false});
+}
+
+size_t
+IpcIo::ReplyOrder::finished(const int workerId, const size_t tag, const Sender send)
+{
+    const auto worker = requests_.find(workerId);
+    Must(worker != requests_.end());
+    auto &pending = worker->second;
+
+    const auto request = std::find_if(pending.begin(), pending.end(), [tag](const Request &r) {
+        return r.tag == tag;
+    });
+    Must(request != pending.end());
+    Must(!request->finished);
+    request->finished = true;
+    ++held_;
+
+    size_t sent = 0;
+    while (!pending.empty() && pending.front().finished) {
+        const auto sendable = pending.front().tag;
+        pending.pop_front();
+        --held_;
+        ++sent;
+        send(sendable);
+    }
+
+    if (!sent)
+        debugs(47, 5, "kid" << workerId << " reply " << tag << " waits for " << (request - pending.begin()) << " earlier requests");
+    return sent;
+}
+
+void
+IpcIo::ReplyOrder::clear()
+{
+    requests_.clear();
+    held_ = 0;
+}
+
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_DISKIO_IPCIO_REPLYORDER_H
+#define SQUID_SRC_DISKIO_IPCIO_REPLYORDER_H
+
+#include <cstddef>
+#include <deque>
+#include <map>
+
+namespace IpcIo
+{
+
+/// Holds results of I/O requests that a disker finished out of order so that
+/// each worker receives replies in the order it sent the corresponding
+/// requests. Workers rely on that order (e.g., Rock::IoState expects the
+/// replies to its sequential writes to arrive sequentially). Requests are
+/// identified by caller-supplied tags that are unique among pending requests.
+///
+/// This ordering has a head-of-line blocking cost: A held reply keeps its
+/// disker I/O slot busy until all earlier requests of the same worker finish.
+/// In the worst case, every io-queue-depth slot holds a reply waiting for one
+/// slow request, and the disker accepts no new requests until that request
+/// finishes. The effective queue depth shrinks, but it cannot drop to zero
+/// indefinitely: The blocking request is always in flight, and its completion
+/// releases every reply it was holding back.
+class ReplyOrder
+{
+public:
+    /// sends the result of the tagged request to its worker
+    using Sender = void (*)(size_t tag);
+
+    /// remembers a request that the given worker sent after all its
+    /// previously started() requests
+    void started(int workerId, size_t tag);
+
+    /// marks the tagged request finished and sends all replies that no
+    /// longer wait for earlier requests of the same worker
+    /// \returns the number of sent replies
+    size_t finished(int workerId, size_t tag, Sender);
+
+    /// the number of finished requests waiting for earlier ones
+    size_t held() const { return held_; }
+
+    /// forgets all requests
+    void clear();
+
+private:
+    /// a started request
+    class Request
+    {
+    public:
+        size_t tag; ///< caller-supplied request ID
+        bool finished; ///< whether the request is waiting for earlier ones
+    };
+
+    /// started requests of each worker, in the order they were started
+    std::map<int, std::deque<Request> > requests_;
+
+    size_t held_ = 0; ///< the number of finished requests we have not sent
+};
+
+} // namespace IpcIo
+
+#endif /* SQUID_SRC_DISKIO_IPCIO_REPLYORDER_H */
+
@@ -34,7 +34,7 @@ static void httpHdrAdd(HttpHeader *heads, HttpRequest *request, const AccessLogE
  * \retval 1    Header has no access controls to test
  */
 static int
-httpHdrMangle(HttpHeaderEntry * e, HttpRequest * request, HeaderManglers *hms, const AccessLogEntryPointer &al)
+httpHdrMangle(HttpHeader &header, HttpHeaderEntry * e, HttpRequest * request, HeaderManglers *hms, const AccessLogEntryPointer &al)
 {
     int retval;
 
@@ -71,6 +71,7 @@ httpHdrMangle(HttpHeaderEntry * e, HttpRequest * request, HeaderManglers *hms, c
          */
         debugs(66, 7, "checklist denied but we have replacement. Replace");
         e->value = hm->replacement;
+        header.noteEntryChange();
         retval = 1;
     }
 
@@ -102,7 +103,7 @@ httpHdrMangleList(HttpHeader *l, HttpRequest *request, const AccessLogEntryPoint
     if (hms) {
         int headers_deleted = 0;
         while ((e = l->getEntry(&p))) {
-            if (httpHdrMangle(e, request, hms, al) == 0)
+            if (httpHdrMangle(*l, e, request, hms, al) == 0)
                 l->delAt(p, headers_deleted);
         }
 
@@ -291,6 +291,7 @@ HttpHeader::HttpHeader(const HttpHeader &other): owner(other.owner), len(other.l
     entries.reserve(other.entries.capacity());
     httpHeaderMaskInit(&mask, 0);
     update(&other); // will update the mask as well
+    shareRawFields(other);
 }
 
 HttpHeader::~HttpHeader()
@@ -307,6 +308,7 @@ HttpHeader::operator =(const HttpHeader &other)
         assert(owner == other.owner);
         clean();
         update(&other); // will update the mask as well
+        shareRawFields(other);
         len = other.len;
         conflictingContentLength_ = other.conflictingContentLength_;
         teUnsupported_ = other.teUnsupported_;
@@ -353,6 +355,7 @@ HttpHeader::clean()
     }
 
     entries.clear();
+    forgetRawFields();
     httpHeaderMaskInit(&mask, 0);
     len = 0;
     conflictingContentLength_ = false;
@@ -367,10 +370,36 @@ HttpHeader::append(const HttpHeader * src)
     assert(src != this);
     debugs(55, 7, "appending hdr: " << this << " += " << src);
 
+    const auto wasEmpty = entries.empty();
     for (auto e : src->entries) {
         if (e)
             addEntry(e->clone());
     }
+    if (wasEmpty)
+        shareRawFields(*src);
+}
+
+/// stops reusing parsed field bytes because some of those fields have changed
+void
+HttpHeader::forgetRawFields()
+{
+    rawFields_.clear();
+    rawFieldsCount_ = 0;
+}
+
+/// reuses parsed field bytes of the header we have just copied all fields from
+void
+HttpHeader::shareRawFields(const HttpHeader &other)
+{
+    // update() skips some fields
+    if (other.rawFieldsCount_ && entries.size() >= other.rawFieldsCount_) {
+        for (size_t i = 0; i < other.rawFieldsCount_; ++i) {
+            if (!entries[i] || entries[i]->id != other.entries[i]->id)
+                return;
+        }
+        rawFields_ = other.rawFields_; // shared, not copied
+        rawFieldsCount_ = other.rawFieldsCount_;
+    }
 }
 
 bool
@@ -497,6 +526,11 @@ HttpHeader::parse(const char *header_start, size_t hdrLen, Http::ContentLengthIn
         return 0;
     }
 
+    // leading fields that packInto() would reproduce exactly
+    auto rawFieldsOnly = entries.empty();
+    const char *rawFieldsEnd = header_start;
+    size_t rawFieldsCount = 0;
+
     /* common format headers are "<name>:[ws]<value>" lines delimited by <CRLF>.
      * continuation lines start with a (single) space or tab */
     while (field_ptr < header_end) {
@@ -601,16 +635,30 @@ HttpHeader::parse(const char *header_start, size_t hdrLen, Http::ContentLengthIn
         if (e->id == Http::HdrType::CONTENT_LENGTH && !clen.checkField(e->value)) {
             delete e;
 
-            if (Config.onoff.relaxed_header_parser)
+            if (Config.onoff.relaxed_header_parser) {
+                rawFieldsOnly = false;
                 continue; // clen has printed any necessary warnings
+            }
 
             clean();
             return 0;
         }
 
+        if (rawFieldsOnly && e->packsInto(field_start, field_ptr - field_start)) {
+            rawFieldsEnd = field_ptr;
+            ++rawFieldsCount;
+        } else {
+            rawFieldsOnly = false;
+        }
+
         addEntry(e);
     }
 
+    if (rawFieldsCount) {
+        rawFields_.assign(header_start, rawFieldsEnd - header_start);
+        rawFieldsCount_ = rawFieldsCount;
+    }
+
     if (clen.headerWideProblem) {
         debugs(55, warnOnError, "WARNING: " << clen.headerWideProblem <<
                " Content-Length field values in" <<
@@ -674,6 +722,13 @@ HttpHeader::packInto(Packable * p, bool mask_sensitive_info) const
     assert(p);
     debugs(55, 7, this << " into " << p <<
            (mask_sensitive_info ? " while masking" : ""));
+
+    if (!mask_sensitive_info && rawFieldsCount_) {
+        // the first entries are still the fields we parsed
+        p->append(rawFields_.rawContent(), rawFields_.length());
+        pos = static_cast<HttpHeaderPos>(rawFieldsCount_) - 1;
+    }
+
     /* pack all entries one by one */
     while ((e = getEntry(&pos))) {
         if (!mask_sensitive_info) {
@@ -828,6 +883,8 @@ HttpHeader::delAt(HttpHeaderPos pos, int &headers_deleted)
     assert(pos >= HttpHeaderInitPos && pos < static_cast<ssize_t>(entries.size()));
     e = static_cast<HttpHeaderEntry*>(entries[pos]);
     entries[pos] = nullptr;
+    if (static_cast<size_t>(pos) < rawFieldsCount_)
+        forgetRawFields();
     /* decrement header length, allow for ": " and crlf */
     len -= e->name.length() + 2 + e->value.size() + 2;
     assert(len >= 0);
@@ -1225,6 +1282,8 @@ HttpHeader::updateOrAddStr(const Http::HdrType id, const SBuf &newValue)
         return;
     }
 
+    forgetRawFields(); // we may change or delete existing fields below
+
     auto foundSameName = false;
     for (auto &e: entries) {
         if (!e || e->id != id)
@@ -1488,7 +1547,12 @@ HttpHeader::getTimeOrTag(Http::HdrType id) const
  * HttpHeaderEntry
  */
 
-HttpHeaderEntry::HttpHeaderEntry(Http::HdrType anId, const SBuf &aName, const char *aValue)
+HttpHeaderEntry::HttpHeaderEntry(Http::HdrType anId, const SBuf &aName, const char *aValue):
+    HttpHeaderEntry(anId, aName, aValue, aValue ? strlen(aValue) : 0)
+{
+}
+
+HttpHeaderEntry::HttpHeaderEntry(Http::HdrType anId, const SBuf &aName, const char *aValue, const size_t aValueLength)
 {
     assert(any_HdrType_enum_value(anId));
     id = anId;
@@ -1498,7 +1562,8 @@ HttpHeaderEntry::HttpHeaderEntry(Http::HdrType anId, const SBuf &aName, const ch
     else
         name = aName;
 
-    value = aValue;
+    if (aValue)
+        value.assign(aValue, aValueLength);
 
     if (id != Http::HdrType::BAD_HDR)
         ++ headerStatsTable[id].aliveCount;
@@ -1598,8 +1663,6 @@ HttpHeaderEntry::parse(const char *field_start, const char *field_end, const htt
 
     SBuf theName;
 
-    String value;
-
     if (id == Http::HdrType::BAD_HDR)
         id = Http::HdrType::OTHER;
 
@@ -1622,21 +1685,32 @@ HttpHeaderEntry::parse(const char *field_start, const char *field_end, const htt
         return nullptr;
     }
 
-    /* set field value */
-    value.assign(value_start, field_end - value_start);
-
     if (id != Http::HdrType::BAD_HDR)
         ++ headerStatsTable[id].seenCount;
 
-    debugs(55, 9, "parsed HttpHeaderEntry: '" << theName << ": " << value << "'");
+    debugs(55, 9, "parsed HttpHeaderEntry: '" << theName << ": " << Raw("value", value_start, field_end - value_start) << "'");
 
-    return new HttpHeaderEntry(id, theName, value.termedBuf());
+    return new HttpHeaderEntry(id, theName, value_start, field_end - value_start);
 }
 
 HttpHeaderEntry *
 HttpHeaderEntry::clone() const
 {
-    return new HttpHeaderEntry(id, name, value.termedBuf());
+    return new HttpHeaderEntry(id, name, value.rawBuf(), value.size());
+}
+
+bool
+HttpHeaderEntry::packsInto(const char * const field, const size_t fieldLength) const
+{
+    if (fieldLength != length())
+        return false;
+
+    const auto nameLength = name.length();
+    // given matching lengths, ": " and CRLF imply that the value matches:
+    // parsing stripped a single leading space and no trailing whitespace
+    return memcmp(field, name.rawContent(), nameLength) == 0 &&
+           memcmp(field + nameLength, ": ", 2) == 0 &&
+           memcmp(field + fieldLength - 2, "\r\n", 2) == 0;
 }
 
 void
@@ -53,10 +53,13 @@ class HttpHeaderEntry
 
 public:
     HttpHeaderEntry(Http::HdrType id, const SBuf &name, const char *value);
+    HttpHeaderEntry(Http::HdrType id, const SBuf &name, const char *value, size_t valueLength);
     ~HttpHeaderEntry();
     static HttpHeaderEntry *parse(const char *field_start, const char *field_end, const http_hdr_owner_type msgType);
     HttpHeaderEntry *clone() const;
     void packInto(Packable *p) const;
+    /// whether packInto() would produce exactly the given field bytes
+    bool packsInto(const char *field, size_t fieldLength) const;
     int getInt() const;
     int64_t getInt64() const;
 
@@ -148,6 +151,10 @@ public:
     /// same-name fields with conflicting values as needed.
     void updateOrAddStr(Http::HdrType, const SBuf &);
 
+    /// must be called after changing an entry returned by getEntry() or
+    /// findEntry() in place, so that packInto() does not use stale bytes
+    void noteEntryChange() { forgetRawFields(); }
+
     int getInt(Http::HdrType id) const;
     int64_t getInt64(Http::HdrType id) const;
     time_t getTime(Http::HdrType id) const;
@@ -191,6 +198,15 @@ protected:
 
 private:
     HttpHeaderEntry *findLastEntry(Http::HdrType id) const;
+    void forgetRawFields();
+    void shareRawFields(const HttpHeader &other);
+
+    /// parsed bytes of the first rawFieldsCount_ entries if packing those
+    /// entries reproduces these bytes exactly; lets packInto() reuse them
+    SBuf rawFields_;
+    /// the number of leading entries packed in rawFields_
+    size_t rawFieldsCount_ = 0;
+
     bool conflictingContentLength_; ///< found different Content-Length fields
     /// unsupported encoding, unnecessary syntax characters, and/or
     /// invalid field-value found in Transfer-Encoding header
@@ -145,6 +145,14 @@ public:
     const char *logUri() const;
 
     HttpRequestMethod method;
+
+    /// Locally stored entry bytes, from inmem_lo to endOffset(). Even for a
+    /// complete IN_MEMORY entry, these bytes may end before object_sz: A
+    /// shared memory cache hit loads just its HTTP headers here, leaving the
+    /// body in read-locked shared memory pages while the entry is attached to
+    /// the shared memory cache. Code that needs the whole body must either
+    /// read it via store_client (which falls back to MemStore::readFromShm())
+    /// or check that endOffset() reached object_sz (e.g., StoreEntry::mayStartSwapOut()).
     mem_hdr data_hdr;
     int64_t inmem_lo = 0;
     dlink_list clients;
@@ -198,6 +206,11 @@ public:
         int32_t index = -1; ///< entry position inside the memory cache
         int64_t offset = 0; ///< bytes written/read to/from the memory cache so far
 
+        /// the last slice used by MemStore::readFromShm() (or -1)
+        int32_t readSlice = -1;
+        /// the entry offset of the first readSlice byte
+        int64_t readSliceOffset = 0;
+
         Store::IoStatus io = Store::ioUndecided; ///< current I/O state
     };
     MemCache memCache; ///< current [shared] memory caching state for the entry
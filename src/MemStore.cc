@@ -199,6 +199,14 @@ MemStore::init()
     Must(!map);
     map = new MemStoreMap(SBuf(MapLabel));
     map->cleaner = this;
+    configure();
+}
+
+void
+MemStore::configure()
+{
+    if (map)
+        map->replacementPolicy(Config.memSharedReplacement);
 }
 
 void
@@ -241,6 +249,10 @@ MemStore::stat(StoreEntry &e) const
                               currentCount(), (100.0 * currentCount() / entryLimit));
         }
 
+        Ipc::StoreMapStats mapStats;
+        map->updateStats(mapStats);
+        mapStats.dump(e);
+
         storeAppendPrintf(&e, "Maximum slots:   %9d\n", slotLimit);
         if (slotLimit > 0) {
             const unsigned int slotsFree =
@@ -325,13 +337,14 @@ MemStore::get(const cache_key *key)
     try {
         // XXX: We do not know the URLs yet, only the key, but we need to parse and
         // store the response for the Root().find() callers to be happy because they
-        // expect IN_MEMORY entries to already have the response headers and body.
+        // expect IN_MEMORY entries to already have the response headers. The body
+        // of a complete entry stays in shared memory; see readFromShm().
         e->createMemObject();
 
         anchorEntry(*e, index, *slot);
 
         // TODO: make copyFromShm() throw on all failures, simplifying this code
-        if (copyFromShm(*e, index, *slot))
+        if (copyFromShm(*e, index, *slot, true))
             return e;
         debugs(20, 3, "failed for " << *e);
     } catch (...) {
@@ -474,9 +487,11 @@ MemStore::anchorEntry(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnc
     mc.io = Store::ioReading;
 }
 
-/// copies the entire entry from shared to local memory
+/// Copies the entire entry from shared to local memory. If headersOnly is
+/// set and the entry is complete, copies just the slices with HTTP headers,
+/// leaving the entry locked for readFromShm() use.
 bool
-MemStore::copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnchor &anchor)
+MemStore::copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnchor &anchor, const bool headersOnly)
 {
     debugs(20, 7, "mem-loading entry " << index << " from " << anchor.start);
     assert(e.mem_obj);
@@ -486,6 +501,8 @@ MemStore::copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnc
     Ipc::StoreMapSliceId sid = anchor.start; // optimize: remember the last sid
     bool wasEof = anchor.complete() && sid < 0;
     int64_t sliceOffset = 0;
+    // a complete entry cannot change while we hold its read lock
+    const auto leaveBodyInShm = headersOnly && anchor.complete();
 
     SBuf httpHeaderParsingBuffer;
     while (sid >= 0) {
@@ -525,6 +542,14 @@ MemStore::copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnc
         }
         // else skip a [possibly incomplete] slice that we copied earlier
 
+        if (leaveBodyInShm && e.hasParsedReplyHeader() && slice.next >= 0) {
+            debugs(20, 5, "mem-loaded headers and " << e.mem_obj->endOffset() << '/' <<
+                   anchor.basics.swap_file_sz << " bytes of " << e);
+            // anchorEntry() has made this complete entry STORE_OK and IN_MEMORY;
+            // the remaining bytes stay pinned by our read lock until disconnect()
+            return true;
+        }
+
         // careful: the slice may have grown _and_ gotten the next slice ID!
         if (slice.next >= 0) {
             assert(!wasEof);
@@ -951,10 +976,58 @@ MemStore::disconnect(StoreEntry &e)
             map->closeForReading(mem_obj.memCache.index);
             mem_obj.memCache.index = -1;
             mem_obj.memCache.io = Store::ioDone;
+            mem_obj.memCache.readSlice = -1;
         }
     }
 }
 
+bool
+MemStore::canReadFromShm(const StoreEntry &e, const int64_t offset) const
+{
+    // a complete entry that we still have read-locked; see copyFromShm()
+    return map && e.hasMemStore() &&
+           e.mem_obj->memCache.io == Store::ioReading &&
+           e.store_status == STORE_OK &&
+           0 <= offset && offset < e.mem_obj->object_sz;
+}
+
+size_t
+MemStore::readFromShm(StoreEntry &e, const StoreIOBuffer &buf)
+{
+    Assure(canReadFromShm(e, buf.offset));
+    auto &memCache = e.mem_obj->memCache;
+    const auto index = memCache.index;
+    const auto &anchor = map->readableEntry(index);
+
+    // resume from the previously read slice to avoid rescanning long chains
+    Ipc::StoreMapSliceId sid = anchor.start;
+    int64_t sliceOffset = 0;
+    if (memCache.readSlice >= 0 && memCache.readSliceOffset <= buf.offset) {
+        sid = memCache.readSlice;
+        sliceOffset = memCache.readSliceOffset;
+    }
+
+    size_t copied = 0;
+    while (sid >= 0 && copied < buf.length) {
+        const auto &slice = map->readableSlice(index, sid);
+        const auto wantedOffset = buf.offset + static_cast<int64_t>(copied);
+        if (wantedOffset < sliceOffset + slice.size) {
+            const auto prefixSize = static_cast<size_t>(wantedOffset - sliceOffset);
+            const auto sliceBytes = min(static_cast<size_t>(slice.size) - prefixSize, buf.length - copied);
+            const auto page = static_cast<const char*>(PagePointer(extras->items[sid].page));
+            memcpy(buf.data + copied, page + prefixSize, sliceBytes);
+            copied += sliceBytes;
+            memCache.readSlice = sid;
+            memCache.readSliceOffset = sliceOffset;
+        }
+        sliceOffset += slice.size;
+        sid = slice.next;
+    }
+
+    debugs(20, 7, "copied " << copied << " bytes at " << buf.offset << " of " << e);
+    return copied;
+}
+
 bool
 MemStore::Requested()
 {
@@ -44,6 +44,18 @@ public:
     /// called when the entry is about to forget its association with mem cache
     void disconnect(StoreEntry &e);
 
+    /// applies reconfigurable settings
+    void configure();
+
+    /// whether readFromShm() can supply the entry byte at the given offset
+    bool canReadFromShm(const StoreEntry &, int64_t offset) const;
+
+    /// Copies entry bytes directly from the read-locked shared memory pages
+    /// into the given buffer, bypassing MemObject memory.
+    /// \returns the number of bytes copied
+    /// \prec canReadFromShm(buf.offset) is true
+    size_t readFromShm(StoreEntry &, const StoreIOBuffer &buf);
+
     /* Storage API */
     void create() override {}
     void init() override;
@@ -79,7 +91,7 @@ protected:
 
     void copyToShm(StoreEntry &e);
     void copyToShmSlice(StoreEntry &e, Ipc::StoreMapAnchor &anchor, Ipc::StoreMap::Slice &slice);
-    bool copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnchor &anchor);
+    bool copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnchor &anchor, const bool headersOnly = false);
     void copyFromShmSlice(StoreEntry &, const StoreIOBuffer &);
 
     void updateHeadersOrThrow(Ipc::StoreMapUpdate &update);
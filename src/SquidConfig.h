@@ -19,6 +19,7 @@
 #include "HeaderMangling.h"
 #include "helper/ChildConfig.h"
 #include "ip/Address.h"
+#include "ipc/forward.h"
 #if USE_DELAY_POOLS
 #include "MessageDelayPools.h"
 #endif
@@ -87,6 +88,7 @@ public:
     } Swap;
 
     YesNoNone memShared; ///< whether the memory cache is shared among workers
+    Ipc::StoreMapPolicy memSharedReplacement; ///< memory_cache_shared_replacement
     YesNoNone shmLocking; ///< shared_memory_locking
     size_t memMaxSize;
 
@@ -251,6 +253,9 @@ public:
         int size;
         int low;
         int high;
+        time_t staleTtl; ///< how long expired entries may be used while being refreshed
+        int prefetch; ///< refresh entries used within this percentage of their TTL
+        int prefetchMinHits; ///< only refresh entries with at least this many hits
     } ipcache;
 
     struct {
@@ -337,6 +342,10 @@ public:
         int hostStrictVerify;
         int client_dst_passthru;
         int dns_mdns;
+        int tunnel_zero_copy;
+        int disk_hit_zero_copy;
+        int store_dir_size_classes;
+        int dns_cache_shared;
 #if USE_OPENSSL
         bool logTlsServerHelloDetails;
 #endif
@@ -518,6 +527,7 @@ public:
     char *accept_filter;
     int umask;
     int max_filedescriptors;
+    int epollMaxEvents; ///< epoll_max_events; zero means no limit
     int workers;
     CpuAffinityMap *cpuAffinityMap;
 
@@ -540,6 +550,7 @@ public:
         SBufList nameservers;
         int v4_first;       ///< Place IPv4 first in the order of DNS results.
         ssize_t packet_max; ///< maximum size EDNS advertised for DNS replies.
+        int udp_sockets;    ///< the number of UDP sockets per address family
     } dns;
 
     struct {
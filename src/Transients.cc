@@ -91,6 +91,10 @@ Transients::stat(StoreEntry &e) const
             storeAppendPrintf(&e, "Current entries: %" PRId64 " %.2f%%\n",
                               currentCount(), (100.0 * currentCount() / limit));
         }
+
+        Ipc::StoreMapStats mapStats;
+        map->updateStats(mapStats);
+        mapStats.dump(e);
     }
 }
 
@@ -328,8 +332,11 @@ Transients::evictIfFound(const cache_key *key)
     if (!map)
         return;
 
-    const sfileno index = map->fileNoByKey(key);
-    if (map->freeEntry(index))
+    const sfileno index = map->fileNoWithKey(key);
+    if (index < 0)
+        return; // not found
+
+    if (map->freeEntry(index, key))
         CollapsedForwarding::Broadcast(index, true);
 }
 
@@ -13,11 +13,16 @@
 #include "acl/DomainData.h"
 #include "acl/SplayInserter.h"
 #include "anyp/Uri.h"
+#include "base/TextException.h"
 #include "cache_cf.h"
 #include "ConfigParser.h"
 #include "debug/Stream.h"
 #include "util.h"
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
 template<class T>
 inline void
 xRefFree(T &thing)
@@ -44,17 +49,141 @@ splaystrcmp (T&l, T&r)
     return strcmp ((char *)l,(char *)r);
 }
 
-/* general compare functions, these are used for tree search algorithms
- * so they return <0, 0 or >0 */
+/// the position of a lowercase name character in matchDomainName() order,
+/// where a name precedes its extensions and '.' precedes other characters
+static int
+NameCharacterRank(const char c)
+{
+    if (!c)
+        return 0;
+    if (c == '.')
+        return 1;
+    return static_cast<unsigned char>(c) + 2;
+}
 
-/* compare a host and a domain */
+/// compares two reversed names like strcmp(3) but in matchDomainName() order
+static int
+CompareReversedNames(const char *a, const char *b)
+{
+    while (*a && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return NameCharacterRank(*a) - NameCharacterRank(*b);
+}
+
+/// A host name suffix, viewed as reversed lowercase characters and, if
+/// requested, a leading dot (that comes last in the reversed view). Lets us
+/// look up suffixes among reversed names without copying the host name.
+class ACLDomainData::Suffix
+{
+public:
+    Suffix(const char *start, const char *end, const bool withLeadingDot):
+        start_(start), size_(end - start), withLeadingDot_(withLeadingDot) {}
+
+    /// the number of characters in the reversed view
+    size_t length() const { return size_ + (withLeadingDot_ ? 1 : 0); }
+
+    /// the character at the given position of the reversed view
+    char operator [](const size_t i) const { return i < size_ ? xtolower(start_[size_ - 1 - i]) : '.'; }
+
+    /// compares a reversed name with us like strcmp(reversedName, us)
+    int compareName(const char *reversedName) const {
+        const auto len = length();
+        for (size_t i = 0; i < len; ++i) {
+            if (const auto diff = NameCharacterRank(reversedName[i]) - NameCharacterRank((*this)[i]))
+                return diff;
+        }
+        return NameCharacterRank(reversedName[len]);
+    }
+
+    /// whether the reversed name starts with our reversed view
+    bool prefixes(const char *reversedName) const {
+        const auto len = length();
+        for (size_t i = 0; i < len; ++i) {
+            if (reversedName[i] != (*this)[i])
+                return false;
+        }
+        return true;
+    }
+
+private:
+    const char *start_; ///< the first host name character in the suffix
+    size_t size_; ///< the number of host name characters in the suffix
+    bool withLeadingDot_; ///< whether the view ends with an extra dot
+};
+
+/// the first prepared name that is not less than the given suffix
+std::vector<uint32_t>::const_iterator
+ACLDomainData::lowerBound(const Suffix &suffix) const
+{
+    return std::lower_bound(nameOffsets.begin(), nameOffsets.end(), suffix,
+    [this](const uint32_t offset, const Suffix &s) {
+        return s.compareName(&reversedNames[offset]) < 0;
+    });
+}
+
+/// whether one of the prepared names is identical to the given suffix
+bool
+ACLDomainData::contains(const Suffix &suffix) const
+{
+    const auto pos = lowerBound(suffix);
+    return pos != nameOffsets.end() && suffix.compareName(&reversedNames[*pos]) == 0;
+}
+
+/// compares a host and a parsed name for Splay searches
+static int
+aclHostDomainCompare(char * const &host, char * const &name)
+{
+    return matchDomainName(host, name);
+}
 
+/// aclHostDomainCompare() for host names that may contain wildcards
 static int
-aclHostDomainCompare( char *const &a, char * const &b)
+aclHostDomainWildcardCompare(char * const &host, char * const &name)
 {
-    const char *h = static_cast<const char *>(a);
-    const char *d = static_cast<const char *>(b);
-    return matchDomainName(h, d);
+    return matchDomainName(host, name, mdnHonorWildcards);
+}
+
+bool
+ACLDomainData::matchHost(const char *host, const bool honorWildcards)
+{
+    if (!prepared) {
+        // not prepared for use (yet); search the parsed names directly
+        char *h = const_cast<char *>(host);
+        return domains.find(h, honorWildcards ? aclHostDomainWildcardCompare : aclHostDomainCompare) != nullptr;
+    }
+
+    // like matchDomainName(), ignore leading dots
+    while (*host == '.')
+        ++host;
+    const auto end = host + strlen(host);
+    if (host == end)
+        return false;
+
+    // the host name itself or the set of its subdomains (e.g., .example.com)
+    if (contains(Suffix(host, end, false)) || contains(Suffix(host, end, true)))
+        return true;
+
+    // a set of subdomains of one of its parent domains (e.g., .com)
+    for (auto dot = strchr(host + 1, '.'); dot; dot = strchr(dot + 1, '.')) {
+        if (contains(Suffix(dot, end, false)))
+            return true;
+    }
+
+    // a host name wildcard (e.g., *.example.com) matches any name in its
+    // parent domain (e.g., x.example.com); configured names have no wildcards
+    if (honorWildcards) {
+        const auto star = strrchr(host, '*');
+        if (star && star[1] == '.') {
+            const Suffix parent(star + 1, end, false);
+            const auto pos = lowerBound(parent);
+            if (pos != nameOffsets.end() && parent.prefixes(&reversedNames[*pos]))
+                return true;
+        }
+    }
+
+    return false;
 }
 
 bool
@@ -65,12 +194,11 @@ ACLDomainData::match(char const *host)
 
     debugs(28, 3, "aclMatchDomainList: checking '" << host << "'");
 
-    char *h = const_cast<char *>(host);
-    const auto result = domains.find(h, aclHostDomainCompare);
+    const auto result = matchHost(host, false);
 
     debugs(28, 3, "aclMatchDomainList: '" << host << "' " << (result ? "found" : "NOT found"));
 
-    return (result != nullptr);
+    return result;
 }
 
 struct AclDomainDataDumpVisitor {
@@ -85,6 +213,11 @@ ACLDomainData::dump() const
 {
     AclDomainDataDumpVisitor visitor;
     domains.visit(visitor);
+    for (const auto offset: nameOffsets) {
+        std::string name(&reversedNames[offset]);
+        std::reverse(name.begin(), name.end());
+        visitor.contents.push_back(SBuf(name));
+    }
     return visitor.contents;
 }
 
@@ -155,6 +288,9 @@ Acl::SplayInserter<char*>::DestroyValue(Value v)
 void
 ACLDomainData::parse()
 {
+    if (prepared)
+        restoreParsedNames();
+
     while (char *t = ConfigParser::strtokFile()) {
         Tolower(t);
         Acl::SplayInserter<char*>::Merge(domains, xstrdup(t));
@@ -164,6 +300,47 @@ ACLDomainData::parse()
 bool
 ACLDomainData::empty() const
 {
-    return domains.empty();
+    return domains.empty() && nameOffsets.empty();
+}
+
+void
+ACLDomainData::prepareForUse()
+{
+    // Acl::SplayInserter has already removed duplicate and covered names
+    const auto addName = [this](char * const &name) {
+        const auto length = strlen(name);
+        Must(reversedNames.size() + length < std::numeric_limits<uint32_t>::max());
+        nameOffsets.push_back(reversedNames.size());
+        reversedNames.append(std::make_reverse_iterator(name + length), std::make_reverse_iterator(name));
+        reversedNames.push_back('\0');
+    };
+    domains.visit(addName);
+    domains.destroy(xRefFree);
+
+    std::sort(nameOffsets.begin(), nameOffsets.end(), [this](const uint32_t a, const uint32_t b) {
+        return CompareReversedNames(&reversedNames[a], &reversedNames[b]) < 0;
+    });
+    reversedNames.shrink_to_fit();
+    nameOffsets.shrink_to_fit();
+    prepared = true;
+    debugs(28, 5, nameOffsets.size() << " names in " << reversedNames.size() << " bytes");
+}
+
+/// moves prepared names back into the splay tree so that parse() can merge
+/// new names with them
+void
+ACLDomainData::restoreParsedNames()
+{
+    for (const auto offset: nameOffsets) {
+        const auto reversed = &reversedNames[offset];
+        const auto length = strlen(reversed);
+        auto name = static_cast<char *>(xmalloc(length + 1));
+        std::reverse_copy(reversed, reversed + length, name);
+        name[length] = '\0';
+        Acl::SplayInserter<char*>::Merge(domains, std::move(name));
+    }
+    reversedNames.clear();
+    nameOffsets.clear();
+    prepared = false;
 }
 
@@ -13,6 +13,9 @@
 #include "acl/Data.h"
 #include "splay.h"
 
+#include <string>
+#include <vector>
+
 class ACLDomainData : public ACLData<char const *>
 {
     MEMPROXY_CLASS(ACLDomainData);
@@ -24,8 +27,33 @@ public:
     SBufList dump() const override;
     void parse() override;
     bool empty() const override;
+    void prepareForUse() override;
+
+protected:
+    /// whether the host matches a configured name, as if compared using
+    /// matchDomainName() with or without mdnHonorWildcards
+    bool matchHost(const char *host, bool honorWildcards);
+
+private:
+    class Suffix;
+
+    std::vector<uint32_t>::const_iterator lowerBound(const Suffix &) const;
+    bool contains(const Suffix &) const;
+    void restoreParsedNames();
 
+    /// names parsed but not yet prepared for use
     Splay<char *> domains;
+
+    /// Names prepared by prepareForUse(): lowercased, reversed (e.g.,
+    /// "moc.elpmaxe." for ".example.com"), and NUL-terminated. This compact
+    /// storage replaces the splay tree so that lookups do not modify it.
+    std::string reversedNames;
+
+    /// reversedNames offsets in matchDomainName() order, for binary search
+    std::vector<uint32_t> nameOffsets;
+
+    /// whether names were prepared for use and removed from the splay tree
+    bool prepared = false;
 };
 
 #endif /* SQUID_SRC_ACL_DOMAINDATA_H */
@@ -24,6 +24,7 @@ public:
     bool match(const HttpHeader &) override;
     SBufList dump() const override;
     void parse() override;
+    void prepareForUse() override { regex_rule->prepareForUse(); }
     bool empty() const override;
 
 private:
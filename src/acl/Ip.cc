@@ -12,6 +12,7 @@
 #include "acl/Checklist.h"
 #include "acl/Ip.h"
 #include "acl/SplayInserter.h"
+#include "base/TextException.h"
 #include "cache_cf.h"
 #include "ConfigParser.h"
 #include "debug/Stream.h"
@@ -474,6 +475,8 @@ ACLIP::parse()
     if (data == nullptr)
         data = new IPSplay();
 
+    rangesReady = false; // until prepareForUse()
+
     while (char *t = ConfigParser::strtokFile()) {
         if (parseGlobal(t))
             continue;
@@ -527,6 +530,50 @@ ACLIP::empty() const
     return data->empty() && !matchAnyIpv4 && !matchAnyIpv6;
 }
 
+/// three-way comparison of addresses, in the order used by Ip::Address
+static int
+CompareAddresses(const struct in6_addr &a, const struct in6_addr &b)
+{
+    return memcmp(&a, &b, sizeof(a));
+}
+
+void
+ACLIP::prepareForUse()
+{
+    ranges.clear();
+    if (data) {
+        // Acl::SplayInserter has merged overlapping values, so this in-order
+        // visit yields disjoint [first, last] ranges in ascending order
+        ranges.reserve(data->size());
+        const auto addRange = [this](acl_ip_data * const &value) {
+            AddressRange range;
+            value->firstAddress().getInAddr(range.first);
+            value->lastAddress().getInAddr(range.last);
+            Must(ranges.empty() || CompareAddresses(ranges.back().last, range.first) < 0);
+            ranges.push_back(range);
+        };
+        data->visit(addRange);
+    }
+    ranges.shrink_to_fit();
+    rangesReady = true;
+    debugs(28, 5, name << " has " << ranges.size() << " address range(s)");
+}
+
+/// whether the given address belongs to one of the prepared ranges
+bool
+ACLIP::matchRanges(const Ip::Address &ip) const
+{
+    struct in6_addr needle;
+    ip.getInAddr(needle);
+
+    // find the last range that starts at or before the needle
+    const auto afterCandidate = std::upper_bound(ranges.begin(), ranges.end(), needle,
+    [](const struct in6_addr &address, const AddressRange &range) {
+        return CompareAddresses(address, range.first) < 0;
+    });
+    return afterCandidate != ranges.begin() && CompareAddresses(needle, (afterCandidate - 1)->last) <= 0;
+}
+
 int
 ACLIP::match(const Ip::Address &clientip)
 {
@@ -548,6 +595,13 @@ ACLIP::match(const Ip::Address &clientip)
         // fall through to look for an IPv4 match among IP parameters
     }
 
+    if (rangesReady) {
+        const auto found = matchRanges(clientip);
+        debugs(28, 3, "aclIpMatchIp: '" << clientip << "' " << (found ? "found" : "NOT found"));
+        return found;
+    }
+
+    // not prepared for use (yet); search the parsed data directly
     static acl_ip_data ClientAddress;
     /*
      * aclIpAddrNetworkCompare() takes two acl_ip_data pointers as
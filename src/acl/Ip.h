@@ -14,6 +14,8 @@
 #include "ip/Address.h"
 #include "splay.h"
 
+#include <vector>
+
 class acl_ip_data
 {
     MEMPROXY_CLASS(acl_ip_data);
@@ -65,6 +67,7 @@ public:
     int match(ACLChecklist *checklist) override = 0;
     SBufList dump() const override;
     bool empty () const override;
+    void prepareForUse() override;
 
 protected:
 
@@ -72,7 +75,24 @@ protected:
     IPSplay *data;
 
 private:
+    /// a contiguous block of addresses matched by this ACL
+    class AddressRange
+    {
+    public:
+        struct in6_addr first; ///< the smallest address in the block
+        struct in6_addr last; ///< the largest address in the block
+    };
+
     bool parseGlobal(const char *);
+    bool matchRanges(const Ip::Address &) const;
+
+    /// Disjoint blocks of matching addresses in ascending order, built from
+    /// the parsed data by prepareForUse(). Unlike splay tree searches, binary
+    /// searches of this flat array do not modify it and touch few cache lines.
+    std::vector<AddressRange> ranges;
+
+    /// whether ranges reflect all parsed data
+    bool rangesReady = false;
 
     /// whether match() should return 1 for any IPv4 parameter
     bool matchAnyIpv4 = false;
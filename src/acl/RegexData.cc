@@ -19,17 +19,48 @@
 #include "acl/Checklist.h"
 #include "acl/RegexData.h"
 #include "base/RegexPattern.h"
+#include "base/RunnersRegistry.h"
 #include "cache_cf.h"
 #include "ConfigParser.h"
 #include "debug/Stream.h"
+#include "mgr/Registration.h"
 #include "sbuf/Algorithms.h"
 #include "sbuf/List.h"
 #include "sbuf/Stream.h"
+#include "Store.h"
+
+#include <chrono>
+#include <set>
 
 Acl::BooleanOptionValue ACLRegexData::CaseInsensitive_;
 
+/// match() times one check in this many; reading the clock twice per check
+/// would add a noticeable overhead to short regex checks
+static const uint64_t TimedCheckInterval = 64;
+
+/// the number of match() calls timed after the given number of checks
+static uint64_t
+TimedChecks(const uint64_t checks)
+{
+    return (checks + TimedCheckInterval - 1)/TimedCheckInterval;
+}
+
+/// all ACLRegexData objects, for cache manager reporting
+static std::set<const ACLRegexData *> &
+RegexAcls()
+{
+    static const auto acls = new std::set<const ACLRegexData *>();
+    return *acls;
+}
+
+ACLRegexData::ACLRegexData()
+{
+    RegexAcls().insert(this);
+}
+
 ACLRegexData::~ACLRegexData()
 {
+    RegexAcls().erase(this);
 }
 
 const Acl::Options &
@@ -49,19 +80,47 @@ ACLRegexData::match(char const *word)
 
     debugs(28, 3, "checking '" << word << "'");
 
-    // walk the list of patterns to see if one matches
-    for (auto &i : data) {
-        if (i.match(word)) {
-            debugs(28, 2, '\'' << i << "' found in '" << word << '\'');
-            // TODO: old code also popped the pattern to second place of the list
-            // in order to reduce patterns search times.
-            return 1;
-        }
+    const auto timing = checks++ % TimedCheckInterval == 0;
+    if (timing)
+        matchTime.resume();
+    const auto found = patterns.firstMatch(word);
+    if (timing)
+        matchTime.pause();
+
+    if (found) {
+        ++matches;
+        debugs(28, 2, '\'' << patterns.at(*found) << "' found in '" << word << '\'');
+        return 1;
     }
 
     return 0;
 }
 
+void
+ACLRegexData::prepareForUse()
+{
+    patterns.compile();
+}
+
+void
+ACLRegexData::Stats(StoreEntry *sentry)
+{
+    storeAppendPrintf(sentry, "Regular expression ACLs:\n\n");
+    storeAppendPrintf(sentry, "%10s\t%10s\t%12s\t%12s\t%12s\t%s\n",
+                      "Patterns", "Together", "Checks", "Matches", "usec/check", "Configured at");
+    for (const auto acl: RegexAcls()) {
+        const auto usec = std::chrono::duration<double, std::micro>(acl->matchTime.total()).count();
+        const auto timedChecks = TimedChecks(acl->checks);
+        storeAppendPrintf(sentry, "%10zu\t%10zu\t%12" PRIu64 "\t%12" PRIu64 "\t%12.3f\t" SQUIDSBUFPH "\n",
+                          acl->patterns.size(),
+                          acl->patterns.setMatched(),
+                          acl->checks,
+                          acl->matches,
+                          timedChecks ? usec/timedChecks : 0.0,
+                          SQUIDSBUFPRINT(acl->origin));
+    }
+}
+
 SBufList
 ACLRegexData::dump() const
 {
@@ -226,6 +285,9 @@ ACLRegexData::parse()
     if (CaseInsensitive_)
         flagsAtLineStart |= REG_ICASE;
 
+    if (origin.isEmpty())
+        origin = ToSBuf(cfg_filename, " line ", config_lineno);
+
     SBufList sl;
     while (char *t = ConfigParser::RegexStrtokFile()) {
         const char *clean = removeUnnecessaryWildcards(t);
@@ -233,20 +295,29 @@ ACLRegexData::parse()
         sl.emplace_back(clean);
     }
 
-    try {
-        // ignore the danger of merging invalid REs into a valid "optimized" RE
-        compileOptimisedREs(data, sl, flagsAtLineStart);
-    } catch (...) {
+    const auto oldSize = data.size();
+    if (RegexSet::Supported()) {
+        // RegexSet matches individual REs faster than their merged versions
         compileUnoptimisedREs(data, sl, flagsAtLineStart);
-        // Delay compileOptimisedREs() failure reporting until we know that
-        // compileUnoptimisedREs() above have succeeded. If
-        // compileUnoptimisedREs() also fails, then the compileOptimisedREs()
-        // exception caught earlier was probably not related to _optimization_
-        // (and we do not want to report the same RE compilation problem twice).
-        debugs(28, DBG_IMPORTANT, "WARNING: Failed to optimize a set of regular expressions; will use them as-is instead;" <<
-               Debug::Extra << "configuration: " << cfg_filename << " line " << config_lineno << ": " << config_input_line <<
-               Debug::Extra << "optimization error: " << CurrentException);
+    } else {
+        try {
+            // ignore the danger of merging invalid REs into a valid "optimized" RE
+            compileOptimisedREs(data, sl, flagsAtLineStart);
+        } catch (...) {
+            compileUnoptimisedREs(data, sl, flagsAtLineStart);
+            // Delay compileOptimisedREs() failure reporting until we know that
+            // compileUnoptimisedREs() above have succeeded. If
+            // compileUnoptimisedREs() also fails, then the compileOptimisedREs()
+            // exception caught earlier was probably not related to _optimization_
+            // (and we do not want to report the same RE compilation problem twice).
+            debugs(28, DBG_IMPORTANT, "WARNING: Failed to optimize a set of regular expressions; will use them as-is instead;" <<
+                   Debug::Extra << "configuration: " << cfg_filename << " line " << config_lineno << ": " << config_input_line <<
+                   Debug::Extra << "optimization error: " << CurrentException);
+        }
     }
+
+    for (auto it = std::next(data.begin(), oldSize); it != data.end(); ++it)
+        patterns.add(*it);
 }
 
 bool
@@ -255,3 +326,18 @@ ACLRegexData::empty() const
     return data.empty();
 }
 
+/// reports regex-based ACL statistics to the cache manager
+class RegexAclsRr: public RegisteredRunner
+{
+public:
+    /* RegisteredRunner API */
+    void useConfig() override;
+};
+DefineRunnerRegistrator(RegexAclsRr);
+
+void
+RegexAclsRr::useConfig()
+{
+    Mgr::RegisterAction("regex_acls", "Regular Expression ACL Statistics", ACLRegexData::Stats, 0, 1);
+}
+
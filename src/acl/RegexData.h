@@ -10,6 +10,8 @@
 #define SQUID_SRC_ACL_REGEXDATA_H
 
 #include "acl/Data.h"
+#include "base/RegexSet.h"
+#include "base/Stopwatch.h"
 
 #include <list>
 
@@ -20,10 +22,15 @@ class ACLRegexData : public ACLData<char const *>
     MEMPROXY_CLASS(ACLRegexData);
 
 public:
+    /// reports matching statistics of all regex-based ACLs
+    static void Stats(StoreEntry *);
+
+    ACLRegexData();
     ~ACLRegexData() override;
     bool match(char const *user) override;
     SBufList dump() const override;
     void parse() override;
+    void prepareForUse() override;
     bool empty() const override;
 
 private:
@@ -34,6 +41,21 @@ private:
     const Acl::Options &lineOptions() override;
 
     std::list<RegexPattern> data;
+
+    /// all data patterns, for matching them together
+    RegexSet patterns;
+
+    /// squid.conf location of the first "acl" directive with our patterns
+    SBuf origin;
+
+    /// the number of match() calls with a non-nil argument
+    uint64_t checks = 0;
+
+    /// the number of successful match() calls
+    uint64_t matches = 0;
+
+    /// the time spent in a sample of match() calls; see TimedCheckInterval
+    Stopwatch matchTime;
 };
 
 #endif /* SQUID_SRC_ACL_REGEXDATA_H */
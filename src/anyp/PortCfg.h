@@ -56,6 +56,9 @@ public:
     int vport;               ///< virtual port support. -1 if dynamic, >0 static
     int disable_pmtu_discovery;
     bool workerQueues; ///< whether listening queues should be worker-specific
+    /// whether worker-specific queues get connections received by CPUs
+    /// their workers are bound to (requires workerQueues)
+    bool cpuSteering;
 
     Comm::TcpKeepAlive tcp_keepalive;
 
@@ -25,6 +25,7 @@ CharacterSet::operator +=(const CharacterSet &src)
         ++s;
         ++d;
     }
+    recount();
     return *this;
 }
 
@@ -40,6 +41,7 @@ CharacterSet::operator -=(const CharacterSet &src)
         ++s;
         ++d;
     }
+    recount();
     return *this;
 }
 
@@ -47,6 +49,7 @@ CharacterSet &
 CharacterSet::add(const unsigned char c)
 {
     chars_[static_cast<uint8_t>(c)] = 1;
+    recount();
     return *this;
 }
 
@@ -54,6 +57,7 @@ CharacterSet &
 CharacterSet::remove(const unsigned char c)
 {
     chars_[static_cast<uint8_t>(c)] = 0;
+    recount();
     return *this;
 }
 
@@ -67,6 +71,7 @@ CharacterSet::addRange(unsigned char low, unsigned char high)
         ++low;
     }
     chars_[static_cast<uint8_t>(high)] = 1;
+    recount();
     return *this;
 }
 
@@ -77,6 +82,7 @@ CharacterSet::complement(const char *label) const
     // negate each of our elements and add them to the result storage
     std::transform(chars_.begin(), chars_.end(), result.chars_.begin(),
                    std::logical_not<Storage::value_type>());
+    result.recount();
     return result;
 }
 
@@ -86,7 +92,8 @@ CharacterSet::CharacterSet(const char *label, const char * const c) :
 {
     const size_t clen = strlen(c);
     for (size_t i = 0; i < clen; ++i)
-        add(c[i]);
+        chars_[static_cast<uint8_t>(c[i])] = 1;
+    recount();
 }
 
 CharacterSet::CharacterSet(const char *label, unsigned char low, unsigned char high) :
@@ -104,6 +111,26 @@ CharacterSet::CharacterSet(const char *label, std::initializer_list<std::pair<ui
         addRange(range.first, range.second);
 }
 
+/// updates the cached results of membership queries after a change
+void
+CharacterSet::recount()
+{
+    size_t members = 0;
+    soleMember_ = soleNonMember_ = -1;
+    for (size_t idx = 0; idx < 256; ++idx) {
+        if (chars_[idx]) {
+            ++members;
+            soleMember_ = idx;
+        } else {
+            soleNonMember_ = idx;
+        }
+    }
+    if (members != 1)
+        soleMember_ = -1;
+    if (members != 255)
+        soleNonMember_ = -1;
+}
+
 void
 CharacterSet::printChars(std::ostream &os) const
 {
@@ -38,6 +38,14 @@ public:
     /// whether a given character exists in the set
     bool operator[](unsigned char c) const {return chars_[static_cast<uint8_t>(c)] != 0;}
 
+    /// \returns the only member of this set or -1 if there are zero or many
+    /// members; lets searches use memchr(3) for sets like LF
+    int soleMember() const { return soleMember_; }
+
+    /// \returns the only character outside this set or -1 if there are zero
+    /// or many such characters; lets searches use memchr(3) for sets like non-LF
+    int soleNonMember() const { return soleNonMember_; }
+
     /// add a given character to the character set
     CharacterSet & add(const unsigned char c);
 
@@ -122,12 +130,17 @@ public:
     static const CharacterSet &RFC3986_UNRESERVED();
 
 private:
+    void recount();
+
     /** index of characters in this set
      *
      * \note guaranteed to be always 256 slots big, as forced in the
      *  constructor. This assumption is relied upon in various methods
      */
     Storage chars_;
+
+    int soleMember_ = -1; ///< \see soleMember()
+    int soleNonMember_ = -1; ///< \see soleNonMember()
 };
 
 /** CharacterSet addition
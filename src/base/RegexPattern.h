@@ -39,6 +39,12 @@ public:
 
     bool match(const char *str) const {return regexec(&regex,str,0,nullptr,0)==0;}
 
+    /// the regex in the text form, as given to regcomp(3)
+    const SBuf &text() const { return pattern; }
+
+    /// the REG_* flags given to regcomp(3)
+    int regcompFlags() const { return flags; }
+
     /// Attempts to reproduce this regex (context-sensitive) configuration.
     /// If the previous regex is nil, may not report default flags.
     /// Otherwise, may not report same-as-previous flags (and prepends a space).
@@ -0,0 +1,410 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "base/AsyncFunCalls.h"
+#include "base/Assure.h"
+#include "base/RegexSet.h"
+#include "base/RunnersRegistry.h"
+#include "debug/Stream.h"
+#include "sbuf/Stream.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#if HAVE_LIBRE2 && HAVE_RE2_SET_H
+#include <re2/re2.h>
+#include <re2/set.h>
+
+/// whether RE2 in POSIX mode interprets the given regcomp(3) pattern the same
+/// way the libc regex engine does; errs on the side of saying "no"
+static bool
+Re2Compatible(const SBuf &pattern, const int flags)
+{
+    // REG_NEWLINE changes anchor and dot semantics; basic REs differ a lot
+    if (!(flags & REG_EXTENDED) || (flags & ~(REG_EXTENDED|REG_ICASE|REG_NOSUB)))
+        return false;
+
+    const auto end = pattern.rawContent() + pattern.length();
+    for (auto it = pattern.rawContent(); it != end; ++it) {
+        const auto c = static_cast<unsigned char>(*it);
+
+        // RE2 and the C locale may case-fold non-ASCII bytes differently
+        if (c >= 0x80 && (flags & REG_ICASE))
+            return false;
+
+        if (c == '\\') {
+            if (++it == end)
+                return false;
+            // GNU escapes such as \< or \w and RE2 escapes such as \d differ
+            const auto escaped = static_cast<unsigned char>(*it);
+            if (xisalnum(escaped) || escaped == '<' || escaped == '>' || escaped == '`' || escaped == '\'')
+                return false;
+            continue;
+        }
+
+        // mid-pattern anchors match around newlines in some libc versions
+        if (c == '^' && it != pattern.rawContent() && !strchr("(|", *(it - 1)))
+            return false;
+        if (c == '$' && it + 1 != end && !strchr(")|", *(it + 1)))
+            return false;
+
+        // regcomp(3) reads "{,n}" as "{0,n}" but RE2 sees literal text; RE2
+        // also takes other malformed intervals literally
+        if (c == '{' && (it + 1 == end || !xisdigit(*(it + 1))))
+            return false;
+
+        if (c == '[') {
+            // bracket expressions: ']' is literal when it comes first
+            if (++it != end && *it == '^')
+                ++it;
+            if (it != end && *it == ']')
+                ++it;
+            for (; it != end && *it != ']'; ++it) {
+                // backslashes are literal in POSIX brackets but not in RE2
+                if (*it == '\\')
+                    return false;
+                if (*it == '[') {
+                    // RE2 supports [:class:] but not [.coll.] or [=equiv=]
+                    if (++it == end || *it != ':')
+                        return false;
+                    static const char classSuffix[] = ":]";
+                    const auto classEnd = std::search(it, end, classSuffix, classSuffix + 2);
+                    if (classEnd == end)
+                        return false;
+                    it = classEnd + 1;
+                }
+            }
+            if (it == end)
+                return false;
+        }
+    }
+    return true;
+}
+
+/// RE2-based matching of compatible RegexSet patterns, with regexec(3)
+/// matching of the remaining ones
+class RegexSet::Engine
+{
+public:
+    using Patterns = std::vector<const RegexPattern *>;
+
+    explicit Engine(const Patterns &);
+
+    /// \returns the lowest position of a pattern matching the given string
+    std::optional<size_t> firstMatch(const Patterns &, const char *) const;
+
+    /// the number of patterns matched by RE2
+    size_t setMatched() const { return caseSensitivePositions_.size() + caseInsensitivePositions_.size(); }
+
+private:
+    static RE2::Options Options(const bool caseSensitive) {
+        RE2::Options options;
+        options.set_posix_syntax(true);
+        options.set_word_boundary(false);
+        options.set_perl_classes(false);
+        options.set_encoding(RE2::Options::EncodingLatin1);
+        options.set_case_sensitive(caseSensitive);
+        options.set_dot_nl(true); // like regcomp(3) without REG_NEWLINE
+        options.set_one_line(true); // ditto, for ^ and $
+        options.set_never_capture(true);
+        options.set_log_errors(false);
+        options.set_max_mem(MaxMemory);
+        return options;
+    }
+
+    bool add(const RegexPattern &, size_t position);
+    bool compile();
+    void forgetSets();
+
+    bool setMatch(const char *, std::optional<size_t> &) const;
+    bool setMatch(const RE2::Set &, const std::vector<size_t> &positions, const re2::StringPiece &, std::optional<size_t> &) const;
+
+    /// RE2 memory budget for each set; large sets beyond it are not compiled
+    static const int64_t MaxMemory = 256*1024*1024;
+
+    RE2::Set caseSensitive_;
+    RE2::Set caseInsensitive_;
+
+    /// RegexSet positions of caseSensitive_ patterns, in their RE2::Set order
+    std::vector<size_t> caseSensitivePositions_;
+    /// RegexSet positions of caseInsensitive_ patterns, in their RE2::Set order
+    std::vector<size_t> caseInsensitivePositions_;
+
+    /// ascending positions of patterns that must be matched by regexec(3)
+    std::vector<size_t> individuals_;
+
+    /// reusable RE2::Set::Match() results storage
+    mutable std::vector<int> matches_;
+};
+
+RegexSet::Engine::Engine(const Patterns &patterns):
+    caseSensitive_(Options(true), RE2::UNANCHORED),
+    caseInsensitive_(Options(false), RE2::UNANCHORED)
+{
+    for (size_t position = 0; position < patterns.size(); ++position) {
+        const auto &pattern = *patterns[position];
+        if (!Re2Compatible(pattern.text(), pattern.regcompFlags()) || !add(pattern, position))
+            individuals_.push_back(position);
+    }
+
+    if (!compile()) {
+        debugs(28, DBG_IMPORTANT, "WARNING: Cannot match " << patterns.size() << " regular expressions together; " <<
+               "will match them one by one" <<
+               Debug::Extra << "cause: RE2 memory limit exceeded");
+        forgetSets();
+        individuals_.clear();
+        for (size_t position = 0; position < patterns.size(); ++position)
+            individuals_.push_back(position);
+    }
+}
+
+/// \returns whether the pattern at the given RegexSet position was added
+bool
+RegexSet::Engine::add(const RegexPattern &pattern, const size_t position)
+{
+    const auto sensitive = pattern.caseSensitive();
+    auto &set = sensitive ? caseSensitive_ : caseInsensitive_;
+    auto &positions = sensitive ? caseSensitivePositions_ : caseInsensitivePositions_;
+    std::string error;
+    const auto &text = pattern.text();
+    if (set.Add(re2::StringPiece(text.rawContent(), text.length()), &error) < 0) {
+        debugs(28, 3, "regexec(3) fallback for " << pattern << ": " << error);
+        return false;
+    }
+    positions.push_back(position);
+    return true;
+}
+
+/// \returns whether the engine is ready for setMatch() calls
+bool
+RegexSet::Engine::compile()
+{
+    if (!caseSensitivePositions_.empty() && !caseSensitive_.Compile())
+        return false;
+    if (!caseInsensitivePositions_.empty() && !caseInsensitive_.Compile())
+        return false;
+    return true;
+}
+
+/// stops using RE2 sets (but does not free their memory)
+void
+RegexSet::Engine::forgetSets()
+{
+    caseSensitivePositions_.clear();
+    caseInsensitivePositions_.clear();
+}
+
+std::optional<size_t>
+RegexSet::Engine::firstMatch(const Patterns &patterns, const char * const str) const
+{
+    std::optional<size_t> found;
+    if (!setMatch(str, found)) {
+        // rare matching failures (e.g., DFA memory exhaustion)
+        for (size_t position = 0; position < patterns.size(); ++position) {
+            if (patterns[position]->match(str))
+                return position;
+        }
+        return std::nullopt;
+    }
+
+    // individually matched patterns preceding the set-matched one, if any
+    for (const auto position: individuals_) {
+        if (found && position > *found)
+            break;
+        if (patterns[position]->match(str))
+            return position;
+    }
+
+    return found;
+}
+
+/// finds the lowest position of a set-matched pattern matching the given string
+/// \retval false if matching failed and the caller must fall back
+bool
+RegexSet::Engine::setMatch(const char * const str, std::optional<size_t> &position) const
+{
+    const re2::StringPiece text(str);
+    return setMatch(caseSensitive_, caseSensitivePositions_, text, position) &&
+           setMatch(caseInsensitive_, caseInsensitivePositions_, text, position);
+}
+
+bool
+RegexSet::Engine::setMatch(const RE2::Set &set, const std::vector<size_t> &positions, const re2::StringPiece &text, std::optional<size_t> &position) const
+{
+    if (positions.empty())
+        return true;
+
+    RE2::Set::ErrorInfo error;
+    if (!set.Match(text, &matches_, &error)) {
+        if (error.kind != RE2::Set::kNoError) {
+            debugs(28, 3, "RE2::Set::Match() failure: " << static_cast<int>(error.kind));
+            return false;
+        }
+        return true; // no matches
+    }
+
+    for (const auto i: matches_) {
+        const auto candidate = positions[i];
+        if (!position || candidate < *position)
+            position = candidate;
+    }
+    return true;
+}
+
+#else /* HAVE_LIBRE2 */
+
+/// a placeholder for builds without a set-matching engine
+class RegexSet::Engine
+{
+};
+
+#endif /* HAVE_LIBRE2 */
+
+/// Engines in use, indexed by EngineKey() of their patterns. Lets RegexSet
+/// objects with identical patterns share compiled patterns (and RE2 DFA state).
+using Engines = std::map<SBuf, std::weak_ptr<const RegexSet::Engine> >;
+
+static Engines &
+TheEngines()
+{
+    static const auto engines = new Engines();
+    return *engines;
+}
+
+/// engines of the previous configuration, kept for reuse until the current
+/// configuration has been applied
+static std::vector< std::shared_ptr<const RegexSet::Engine> > &
+RetainedEngines()
+{
+    static const auto engines = new std::vector< std::shared_ptr<const RegexSet::Engine> >();
+    return *engines;
+}
+
+#if HAVE_LIBRE2 && HAVE_RE2_SET_H
+/// identifies an ordered sequence of patterns, including their regcomp(3) flags
+static SBuf
+EngineKey(const std::vector<const RegexPattern *> &patterns)
+{
+    SBufStream key;
+    for (const auto pattern: patterns)
+        key << pattern->regcompFlags() << ' ' << pattern->text().length() << ' ' << pattern->text();
+    return key.buf();
+}
+
+#endif
+
+/// releases engines that the current configuration did not reuse
+static void
+ForgetRetainedEngines()
+{
+    debugs(28, 3, "previously used: " << RetainedEngines().size());
+    RetainedEngines().clear();
+
+    auto &engines = TheEngines();
+    for (auto it = engines.begin(); it != engines.end();) {
+        if (it->second.expired())
+            it = engines.erase(it);
+        else
+            ++it;
+    }
+    debugs(28, 3, "still used: " << engines.size());
+}
+
+/// keeps compiled RegexSet patterns across reconfiguration
+class RegexSetRr: public RegisteredRunner
+{
+public:
+    /* RegisteredRunner API */
+    void startReconfigure() override;
+    void syncConfig() override;
+};
+
+DefineRunnerRegistrator(RegexSetRr);
+
+void
+RegexSetRr::startReconfigure()
+{
+    // the old configuration objects are about to be destroyed
+    for (const auto &keyAndEngine: TheEngines()) {
+        if (const auto engine = keyAndEngine.second.lock())
+            RetainedEngines().push_back(engine);
+    }
+}
+
+void
+RegexSetRr::syncConfig()
+{
+    // other modules may still compile their RegexSets during this step
+    const auto call = asyncCall(28, 3, "ForgetRetainedEngines", NullaryFunDialer(&ForgetRetainedEngines));
+    ScheduleCallHere(call);
+}
+
+bool
+RegexSet::Supported()
+{
+#if HAVE_LIBRE2 && HAVE_RE2_SET_H
+    return true;
+#else
+    return false;
+#endif
+}
+
+RegexSet::RegexSet() = default;
+
+RegexSet::~RegexSet() = default;
+
+void
+RegexSet::add(const RegexPattern &pattern)
+{
+    Assure(!engine_);
+    patterns_.push_back(&pattern);
+}
+
+void
+RegexSet::compile()
+{
+#if HAVE_LIBRE2 && HAVE_RE2_SET_H
+    auto &cached = TheEngines()[EngineKey(patterns_)];
+    if ((engine_ = cached.lock())) {
+        debugs(28, 3, "reusing compiled " << patterns_.size() << " patterns");
+    } else {
+        engine_ = std::make_shared<const Engine>(patterns_);
+        cached = engine_;
+    }
+#endif
+
+    debugs(28, 3, "matching " << setMatched() << " out of " << patterns_.size() << " patterns together");
+}
+
+size_t
+RegexSet::setMatched() const
+{
+#if HAVE_LIBRE2 && HAVE_RE2_SET_H
+    if (engine_)
+        return engine_->setMatched();
+#endif
+    return 0;
+}
+
+std::optional<size_t>
+RegexSet::firstMatch(const char * const str) const
+{
+#if HAVE_LIBRE2 && HAVE_RE2_SET_H
+    if (engine_)
+        return engine_->firstMatch(patterns_, str);
+#endif
+
+    for (size_t position = 0; position < patterns_.size(); ++position) {
+        if (patterns_[position]->match(str))
+            return position;
+    }
+    return std::nullopt;
+}
+
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_BASE_REGEXSET_H
+#define SQUID_SRC_BASE_REGEXSET_H
+
+#include "base/RegexPattern.h"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * An ordered collection of regular expressions that finds the first (i.e.
+ * the lowest-position) pattern matching a given string.
+ *
+ * When Squid is built with RE2, patterns that RE2 interprets exactly like
+ * regcomp(3) does are matched together, in a single pass over the string.
+ * The remaining patterns are tried one by one, using regexec(3).
+ */
+class RegexSet
+{
+public:
+    /// set-matching implementation details, including compiled patterns
+    /// that may be shared by RegexSet objects with identical patterns
+    class Engine;
+
+    /// whether this Squid build can match patterns together
+    static bool Supported();
+
+    RegexSet();
+    ~RegexSet();
+
+    RegexSet(RegexSet &&) = delete; // no copying of any kind
+
+    /// Appends a pattern to the set. The pattern must outlive the set.
+    /// Must not be called after compile().
+    void add(const RegexPattern &);
+
+    /// Prepares the added patterns for efficient firstMatch() calls. Reuses
+    /// patterns compiled by an identical RegexSet of the previous Squid
+    /// configuration, if any.
+    void compile();
+
+    /// \returns the position of the first pattern matching the given string
+    std::optional<size_t> firstMatch(const char *) const;
+
+    /// the pattern at the given position
+    const RegexPattern &at(const size_t position) const { return *patterns_.at(position); }
+
+    /// the number of added patterns
+    size_t size() const { return patterns_.size(); }
+
+    /// the number of patterns matched together, without regexec(3)
+    size_t setMatched() const;
+
+private:
+    /// all added patterns, in the order of addition
+    std::vector<const RegexPattern *> patterns_;
+
+    /// matches added patterns; nil before compile() and when Squid is built
+    /// without a set-matching engine
+    std::shared_ptr<const Engine> engine_;
+};
+
+#endif /* SQUID_SRC_BASE_REGEXSET_H */
+
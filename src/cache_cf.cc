@@ -49,6 +49,7 @@
 #include "ip/QosConfig.h"
 #include "ip/tools.h"
 #include "ipc/Kids.h"
+#include "ipc/StoreMap.h"
 #include "log/Config.h"
 #include "log/CustomLog.h"
 #include "MemBuf.h"
@@ -995,6 +996,12 @@ configDoConfigure(void)
                (uint32_t)Config.maxRequestBufferSize, (uint32_t)Config.maxRequestHeaderSize);
     }
 
+    // a 100% or larger window would refresh every used entry all the time
+    if (Config.ipcache.prefetch < 0 || Config.ipcache.prefetch > 99) {
+        fatalf("ipcache_prefetch must be between 1 and 99 percent (or 0 to disable prefetching); got %d",
+               Config.ipcache.prefetch);
+    }
+
     // Warn about the dangers of exceeding String limits when manipulating HTTP
     // headers. Technically, we do not concatenate _requests_, so we could relax
     // their check, but we keep the two checks the same for simplicity sake.
@@ -3273,6 +3280,22 @@ parse_memcachemode(SquidConfig *)
     }
 }
 
+static void
+free_storemappolicy(Ipc::StoreMapPolicy *)
+{}
+
+static void
+parse_storemappolicy(Ipc::StoreMapPolicy *policy)
+{
+    *policy = Ipc::StoreMap::ParsePolicy(LegacyParser.token("replacement policy"));
+}
+
+static void
+dump_storemappolicy(StoreEntry * entry, const char *name, const Ipc::StoreMapPolicy policy)
+{
+    storeAppendPrintf(entry, "%s %s\n", name, Ipc::StoreMap::PolicyName(policy));
+}
+
 static void
 dump_memcachemode(StoreEntry * entry, const char *name, SquidConfig &)
 {
@@ -3688,6 +3711,12 @@ parse_port_option(AnyP::PortCfgPointer &s, char *token)
         throw TexcHere(ToSBuf(cfg_directive, ' ', token, " option requires building Squid where SO_REUSEPORT is supported by the TCP stack"));
 #endif
         s->workerQueues = true;
+    } else if (strcmp(token, "worker-queues=cpu") == 0) {
+#if !defined(SO_REUSEPORT) || !HAVE_LINUX_FILTER_H || !defined(SO_ATTACH_REUSEPORT_CBPF)
+        throw TexcHere(ToSBuf(cfg_directive, ' ', token, " option requires building Squid where SO_REUSEPORT and SO_ATTACH_REUSEPORT_CBPF are supported by the TCP stack"));
+#endif
+        s->workerQueues = true;
+        s->cpuSteering = true;
     } else {
         debugs(3, DBG_CRITICAL, "FATAL: Unknown " << cfg_directive << " option '" << token << "'.");
         self_destruct();
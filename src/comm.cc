@@ -16,6 +16,7 @@
 #include "comm/comm_internal.h"
 #include "comm/Connection.h"
 #include "comm/IoCallback.h"
+#include "comm/IoUringPoll.h"
 #include "comm/Loops.h"
 #include "comm/Read.h"
 #include "comm/TcpAcceptor.h"
@@ -1159,6 +1160,10 @@ comm_exit(void)
 {
     delete TheHalfClosed;
     TheHalfClosed = nullptr;
+
+#if USE_IO_URING
+    Comm::IoUringPoll::Stop();
+#endif
 }
 
 #if USE_DELAY_POOLS
@@ -54,6 +54,8 @@ namespace Comm
 #define COMM_ORPHANED           0x80
 /// Internal Comm optimization: Keep the source port unassigned until connect(2)
 #define COMM_DOBIND_PORT_LATER 0x100
+/// COMM_REUSEPORT listener in a group steering connections by receiving CPU
+#define COMM_REUSEPORT_CPU     0x200
 
 /**
  * Store data about the physical and logical attributes of a connection.
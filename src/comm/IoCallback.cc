@@ -68,6 +68,9 @@ Comm::IoCallback::setCallback(Comm::iocb_type t, AsyncCall::Pointer &cb, char *b
     freefunc = f;
     size = sz;
     offset = 0;
+    extrasCount = 0;
+    fileFd = -1;
+    fileOffset = 0;
 }
 
 void
@@ -104,6 +107,8 @@ Comm::IoCallback::reset()
         freefunc = nullptr;
     }
     xerrno = 0;
+    extrasCount = 0;
+    fileFd = -1;
 
 #if USE_DELAY_POOLS
     quotaQueueReserv = 0;
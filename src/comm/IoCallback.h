@@ -12,6 +12,7 @@
 #include "base/AsyncCall.h"
 #include "comm/Flag.h"
 #include "comm/forward.h"
+#include "comm/Write.h"
 #include "mem/forward.h"
 #include "sbuf/forward.h"
 
@@ -34,8 +35,15 @@ public:
     AsyncCall::Pointer callback;
     char *buf;
     FREE *freefunc;
-    int size;
+    int size; ///< the total number of bytes to write or read, including extras
     int offset;
+    /// caller-owned buffers to write after buf; see Comm::Write() with extras
+    IoSegment extras[MaxIoSegments];
+    int extrasCount; ///< the number of used extras[] entries
+    /// when non-negative, the file to send size bytes from instead of buf;
+    /// see Comm::SendFile()
+    int fileFd;
+    int64_t fileOffset; ///< where in fileFd the size bytes start
     Comm::Flag errcode;
     int xerrno;
 #if USE_DELAY_POOLS
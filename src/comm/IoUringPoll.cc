@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 05    Socket Functions */
+
+#include "squid.h"
+
+#if USE_IO_URING
+
+#include "base/TextException.h"
+#include "comm/IoUringPoll.h"
+#include "debug/Stream.h"
+#include "ipc/IoUringRing.h"
+#include "sbuf/Stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <endian.h>
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+
+namespace Comm
+{
+namespace IoUringPoll
+{
+
+/// io_uring monitoring state of a single descriptor
+class Watcher
+{
+public:
+    uint32_t wanted = 0; ///< the events we should be monitoring for
+    uint32_t armed = 0; ///< the events monitored by our pending poll request
+    uint32_t generation = 0; ///< identifies our most recent poll request
+    bool exclusive = false; ///< whether EPOLLEXCLUSIVE monitoring was requested
+    bool scheduled = false; ///< whether we are waiting in Ring::toArm
+};
+
+/// a memory-mapped io_uring instance used for readiness notifications
+class Ring
+{
+public:
+    bool start(int maxFd);
+
+    /// releases the ring and its memory mappings
+    void stop();
+
+    Watcher &watcher(int fd);
+
+    /// arms a poll request for the descriptor before the next wait
+    void scheduleArming(int fd, Watcher &);
+
+    /// queues cancellation of the pending poll request of the descriptor
+    void cancelPoll(int fd, Watcher &);
+
+    /// submits all queued entries without waiting for completions
+    void flush();
+
+    int wait(struct epoll_event *events, int maxEvents, int msec);
+
+    /// the ring in use (if any)
+    std::unique_ptr<Ipc::IoUringRing> ring;
+
+private:
+    void armPoll(int fd, Watcher &);
+    int enter(unsigned minComplete, int msec);
+    int reap(struct epoll_event *events, int maxEvents);
+
+    std::vector<Watcher> watchers; ///< per-descriptor state, indexed by fd
+    std::vector<int> toArm; ///< descriptors that may need a new poll request
+
+    /// whether the kernel accepts EPOLLEXCLUSIVE in poll requests
+    bool exclusiveWorks = true;
+};
+
+/// user_data of requests with completions we do not care about
+static const uint64_t IgnoredCompletion = UINT64_MAX;
+
+static Ring TheRing;
+
+/// the io_uring_sqe::poll32_events representation of the given event mask
+static uint32_t
+PollEvents(uint32_t events)
+{
+#if __BYTE_ORDER == __BIG_ENDIAN
+    events = (events << 16) | (events >> 16); // the kernel expects swapped halves
+#endif
+    return events;
+}
+
+/// identifies a poll request
+static uint64_t
+UserData(const int fd, const uint32_t generation)
+{
+    return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
+
+} // namespace IoUringPoll
+} // namespace Comm
+
+bool
+Comm::IoUringPoll::Ring::start(const int maxFd)
+{
+    try {
+        ring.reset(new Ipc::IoUringRing(std::clamp(maxFd, 64, 32768)));
+        const auto required = IORING_FEAT_POLL_32BITS | IORING_FEAT_EXT_ARG;
+        if ((ring->features() & required) != required)
+            throw TextException(ToSBuf("io_uring lacks required features: ", ring->features()), Here());
+    } catch (...) {
+        debugs(5, DBG_IMPORTANT, "io_uring is not usable; using epoll(2) instead" <<
+               Debug::Extra << "problem: " << CurrentException);
+        ring.reset();
+        return false;
+    }
+
+    watchers.resize(maxFd);
+
+    debugs(5, DBG_IMPORTANT, "Using io_uring for network I/O readiness notifications" <<
+           Debug::Extra << "submission queue entries: " << ring->submissionQueueSize() <<
+           Debug::Extra << "completion queue entries: " << ring->completionQueueSize());
+    return true;
+}
+
+void
+Comm::IoUringPoll::Ring::stop()
+{
+    ring.reset(); // the kernel cancels pending poll requests
+    watchers.clear();
+    toArm.clear();
+}
+
+Comm::IoUringPoll::Watcher &
+Comm::IoUringPoll::Ring::watcher(const int aFd)
+{
+    assert(aFd >= 0 && static_cast<size_t>(aFd) < watchers.size());
+    return watchers[aFd];
+}
+
+/// Queues a one-shot poll request. We do not use IORING_POLL_ADD_MULTI
+/// because the kernel makes multishot polls edge-triggered: Their completions
+/// only follow new wakeups. Comm handlers rely on level-triggered readiness
+/// (e.g., TcpAcceptor accepts one connection per notification, and readers may
+/// leave data in the socket buffer), so a multishot poll would stall them.
+/// Re-arming adds one submission queue entry per notification, submitted by
+/// the io_uring_enter(2) call that waits for the next completions.
+void
+Comm::IoUringPoll::Ring::armPoll(const int aFd, Watcher &w)
+{
+    ++w.generation;
+    w.armed = w.wanted;
+    auto events = w.armed;
+#if defined(EPOLLEXCLUSIVE)
+    if (w.exclusive && exclusiveWorks)
+        events |= EPOLLEXCLUSIVE;
+#endif
+
+    auto &sqe = ring->nextSqe();
+    sqe.opcode = IORING_OP_POLL_ADD;
+    sqe.fd = aFd;
+    sqe.poll32_events = PollEvents(events);
+    sqe.user_data = UserData(aFd, w.generation);
+}
+
+void
+Comm::IoUringPoll::Ring::scheduleArming(const int aFd, Watcher &w)
+{
+    if (!w.scheduled) {
+        w.scheduled = true;
+        toArm.push_back(aFd);
+    }
+}
+
+void
+Comm::IoUringPoll::Ring::cancelPoll(const int aFd, Watcher &w)
+{
+    auto &sqe = ring->nextSqe();
+    sqe.opcode = IORING_OP_POLL_REMOVE;
+    sqe.fd = -1;
+    sqe.addr = UserData(aFd, w.generation);
+    sqe.user_data = IgnoredCompletion;
+
+    w.armed = 0;
+    ++w.generation; // ignore the cancelled request completion, if any
+}
+
+/// submits queued entries and, if minComplete is positive, waits for
+/// completions for up to msec milliseconds
+int
+Comm::IoUringPoll::Ring::enter(const unsigned minComplete, const int msec)
+{
+    unsigned flags = 0;
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    __kernel_timespec timeout;
+    memset(&timeout, 0, sizeof(timeout));
+    if (minComplete) {
+        timeout.tv_sec = msec / 1000;
+        timeout.tv_nsec = (msec % 1000) * 1000000L;
+        arg.ts = reinterpret_cast<uint64_t>(&timeout);
+        flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+    }
+
+    return ring->enter(minComplete, flags, minComplete ? &arg : nullptr, minComplete ? sizeof(arg) : 0);
+}
+
+void
+Comm::IoUringPoll::Ring::flush()
+{
+    try {
+        ring->submit();
+    } catch (...) {
+        debugs(5, DBG_IMPORTANT, "ERROR: cannot submit io_uring requests: " << CurrentException);
+    }
+}
+
+/// converts available completions into (at most maxEvents) epoll events
+int
+Comm::IoUringPoll::Ring::reap(struct epoll_event *events, const int maxEvents)
+{
+    int count = 0;
+    while (count < maxEvents && ring->hasCompletions()) {
+        const auto cqe = ring->frontCompletion(); // a copy; the slot is reused below
+        ring->popCompletion();
+
+        if (cqe.user_data == IgnoredCompletion)
+            continue;
+
+        const auto aFd = static_cast<int>(cqe.user_data & 0xFFFFFFFF);
+        const auto generation = static_cast<uint32_t>(cqe.user_data >> 32);
+        auto &w = watcher(aFd);
+        if (generation != w.generation || !w.armed)
+            continue; // a stale completion of a cancelled or replaced request
+
+        w.armed = 0;
+        if (w.wanted)
+            scheduleArming(aFd, w); // poll requests are one-shot
+
+        if (cqe.res == -EINVAL && w.exclusive && exclusiveWorks) {
+            debugs(5, 2, "kernel rejects EPOLLEXCLUSIVE io_uring polls");
+            exclusiveWorks = false;
+            continue;
+        }
+
+        if (cqe.res == -ECANCELED)
+            continue;
+
+        events[count].events = cqe.res < 0 ? EPOLLERR : static_cast<uint32_t>(cqe.res);
+        events[count].data.fd = aFd;
+        ++count;
+    }
+    return count;
+}
+
+int
+Comm::IoUringPoll::Ring::wait(struct epoll_event *events, const int maxEvents, const int msec)
+{
+    for (const auto aFd: toArm) {
+        auto &w = watcher(aFd);
+        w.scheduled = false;
+        if (w.wanted && !w.armed)
+            armPoll(aFd, w);
+    }
+    toArm.clear();
+
+    // do not sleep if completions are already waiting for us
+    const auto pending = ring->hasCompletions();
+    if ((!pending || ring->unsubmitted()) && enter(pending ? 0 : 1, msec) < 0) {
+        const auto xerrno = errno;
+        if (xerrno != ETIME && xerrno != EINTR)
+            return -1;
+    }
+
+    return reap(events, maxEvents);
+}
+
+bool
+Comm::IoUringPoll::Start(const int maxFd)
+{
+    return TheRing.start(maxFd);
+}
+
+void
+Comm::IoUringPoll::Stop()
+{
+    if (TheRing.ring) {
+        debugs(5, 2, "io_uring_enter(2) calls: " << TheRing.ring->enterCalls);
+        TheRing.stop();
+    }
+}
+
+bool
+Comm::IoUringPoll::Active()
+{
+    return bool(TheRing.ring);
+}
+
+void
+Comm::IoUringPoll::Watch(const int fd, uint32_t events)
+{
+    auto &w = TheRing.watcher(fd);
+#if defined(EPOLLEXCLUSIVE)
+    w.exclusive = events & EPOLLEXCLUSIVE;
+    events &= ~EPOLLEXCLUSIVE;
+#endif
+    w.wanted = events;
+
+    if (w.armed && w.armed != events) {
+        TheRing.cancelPoll(fd, w);
+        // a pending poll request keeps the descriptor open; submit the
+        // cancellation now because the caller may be about to close(2) it
+        if (!events)
+            TheRing.flush();
+    }
+
+    if (w.wanted && !w.armed)
+        TheRing.scheduleArming(fd, w);
+}
+
+int
+Comm::IoUringPoll::Wait(struct epoll_event *events, const int maxEvents, const int msec)
+{
+    return TheRing.wait(events, maxEvents, msec);
+}
+
+uint64_t
+Comm::IoUringPoll::EnterCalls()
+{
+    return TheRing.ring ? TheRing.ring->enterCalls : 0;
+}
+
+uint64_t
+Comm::IoUringPoll::SubmittedEntries()
+{
+    return TheRing.ring ? TheRing.ring->submitted : 0;
+}
+
+#endif /* USE_IO_URING */
+
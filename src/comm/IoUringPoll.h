@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_COMM_IOURINGPOLL_H
+#define SQUID_SRC_COMM_IOURINGPOLL_H
+
+#if USE_IO_URING
+
+#include <cstdint>
+
+struct epoll_event;
+
+namespace Comm
+{
+
+/// An io_uring(7) poll backend for the epoll I/O loop: Delivers descriptor
+/// readiness notifications using one-shot IORING_OP_POLL_ADD requests instead
+/// of an epoll(7) interest list. Interest changes are queued as submission
+/// queue entries and submitted by the io_uring_enter(2) call that waits for
+/// completions. Only readiness goes through the ring; comm handlers still
+/// accept(2), read(2), and write(2) using regular system calls.
+namespace IoUringPoll
+{
+
+/// Attempts to set up a ring. Returns false (after reporting the reason) when
+/// the running kernel lacks io_uring features we depend on; the caller should
+/// use epoll(2) in that case.
+bool Start(int maxFd);
+
+/// Releases the ring started by Start(), if any. Afterwards, Active() is false.
+void Stop();
+
+/// whether Start() succeeded and the ring is being used
+bool Active();
+
+/// Sets the epoll(7)-style event mask the given descriptor is monitored for.
+/// A zero mask stops monitoring. EPOLLEXCLUSIVE is honored when supported.
+void Watch(int fd, uint32_t events);
+
+/// Submits queued interest changes and waits up to msec milliseconds for
+/// ready descriptors, storing at most maxEvents of them in the given array.
+/// \returns the number of stored events or -1 (with errno set) on errors
+int Wait(struct epoll_event *events, int maxEvents, int msec);
+
+/// the number of io_uring_enter(2) calls made so far
+uint64_t EnterCalls();
+
+/// the number of submission queue entries submitted so far
+uint64_t SubmittedEntries();
+
+} // namespace IoUringPoll
+
+} // namespace Comm
+
+#endif /* USE_IO_URING */
+
+#endif /* SQUID_SRC_COMM_IOURINGPOLL_H */
+
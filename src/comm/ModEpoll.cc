@@ -34,10 +34,13 @@
 
 #include "base/CodeContext.h"
 #include "base/IoManip.h"
+#include "base/Stopwatch.h"
+#include "comm/IoUringPoll.h"
 #include "comm/Loops.h"
 #include "fde.h"
 #include "globals.h"
 #include "mgr/Registration.h"
+#include "SquidConfig.h"
 #include "StatCounters.h"
 #include "StatHist.h"
 #include "Store.h"
@@ -54,6 +57,52 @@ static int max_poll_time = 1000;
 
 static struct epoll_event *pevents;
 
+/// epoll_wait(2) batching statistics for the comm_epoll_incoming report
+class EpollStats
+{
+public:
+    uint64_t wakeups = 0; ///< epoll_wait(2) calls that returned some events
+    uint64_t events = 0; ///< the total number of harvested events
+    uint64_t fullBatches = 0; ///< wakeups that filled the entire events buffer
+    int maxBatch = 0; ///< the largest number of events harvested at once
+    uint64_t exclusiveListeners = 0; ///< new EPOLLEXCLUSIVE registrations
+    Stopwatch handlers; ///< time spent dispatching I/O handlers
+};
+
+static EpollStats TheEpollStats;
+
+/// the maximum number of events to harvest with one epoll_wait(2) call
+static int
+maxEventsPerWait()
+{
+    const auto configured = Config.epollMaxEvents;
+    return (configured > 0 && configured < SQUID_MAXFD) ? configured : SQUID_MAXFD;
+}
+
+/// epoll_ctl(2) replacement that uses io_uring when it is available
+static int
+epollControl(const int op, const int fd, struct epoll_event *ev)
+{
+#if USE_IO_URING
+    if (Comm::IoUringPoll::Active()) {
+        Comm::IoUringPoll::Watch(fd, op == EPOLL_CTL_DEL ? 0 : ev->events);
+        return 0;
+    }
+#endif
+    return epoll_ctl(kdpfd, op, fd, ev);
+}
+
+/// epoll_wait(2) replacement that uses io_uring when it is available
+static int
+epollWait(const int maxEvents, const int msec)
+{
+#if USE_IO_URING
+    if (Comm::IoUringPoll::Active())
+        return Comm::IoUringPoll::Wait(pevents, maxEvents, msec);
+#endif
+    return epoll_wait(kdpfd, pevents, maxEvents, msec);
+}
+
 static void commEPollRegisterWithCacheManager(void);
 
 /* XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX */
@@ -73,6 +122,13 @@ Comm::SelectLoopInit(void)
         fatalf("comm_select_init: xmalloc() failed: %s\n", xstrerr(xerrno));
     }
 
+#if USE_IO_URING
+    if (Comm::IoUringPoll::Start(SQUID_MAXFD)) {
+        commEPollRegisterWithCacheManager();
+        return;
+    }
+#endif
+
     kdpfd = epoll_create(SQUID_MAXFD);
 
     if (kdpfd < 0) {
@@ -121,7 +177,7 @@ Comm::SetSelect(int fd, unsigned int type, PF * handler, void *client_data, time
     ev.data.fd = fd;
 
     if (!F->flags.open) {
-        epoll_ctl(kdpfd, EPOLL_CTL_DEL, fd, &ev);
+        epollControl(EPOLL_CTL_DEL, fd, &ev);
         return;
     }
 
@@ -169,7 +225,21 @@ Comm::SetSelect(int fd, unsigned int type, PF * handler, void *client_data, time
 
         F->epoll_state = ev.events;
 
-        if (epoll_ctl(kdpfd, epoll_ctl_type, fd, &ev) < 0) {
+#if defined(EPOLLEXCLUSIVE)
+        // Wake up just one of the workers accepting from a shared listening
+        // socket instead of all of them. The kernel rejects EPOLL_CTL_MOD
+        // for EPOLLEXCLUSIVE registrations, so we re-add them instead.
+        if (F->flags.sharedListener && ev.events && !(ev.events & EPOLLOUT)) {
+            if (epoll_ctl_type == EPOLL_CTL_ADD)
+                ++TheEpollStats.exclusiveListeners; // a new registration
+            else if (epoll_ctl_type == EPOLL_CTL_MOD && kdpfd >= 0)
+                (void)epoll_ctl(kdpfd, EPOLL_CTL_DEL, fd, &ev);
+            epoll_ctl_type = EPOLL_CTL_ADD;
+            ev.events |= EPOLLEXCLUSIVE;
+        }
+#endif
+
+        if (epollControl(epoll_ctl_type, fd, &ev) < 0) {
             int xerrno = errno;
             debugs(5, DEBUG_EPOLL ? 0 : 8, "ERROR: epoll_ctl(," << epolltype_atoi(epoll_ctl_type) <<
                    ",,): failed on FD " << fd << ": " << xstrerr(xerrno));
@@ -200,7 +270,27 @@ static void
 commIncomingStats(StoreEntry * sentry)
 {
     StatCounters *f = &statCounter;
+    const auto &stats = TheEpollStats;
     storeAppendPrintf(sentry, "Total number of epoll(2) loops: %ld\n", statCounter.select_loops);
+#if USE_IO_URING
+    if (Comm::IoUringPoll::Active()) {
+        storeAppendPrintf(sentry, "Readiness notifications via io_uring: yes\n");
+        storeAppendPrintf(sentry, "io_uring_enter(2) calls: %" PRIu64 "\n", Comm::IoUringPoll::EnterCalls());
+        storeAppendPrintf(sentry, "io_uring submission queue entries: %" PRIu64 "\n", Comm::IoUringPoll::SubmittedEntries());
+    }
+#endif
+    storeAppendPrintf(sentry, "Maximum events per epoll_wait(2) call: %d\n", maxEventsPerWait());
+    storeAppendPrintf(sentry, "Wakeups with events: %" PRIu64 "\n", stats.wakeups);
+    storeAppendPrintf(sentry, "Events harvested: %" PRIu64 "\n", stats.events);
+    storeAppendPrintf(sentry, "Average events per wakeup: %.2f\n",
+                      stats.wakeups ? double(stats.events)/stats.wakeups : 0.0);
+    storeAppendPrintf(sentry, "Largest batch: %d\n", stats.maxBatch);
+    storeAppendPrintf(sentry, "Wakeups that filled the events buffer: %" PRIu64 "\n", stats.fullBatches);
+    storeAppendPrintf(sentry, "Exclusive listener registrations: %" PRIu64 "\n", stats.exclusiveListeners);
+    const auto handlerSeconds = std::chrono::duration<double>(stats.handlers.total()).count();
+    storeAppendPrintf(sentry, "Time spent in I/O handlers: %.6f seconds\n", handlerSeconds);
+    storeAppendPrintf(sentry, "Average handler time per wakeup: %.3f ms\n",
+                      stats.wakeups ? 1000*handlerSeconds/stats.wakeups : 0.0);
     storeAppendPrintf(sentry, "Histogram of returned filedescriptors\n");
     f->select_fds_hist.dump(sentry, statHistIntDumper);
 }
@@ -227,8 +317,10 @@ Comm::DoSelect(int msec)
     if (msec > max_poll_time)
         msec = max_poll_time;
 
+    const auto maxEvents = maxEventsPerWait();
+
     for (;;) {
-        num = epoll_wait(kdpfd, pevents, SQUID_MAXFD, msec);
+        num = epollWait(maxEvents, msec);
         ++ statCounter.select_loops;
 
         if (num >= 0)
@@ -249,6 +341,14 @@ Comm::DoSelect(int msec)
     if (num == 0)
         return Comm::TIMEOUT;       /* No error.. */
 
+    auto &stats = TheEpollStats;
+    ++stats.wakeups;
+    stats.events += num;
+    stats.maxBatch = max(stats.maxBatch, num);
+    if (num == maxEvents)
+        ++stats.fullBatches;
+    stats.handlers.resume();
+
     for (i = 0, cevents = pevents; i < num; ++i, ++cevents) {
         fd = cevents->data.fd;
         F = &fd_table[fd];
@@ -286,6 +386,8 @@ Comm::DoSelect(int msec)
         }
     }
 
+    stats.handlers.pause();
+
     CodeContext::Reset();
 
     return Comm::OK;
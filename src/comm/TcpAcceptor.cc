@@ -32,6 +32,7 @@
 #include "sbuf/Stream.h"
 #include "SquidConfig.h"
 #include "StatCounters.h"
+#include "tools.h"
 
 #include <cerrno>
 #ifdef HAVE_NETINET_TCP_H
@@ -180,6 +181,9 @@ Comm::TcpAcceptor::setListen()
 #endif
     }
 
+    // without worker-specific queues, all SMP workers accept from this socket
+    fd_table[conn->fd].flags.sharedListener = UsingSmp() && !(conn->flags & COMM_REUSEPORT);
+
     typedef CommCbMemFunT<Comm::TcpAcceptor, CommCloseCbParams> Dialer;
     closer_ = JobCallback(5, 4, Dialer, this, Comm::TcpAcceptor::handleClosure);
     comm_add_close_handler(conn->fd, closer_);
@@ -21,16 +21,20 @@
 #include "ClientInfo.h"
 #endif
 
+#include <algorithm>
 #include <cerrno>
+#if HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+#if HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 
-void
-Comm::Write(const Comm::ConnectionPointer &conn, MemBuf *mb, AsyncCall::Pointer &callback)
-{
-    Comm::Write(conn, mb->buf, mb->size, callback, mb->freeFunc());
-}
-
-void
-Comm::Write(const Comm::ConnectionPointer &conn, const char *buf, int size, AsyncCall::Pointer &callback, FREE * free_func)
+/// Comm::Write() and Comm::SendFile() helper: reserves the write callback of
+/// the given connection for a write of size bytes. The caller must finish
+/// describing the write before calling IoCallback::selectOrQueueWrite().
+static Comm::IoCallback &
+PrepareWrite(const Comm::ConnectionPointer &conn, const char *buf, const int size, AsyncCall::Pointer &callback, FREE * const free_func)
 {
     debugs(5, 5, conn << ": sz " << size << ": asynCall " << callback);
 
@@ -42,9 +46,120 @@ Comm::Write(const Comm::ConnectionPointer &conn, const char *buf, int size, Asyn
 
     fd_table[conn->fd].writeStart = squid_curtime;
     ccb->conn = conn;
+    ccb->setCallback(Comm::IOCB_WRITE, callback, (char *)buf, free_func, size);
+    return *ccb;
+}
+
+void
+Comm::Write(const Comm::ConnectionPointer &conn, MemBuf *mb, AsyncCall::Pointer &callback)
+{
+    Comm::Write(conn, mb->buf, mb->size, callback, mb->freeFunc());
+}
+
+void
+Comm::Write(const Comm::ConnectionPointer &conn, MemBuf *mb, const IoSegment *extras, const int extrasCount, AsyncCall::Pointer &callback)
+{
+    assert(extrasCount >= 0 && extrasCount <= MaxIoSegments);
+
+    auto size = mb->size;
+    for (int i = 0; i < extrasCount; ++i)
+        size += extras[i].size;
+
+    auto &ccb = PrepareWrite(conn, mb->buf, size, callback, mb->freeFunc());
+    for (int i = 0; i < extrasCount; ++i) {
+        if (extras[i].size > 0)
+            ccb.extras[ccb.extrasCount++] = extras[i];
+    }
+    ccb.selectOrQueueWrite();
+}
+
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+void
+Comm::SendFile(const Comm::ConnectionPointer &conn, const int fileFd, const int64_t fileOffset, const int size, AsyncCall::Pointer &callback)
+{
+    assert(fd_table[conn->fd].writesDirectly());
+    assert(fileFd >= 0);
+
+    auto &ccb = PrepareWrite(conn, nullptr, size, callback, nullptr);
+    ccb.fileFd = fileFd;
+    ccb.fileOffset = fileOffset;
+    ccb.selectOrQueueWrite();
+}
+#endif
+
+/// the size of the IoCallback::buf part of the scheduled write
+static int
+MainBufferSize(const Comm::IoCallback &state)
+{
+    auto bufSize = state.size;
+    for (int i = 0; i < state.extrasCount; ++i)
+        bufSize -= state.extras[i].size;
+    return bufSize;
+}
+
+/// Writes (some of) the first nleft unwritten bytes, gathering them from
+/// IoCallback::buf and IoCallback::extras. Uses a single writev(2) call when
+/// the descriptor is not subject to TLS or other write transformations.
+static int
+WriteSome(const int fd, const Comm::IoCallback &state, const int nleft)
+{
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+    if (state.fileFd >= 0) {
+        off_t fileOffset = state.fileOffset + state.offset;
+        return sendfile(fd, state.fileFd, &fileOffset, nleft);
+    }
+#endif
+
+    if (!state.extrasCount || nleft <= 0)
+        return FD_WRITE_METHOD(fd, state.buf + state.offset, nleft);
+
+    // collect the unwritten parts of all buffers, up to nleft bytes
+    Comm::IoSegment pieces[Comm::MaxIoSegments + 1];
+    int piecesCount = 0;
+    pieces[piecesCount++] = Comm::IoSegment{state.buf, MainBufferSize(state)};
+    for (int i = 0; i < state.extrasCount; ++i)
+        pieces[piecesCount++] = state.extras[i];
+
+    int skip = state.offset;
+    int want = nleft;
+    int first = 0;
+    while (first < piecesCount && skip >= pieces[first].size)
+        skip -= pieces[first++].size;
+    assert(first < piecesCount); // nleft is positive
+
+    pieces[first].data += skip;
+    pieces[first].size -= skip;
+    int last = first;
+    for (; last < piecesCount; ++last) {
+        pieces[last].size = std::min(pieces[last].size, want);
+        want -= pieces[last].size;
+        if (!want)
+            break;
+    }
+    last = std::min(last, piecesCount - 1);
+
+#if HAVE_SYS_UIO_H && !_SQUID_WINDOWS_
+    if (fd_table[fd].writesDirectly() && last > first) {
+        struct iovec iov[Comm::MaxIoSegments + 1];
+        int iovCount = 0;
+        for (int i = first; i <= last; ++i) {
+            iov[iovCount].iov_base = const_cast<char *>(pieces[i].data);
+            iov[iovCount].iov_len = pieces[i].size;
+            ++iovCount;
+        }
+        return writev(fd, iov, iovCount);
+    }
+#endif
+
+    // one buffer at a time; the caller will call us again for the rest
+    return FD_WRITE_METHOD(fd, pieces[first].data, pieces[first].size);
+}
+
+void
+Comm::Write(const Comm::ConnectionPointer &conn, const char *buf, int size, AsyncCall::Pointer &callback, FREE * free_func)
+{
     /* Queue the write */
-    ccb->setCallback(IOCB_WRITE, callback, (char *)buf, free_func, size);
-    ccb->selectOrQueueWrite();
+    PrepareWrite(conn, buf, size, callback, free_func).selectOrQueueWrite();
 }
 
 /** Write to FD.
@@ -80,7 +195,7 @@ Comm::HandleWrite(int fd, void *data)
 
     /* actually WRITE data */
     int xerrno = errno = 0;
-    len = FD_WRITE_METHOD(fd, state->buf + state->offset, nleft);
+    len = WriteSome(fd, *state, nleft);
     xerrno = errno;
     debugs(5, 5, "write() returns " << len);
 
@@ -17,6 +17,18 @@ class MemBuf;
 namespace Comm
 {
 
+/// A caller-owned buffer for scatter-gather Comm::Write() calls.
+/// Plain data because Comm::IoCallback tables bypass constructors.
+class IoSegment
+{
+public:
+    const char *data;
+    int size;
+};
+
+/// the maximum number of IoSegments accompanying a single Comm::Write()
+static const int MaxIoSegments = 4;
+
 /**
  * Queue a write. callback is scheduled when the write
  * completes, on error, or on file descriptor close.
@@ -31,6 +43,24 @@ void Write(const Comm::ConnectionPointer &conn, const char *buf, int size, Async
  */
 void Write(const Comm::ConnectionPointer &conn, MemBuf *mb, AsyncCall::Pointer &callback);
 
+/**
+ * Queue a write of mb followed by up to MaxIoSegments extra buffers,
+ * sending them with a single writev(2) call where possible. The extra
+ * buffers are not copied: The caller must keep them intact until the
+ * callback, which reports the total number of bytes written.
+ */
+void Write(const Comm::ConnectionPointer &conn, MemBuf *mb, const IoSegment *extras, int extrasCount, AsyncCall::Pointer &callback);
+
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+/**
+ * Queue a sendfile(2) of size bytes of the given regular file, starting at
+ * fileOffset. The file must stay open until the callback, which reports the
+ * number of bytes sent. The connection descriptor must be
+ * fde::writesDirectly().
+ */
+void SendFile(const Comm::ConnectionPointer &conn, int fileFd, int64_t fileOffset, int size, AsyncCall::Pointer &callback);
+#endif
+
 /// Cancel the write pending on FD. No action if none pending.
 void WriteCancel(const Comm::ConnectionPointer &conn, const char *reason);
 
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 14    IP Cache */
+
+#include "squid.h"
+#include "base/RunnersRegistry.h"
+#include "debug/Stream.h"
+#include "dns/SharedCache.h"
+#include "ipc/mem/Segment.h"
+#include "SquidConfig.h"
+#include "time/gadgets.h"
+#include "tools.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Dns
+{
+
+/// shared memory segment names
+static const char *const IpCacheName = "dns_ipcache";
+static const char *const FqdnCacheName = "dns_fqdncache";
+
+/// the shared IP cache table attached by this worker (if any)
+static SharedCache *TheIpCache = nullptr;
+/// the shared FQDN cache table attached by this worker (if any)
+static SharedCache *TheFqdnCache = nullptr;
+
+/// whether configuration calls for sharing DNS cache entries among workers
+static bool
+SharingEnabled()
+{
+    return Config.onoff.dns_cache_shared && UsingSmp();
+}
+
+/// initializes shared memory segments used by the shared DNS caches
+class SharedCacheRr: public Ipc::Mem::RegisteredRunner
+{
+public:
+    /* RegisteredRunner API */
+    ~SharedCacheRr() override;
+    void useConfig() override;
+
+protected:
+    /* Ipc::Mem::RegisteredRunner API */
+    void create() override;
+    void open() override;
+
+private:
+    SharedCache::Owner *ipCacheOwner = nullptr;
+    SharedCache::Owner *fqdnCacheOwner = nullptr;
+};
+
+} // namespace Dns
+
+DefineRunnerRegistratorIn(Dns, SharedCacheRr);
+
+/* Dns::SharedCache::Entry */
+
+bool
+Dns::SharedCache::Entry::append(const void * const bytes, const size_t byteCount)
+{
+    if (byteCount > sizeof(data) - size)
+        return false;
+    memcpy(data + size, bytes, byteCount);
+    size += byteCount;
+    return true;
+}
+
+void
+Dns::SharedCache::Entry::setError(const char * const message)
+{
+    negative = true;
+    size = 0;
+    if (!message)
+        return;
+    const auto length = std::min(strlen(message), sizeof(data) - 1);
+    memcpy(data, message, length);
+    data[length] = '\0';
+    size = length + 1;
+}
+
+/* Dns::SharedCache::Shared */
+
+Dns::SharedCache::Shared::Shared(const int aLimit):
+    limit(aLimit),
+    slots(aLimit)
+{
+}
+
+size_t
+Dns::SharedCache::Shared::sharedMemorySize() const
+{
+    return SharedMemorySize(limit);
+}
+
+size_t
+Dns::SharedCache::Shared::SharedMemorySize(const int limit)
+{
+    return sizeof(Shared) + limit * sizeof(Slot);
+}
+
+/* Dns::SharedCache */
+
+Dns::SharedCache::Owner *
+Dns::SharedCache::Init(const char * const path, const int limit)
+{
+    assert(limit > 0); // we should not be created otherwise
+    const auto owner = shm_new(Shared)(path, limit);
+    debugs(14, 5, "new table [" << path << "] created: " << limit);
+    return owner;
+}
+
+Dns::SharedCache::SharedCache(const char * const path):
+    shared(shm_old(Shared)(path))
+{
+    assert(shared->limit > 0); // we should not be created otherwise
+    debugs(14, 5, "attached table [" << path << "]: " << shared->limit);
+}
+
+Dns::SharedCache::Slot &
+Dns::SharedCache::slotFor(const char * const name) const
+{
+    // FNV-1a over the lowercase name
+    uint32_t hash = 2166136261U;
+    for (auto p = name; *p; ++p) {
+        hash ^= static_cast<unsigned char>(xtolower(*p));
+        hash *= 16777619U;
+    }
+    return shared->slots[hash % shared->limit];
+}
+
+bool
+Dns::SharedCache::get(const char * const name, Entry &entry) const
+{
+    if (strlen(name) >= sizeof(Slot::name))
+        return false;
+
+    auto &slot = slotFor(name);
+    if (!slot.lock.lockShared()) {
+        debugs(14, 5, "busy slot for " << name);
+        return false;
+    }
+
+    const auto found = strcasecmp(slot.name, name) == 0 && slot.entry.expires > squid_curtime;
+    if (found) {
+        entry.expires = slot.entry.expires;
+        entry.negative = slot.entry.negative;
+        entry.size = slot.entry.size;
+        memcpy(entry.data, slot.entry.data, slot.entry.size);
+    }
+
+    slot.lock.unlockShared();
+    debugs(14, 7, (found ? "hit" : "miss") << " for " << name);
+    return found;
+}
+
+void
+Dns::SharedCache::put(const char * const name, const Entry &entry)
+{
+    if (strlen(name) >= sizeof(Slot::name)) {
+        debugs(14, 5, "name too long to share: " << name);
+        return;
+    }
+
+    auto &slot = slotFor(name);
+    if (!slot.lock.lockExclusive()) {
+        debugs(14, 5, "busy slot for " << name);
+        return;
+    }
+
+    xstrncpy(slot.name, name, sizeof(slot.name));
+    slot.entry.expires = entry.expires;
+    slot.entry.negative = entry.negative;
+    slot.entry.size = entry.size;
+    memcpy(slot.entry.data, entry.data, entry.size);
+
+    slot.lock.unlockExclusive();
+    debugs(14, 7, "stored " << name << " expiring at " << entry.expires);
+}
+
+Dns::SharedCache *
+Dns::SharedIpCache()
+{
+    return TheIpCache;
+}
+
+Dns::SharedCache *
+Dns::SharedFqdnCache()
+{
+    return TheFqdnCache;
+}
+
+/* Dns::SharedCacheRr */
+
+void
+Dns::SharedCacheRr::useConfig()
+{
+    if (!SharingEnabled())
+        return;
+
+    Ipc::Mem::RegisteredRunner::useConfig();
+}
+
+void
+Dns::SharedCacheRr::create()
+{
+    if (Config.ipcache.size > 0)
+        ipCacheOwner = SharedCache::Init(IpCacheName, Config.ipcache.size);
+    if (Config.fqdncache.size > 0)
+        fqdnCacheOwner = SharedCache::Init(FqdnCacheName, Config.fqdncache.size);
+}
+
+void
+Dns::SharedCacheRr::open()
+{
+    if (!IamWorkerProcess())
+        return;
+
+    if (Config.ipcache.size > 0)
+        TheIpCache = new SharedCache(IpCacheName);
+    if (Config.fqdncache.size > 0)
+        TheFqdnCache = new SharedCache(FqdnCacheName);
+}
+
+Dns::SharedCacheRr::~SharedCacheRr()
+{
+    delete TheIpCache;
+    TheIpCache = nullptr;
+    delete TheFqdnCache;
+    TheFqdnCache = nullptr;
+
+    delete ipCacheOwner;
+    delete fqdnCacheOwner;
+}
+
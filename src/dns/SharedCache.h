@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_DNS_SHAREDCACHE_H
+#define SQUID_SRC_DNS_SHAREDCACHE_H
+
+#include "ipc/mem/FlexibleArray.h"
+#include "ipc/mem/Pointer.h"
+#include "ipc/ReadWriteLock.h"
+#include "rfc2181.h"
+
+namespace Dns
+{
+
+/**
+ * A fixed-size table of DNS lookup results shared by SMP workers. Allows a
+ * worker to reuse a name resolved by another worker instead of sending its
+ * own DNS query. Each name has exactly one table position, so colliding
+ * names evict each other. Names are compared case-insensitively.
+ *
+ * Operations never wait for a busy slot: A slot locked by another process
+ * is treated as a cache miss when reading and as a full cache when writing.
+ */
+class SharedCache
+{
+public:
+    /// the maximum size of serialized lookup results stored in one slot
+    static constexpr size_t MaxDataSize = 1024;
+
+    /// a serialized lookup result
+    class Entry
+    {
+    public:
+        /// appends the given bytes if they fit
+        /// \returns whether the bytes were appended
+        bool append(const void *bytes, size_t size);
+
+        /// marks the entry as negative and stores the (possibly truncated)
+        /// error message, replacing any previously appended data
+        void setError(const char *message);
+
+        /// the error message stored by setError()
+        const char *error() const { return size ? data : ""; }
+
+        time_t expires = 0; ///< when the lookup result becomes stale
+        bool negative = false; ///< whether the lookup has failed
+        size_t size = 0; ///< the number of used data bytes
+        char data[MaxDataSize]; ///< cache-specific lookup result
+    };
+
+    /// a shared table cell
+    class Slot
+    {
+    public:
+        mutable Ipc::ReadWriteLock lock; ///< protects all other members
+        char name[SQUIDHOSTNAMELEN + 1] = {}; ///< looked up name; empty for unused slots
+        Entry entry; ///< the lookup result for the name
+    };
+
+    /// shared memory segment contents
+    class Shared
+    {
+    public:
+        explicit Shared(int aLimit);
+        size_t sharedMemorySize() const;
+        static size_t SharedMemorySize(int limit);
+
+        const int limit; ///< the number of slots
+        Ipc::Mem::FlexibleArray<Slot> slots; ///< storage
+    };
+
+    using Owner = Ipc::Mem::Owner<Shared>;
+
+    /// initializes shared memory for a table with the given number of slots
+    static Owner *Init(const char *path, int limit);
+
+    /// attaches to the existing shared memory table
+    explicit SharedCache(const char *path);
+
+    /// Retrieves a fresh lookup result for the given name.
+    /// \returns whether the entry was filled
+    bool get(const char *name, Entry &) const;
+
+    /// stores the lookup result, replacing any entry at the name position
+    void put(const char *name, const Entry &);
+
+    /// the maximum number of cached entries
+    int limit() const { return shared->limit; }
+
+private:
+    Slot &slotFor(const char *name) const;
+
+    Ipc::Mem::Pointer<Shared> shared; ///< shared memory table
+};
+
+/// the shared IP cache table or nil when ipcache entries are not shared
+SharedCache *SharedIpCache();
+
+/// the shared FQDN cache table or nil when fqdncache entries are not shared
+SharedCache *SharedFqdnCache();
+
+} // namespace Dns
+
+#endif /* SQUID_SRC_DNS_SHAREDCACHE_H */
+
@@ -32,6 +32,8 @@
 #include "mgr/Registration.h"
 #include "snmp_agent.h"
 #include "SquidConfig.h"
+#include "StatCounters.h"
+#include "StatHist.h"
 #include "Store.h"
 #include "tools.h"
 #include "util.h"
@@ -44,10 +46,14 @@
 #if HAVE_ARPA_NAMESER_H
 #include <arpa/nameser.h>
 #endif
+#include <algorithm>
 #include <cerrno>
+#include <random>
 #if HAVE_RESOLV_H
 #include <resolv.h>
 #endif
+#include <unordered_map>
+#include <vector>
 
 #if _SQUID_WINDOWS_
 #define REG_TCPIP_PARA_INTERFACES "SYSTEM\\CurrentControlSet\\Services\\Tcpip\\Parameters\\Interfaces"
@@ -134,7 +140,8 @@ public:
     char name[NS_MAXDNAME + 1];
     char orig[NS_MAXDNAME + 1];
     ssize_t sz = 0;
-    unsigned short query_id = 0; ///< random query ID sent to server; changes with every query sent
+    unsigned short query_id = 0; ///< random query ID sent to server; changes with every new question but not with retransmissions
+    int udpSocket = -1; ///< the UDP socket used to send this query; replies must arrive on it
     InstanceId<idns_query> xact_id; ///< identifies our "transaction", stays constant when query is retried
 
     int nsends = 0;
@@ -189,6 +196,8 @@ CBDATA_CLASS_INIT(nsvc);
 class ns
 {
 public:
+    ns() { responseTimes.logInit(300, 0.0, 60000.0 * 10.0); }
+
     Ip::Address S;
     int nqueries = 0;
     int nreplies = 0;
@@ -197,6 +206,7 @@ public:
 #endif
     bool mDNSResolver = false;
     nsvc *vc = nullptr;
+    StatHist responseTimes; ///< milliseconds between the last query send and its reply
 };
 
 namespace Dns
@@ -227,9 +237,16 @@ static int npc = 0;
 static int npc_alloc = 0;
 static int ndots = 1;
 static dlink_list lru_list;
+/// lru_list queries indexed by their query_id
+static std::unordered_multimap<unsigned short, idns_query *> pending_queries;
 static int event_queued = 0;
 static hash_table *idns_lookup_hash = nullptr;
 
+/// UDP sockets for talking to IPv4 (A) and IPv6 (B) nameservers; the first
+/// socket in each pool is also known as DnsSocketA or DnsSocketB
+static std::vector<int> DnsSocketsA;
+static std::vector<int> DnsSocketsB;
+
 /*
  * Notes on EDNS:
  *
@@ -272,7 +289,7 @@ static IOCB idnsSentQueryVC;
 
 static int idnsFromKnownNameserver(Ip::Address const &from);
 static idns_query *idnsFindQuery(unsigned short id);
-static void idnsGrokReply(const char *buf, size_t sz, int from_ns);
+static void idnsGrokReply(const char *buf, size_t sz, int from_ns, int udpSocket);
 static PF idnsRead;
 static EVH idnsCheckQueue;
 static void idnsTickleQueue(void);
@@ -699,6 +716,14 @@ idnsParseWIN32Registry(void)
 
 #endif
 
+/// \returns the given percentile of the nameserver response times
+static double
+idnsResponseTimePctile(const ns &server, const double pctile)
+{
+    static const ns idle; // has no response times
+    return statHistDeltaPctile(idle.responseTimes, server.responseTimes, pctile);
+}
+
 static void
 idnsStats(StoreEntry * sentry)
 {
@@ -740,6 +765,21 @@ idnsStats(StoreEntry * sentry)
                           server.mDNSResolver?"multicast":"recurse");
     }
 
+    storeAppendPrintf(sentry, "\nNameserver response times (msec):\n");
+    storeAppendPrintf(sentry, "IP ADDRESS                                    MEDIAN    90%%    99%%\n");
+    storeAppendPrintf(sentry, "--------------------------------------------- ------ ------ ------\n");
+
+    for (const auto &server : nameservers) {
+        storeAppendPrintf(sentry, "%-45s %6.0f %6.0f %6.0f\n",
+                          server.S.toStr(buf,MAX_IPSTRLEN),
+                          idnsResponseTimePctile(server, 0.5),
+                          idnsResponseTimePctile(server, 0.9),
+                          idnsResponseTimePctile(server, 0.99));
+    }
+
+    storeAppendPrintf(sentry, "\nUDP sockets: %zu IPv4, %zu IPv6\n",
+                      DnsSocketsA.size(), DnsSocketsB.size());
+
     storeAppendPrintf(sentry, "\nRcode Matrix:\n");
     storeAppendPrintf(sentry, "RCODE");
 
@@ -950,6 +990,46 @@ idnsSendQueryVC(idns_query * q, size_t nsn)
     idnsDoSendQueryVC(vc);
 }
 
+/// \returns a socket from the given pool for sending the query
+static int
+idnsUdpSocket(const std::vector<int> &pool, idns_query &q)
+{
+    assert(!pool.empty());
+
+    // Retransmissions keep the socket so that a late reply to an earlier send
+    // is still accepted. New queries (and queries that switch to another
+    // address family) get a socket chosen independently of their query ID,
+    // so that spoofers have to guess both the port and the ID.
+    if (std::find(pool.begin(), pool.end(), q.udpSocket) == pool.end()) {
+        static std::mt19937 mt(RandomSeed32());
+        std::uniform_int_distribution<size_t> index(0, pool.size() - 1);
+        q.udpSocket = pool[index(mt)];
+    }
+    return q.udpSocket;
+}
+
+/// starts waiting for a reply to the sent query
+static void
+idnsQueue(idns_query *q)
+{
+    dlinkAdd(q, &q->lru, &lru_list);
+    pending_queries.emplace(q->query_id, q);
+}
+
+/// stops waiting for a reply to the query (if we were waiting)
+static void
+idnsUnqueue(idns_query *q)
+{
+    dlinkDelete(&q->lru, &lru_list);
+    const auto range = pending_queries.equal_range(q->query_id);
+    for (auto i = range.first; i != range.second; ++i) {
+        if (i->second == q) {
+            pending_queries.erase(i);
+            return;
+        }
+    }
+}
+
 static void
 idnsSendQuery(idns_query * q)
 {
@@ -975,6 +1055,7 @@ idnsSendQuery(idns_query * q)
     assert(q->lru.prev == nullptr);
 
     int x = -1, y = -1;
+    int fdA = DnsSocketA, fdB = DnsSocketB;
     size_t nsn;
     const auto nsCount = nameservers.size();
 
@@ -989,10 +1070,13 @@ idnsSendQuery(idns_query * q)
             idnsSendQueryVC(q, nsn);
             x = y = 0;
         } else {
-            if (DnsSocketB >= 0 && nameservers[nsn].S.isIPv6())
-                y = comm_udp_sendto(DnsSocketB, nameservers[nsn].S, q->buf, q->sz);
-            else if (DnsSocketA >= 0)
-                x = comm_udp_sendto(DnsSocketA, nameservers[nsn].S, q->buf, q->sz);
+            if (DnsSocketB >= 0 && nameservers[nsn].S.isIPv6()) {
+                fdB = idnsUdpSocket(DnsSocketsB, *q);
+                y = comm_udp_sendto(fdB, nameservers[nsn].S, q->buf, q->sz);
+            } else if (DnsSocketA >= 0) {
+                fdA = idnsUdpSocket(DnsSocketsA, *q);
+                x = comm_udp_sendto(fdA, nameservers[nsn].S, q->buf, q->sz);
+            }
         }
         int xerrno = errno;
 
@@ -1001,22 +1085,22 @@ idnsSendQuery(idns_query * q)
         q->sent_t = current_time;
 
         if (y < 0 && nameservers[nsn].S.isIPv6())
-            debugs(50, DBG_IMPORTANT, MYNAME << "FD " << DnsSocketB << ": sendto: " << xstrerr(xerrno));
+            debugs(50, DBG_IMPORTANT, MYNAME << "FD " << fdB << ": sendto: " << xstrerr(xerrno));
         if (x < 0 && nameservers[nsn].S.isIPv4())
-            debugs(50, DBG_IMPORTANT, MYNAME << "FD " << DnsSocketA << ": sendto: " << xstrerr(xerrno));
+            debugs(50, DBG_IMPORTANT, MYNAME << "FD " << fdA << ": sendto: " << xstrerr(xerrno));
 
     } while ( (x<0 && y<0) && q->nsends % nsCount != 0);
 
     if (y > 0) {
-        fd_bytes(DnsSocketB, y, IoDirection::Write);
+        fd_bytes(fdB, y, IoDirection::Write);
     }
     if (x > 0) {
-        fd_bytes(DnsSocketA, x, IoDirection::Write);
+        fd_bytes(fdA, x, IoDirection::Write);
     }
 
     ++ nameservers[nsn].nqueries;
     q->queue_t = current_time;
-    dlinkAdd(q, &q->lru, &lru_list);
+    idnsQueue(q);
     q->pending = 1;
     idnsTickleQueue();
 }
@@ -1040,17 +1124,8 @@ idnsFromKnownNameserver(Ip::Address const &from)
 static idns_query *
 idnsFindQuery(unsigned short id)
 {
-    dlink_node *n;
-    idns_query *q;
-
-    for (n = lru_list.tail; n; n = n->prev) {
-        q = (idns_query*)n->data;
-
-        if (q->query_id == id)
-            return q;
-    }
-
-    return nullptr;
+    const auto found = pending_queries.find(id);
+    return found == pending_queries.end() ? nullptr : found->second;
 }
 
 static unsigned short
@@ -1167,8 +1242,9 @@ idnsCallback(idns_query *q, const char *error)
     delete master;
 }
 
+/// \param udpSocket the socket that received a UDP reply or -1 for TCP replies
 static void
-idnsGrokReply(const char *buf, size_t sz, int /*from_ns*/)
+idnsGrokReply(const char *buf, size_t sz, int from_ns, const int udpSocket)
 {
     rfc1035_message *message = nullptr;
 
@@ -1195,6 +1271,12 @@ idnsGrokReply(const char *buf, size_t sz, int /*from_ns*/)
         return;
     }
 
+    if (udpSocket >= 0 && udpSocket != q->udpSocket) {
+        debugs(78, 3, "idnsGrokReply: Socket mismatch (FD " << udpSocket << " != FD " << q->udpSocket << ")");
+        rfc1035MessageDestroy(&message);
+        return;
+    }
+
 #if WHEN_EDNS_RESPONSES_ARE_PARSED
 // TODO: actually gr the message right here.
 //  pull out the DNS meta data we need (A records, AAAA records and EDNS OPT) and store in q
@@ -1219,9 +1301,12 @@ idnsGrokReply(const char *buf, size_t sz, int /*from_ns*/)
     }
 #endif
 
-    dlinkDelete(&q->lru, &lru_list);
+    idnsUnqueue(q);
     q->pending = 0;
 
+    if (from_ns >= 0)
+        nameservers[from_ns].responseTimes.count(tvSubMsec(q->sent_t, current_time));
+
     if (message->tc) {
         debugs(78, 3, "Resolver requested TC (" << q->query.name << ")");
         rfc1035MessageDestroy(&message);
@@ -1280,7 +1365,7 @@ idnsGrokReply(const char *buf, size_t sz, int /*from_ns*/)
 
             // cleanup slave AAAA query
             while (idns_query *slave = q->slave) {
-                dlinkDelete(&slave->lru, &lru_list);
+                idnsUnqueue(slave);
                 q->slave = slave->slave;
                 slave->slave = nullptr;
                 delete slave;
@@ -1316,88 +1401,152 @@ idnsGrokReply(const char *buf, size_t sz, int /*from_ns*/)
 
 }
 
+/// handles a UDP DNS reply
 static void
-idnsRead(int fd, void *)
+idnsHandleReply(const int fd, const char *buf, const size_t len, const Ip::Address &from)
 {
-    int *N = &incoming_sockets_accepted;
-    int len;
-    int max = INCOMING_DNS_MAX;
-    static char rbuf[SQUID_UDP_SO_RCVBUF];
-    Ip::Address from;
+    fd_bytes(fd, len, IoDirection::Read);
 
-    debugs(78, 3, "idnsRead: starting with FD " << fd);
+    ++incoming_sockets_accepted;
 
-    // Always keep reading. This stops (or at least makes harder) several
-    // attacks on the DNS client.
-    Comm::SetSelect(fd, COMM_SELECT_READ, idnsRead, nullptr, 0);
+    debugs(78, 3, "idnsRead: FD " << fd << ": received " << len << " bytes from " << from);
 
-    /* BUG (UNRESOLVED)
-     *  two code lines after returning from comm_udprecvfrom()
-     *  something overwrites the memory behind the from parameter.
-     *  NO matter where in the stack declaration list above it is placed
-     *  The cause of this is still unknown, however copying the data appears
-     *  to allow it to be passed further without this erasure.
-     */
-    Ip::Address bugbypass;
+    int nsn = idnsFromKnownNameserver(from);
 
-    while (max) {
-        --max;
-        len = comm_udp_recvfrom(fd, rbuf, SQUID_UDP_SO_RCVBUF, 0, bugbypass);
+    if (nsn >= 0) {
+        ++ nameservers[nsn].nreplies;
+    }
 
-        from = bugbypass; // BUG BYPASS. see notes above.
+    // Before unknown_nameservers check to avoid flooding cache.log on attacks,
+    // but after the ++ above to keep statistics right.
+    if (!lru_list.head)
+        return; // Don't process replies if there is no pending query.
 
-        if (len == 0)
-            break;
+    if (nsn < 0 && Config.onoff.ignore_unknown_nameservers) {
+        static time_t last_warning = 0;
+
+        if (squid_curtime - last_warning > 60) {
+            debugs(78, DBG_IMPORTANT, "WARNING: Reply from unknown nameserver " << from);
+            last_warning = squid_curtime;
+        } else {
+            debugs(78, DBG_IMPORTANT, "WARNING: Reply from unknown nameserver " << from << " (retrying..." <<  (squid_curtime-last_warning) << "<=60)" );
+        }
+        return;
+    }
+
+    idnsGrokReply(buf, len, nsn, fd);
+}
 
-        if (len < 0) {
-            int xerrno = errno;
-            if (ignoreErrno(xerrno))
-                break;
+/// reports a UDP socket reading error (if it is worth reporting)
+static void
+idnsReportReadError(const int fd, const int xerrno)
+{
+    if (ignoreErrno(xerrno))
+        return;
 
 #if _SQUID_LINUX_
-            /* Some Linux systems seem to set the FD for reading and then
-             * return ECONNREFUSED when sendto() fails and generates an ICMP
-             * port unreachable message. */
-            /* or maybe an EHOSTUNREACH "No route to host" message */
-            if (xerrno != ECONNREFUSED && xerrno != EHOSTUNREACH)
+    /* Some Linux systems seem to set the FD for reading and then
+     * return ECONNREFUSED when sendto() fails and generates an ICMP
+     * port unreachable message. */
+    /* or maybe an EHOSTUNREACH "No route to host" message */
+    if (xerrno != ECONNREFUSED && xerrno != EHOSTUNREACH)
 #endif
-                debugs(50, DBG_IMPORTANT, MYNAME << "FD " << fd << " recvfrom: " << xstrerr(xerrno));
+        debugs(50, DBG_IMPORTANT, MYNAME << "FD " << fd << " recvfrom: " << xstrerr(xerrno));
+}
 
-            break;
-        }
+#if HAVE_RECVMMSG
+/// the maximum number of UDP replies received by one recvmmsg(2) call
+static const int ReadBatchSize = 16;
 
-        fd_bytes(fd, len, IoDirection::Read);
+/// receives and handles up to max UDP replies using one system call
+/// \returns the number of received replies or zero when there are none
+static int
+idnsReceive(const int fd, const int max)
+{
+    static char buffers[ReadBatchSize][SQUID_UDP_SO_RCVBUF];
+    static struct sockaddr_storage addresses[ReadBatchSize];
+    static struct iovec iovs[ReadBatchSize];
+    static struct mmsghdr messages[ReadBatchSize];
+
+    const auto batchSize = std::min(max, ReadBatchSize);
+    for (int k = 0; k < batchSize; ++k) {
+        iovs[k].iov_base = buffers[k];
+        iovs[k].iov_len = sizeof(buffers[k]);
+        memset(&messages[k], 0, sizeof(messages[k]));
+        messages[k].msg_hdr.msg_name = &addresses[k];
+        messages[k].msg_hdr.msg_namelen = sizeof(addresses[k]);
+        messages[k].msg_hdr.msg_iov = &iovs[k];
+        messages[k].msg_hdr.msg_iovlen = 1;
+    }
+
+    ++ statCounter.syscalls.sock.recvfroms;
+    const auto received = recvmmsg(fd, messages, batchSize, 0, nullptr);
+    if (received < 0) {
+        idnsReportReadError(fd, errno);
+        return 0;
+    }
 
-        assert(N);
-        ++(*N);
+    debugs(78, 5, "FD " << fd << ": received " << received << " out of " << batchSize << " replies");
+    for (int k = 0; k < received; ++k) {
+        if (!messages[k].msg_len)
+            continue;
+        Ip::Address from;
+        from = addresses[k];
+        idnsHandleReply(fd, buffers[k], messages[k].msg_len, from);
+    }
 
-        debugs(78, 3, "idnsRead: FD " << fd << ": received " << len << " bytes from " << from);
+    return received;
+}
 
-        /* BUG: see above. Its here that it becomes apparent that the content of bugbypass is gone. */
-        int nsn = idnsFromKnownNameserver(from);
+#else
+/// receives and handles one UDP reply
+/// \returns the number of received replies or zero when there are none
+static int
+idnsReceive(const int fd, int)
+{
+    static char rbuf[SQUID_UDP_SO_RCVBUF];
 
-        if (nsn >= 0) {
-            ++ nameservers[nsn].nreplies;
-        }
+    /* BUG (UNRESOLVED)
+     *  two code lines after returning from comm_udprecvfrom()
+     *  something overwrites the memory behind the from parameter.
+     *  NO matter where in the stack declaration list above it is placed
+     *  The cause of this is still unknown, however copying the data appears
+     *  to allow it to be passed further without this erasure.
+     */
+    Ip::Address bugbypass;
 
-        // Before unknown_nameservers check to avoid flooding cache.log on attacks,
-        // but after the ++ above to keep statistics right.
-        if (!lru_list.head)
-            continue; // Don't process replies if there is no pending query.
+    const auto len = comm_udp_recvfrom(fd, rbuf, SQUID_UDP_SO_RCVBUF, 0, bugbypass);
 
-        if (nsn < 0 && Config.onoff.ignore_unknown_nameservers) {
-            static time_t last_warning = 0;
+    if (len == 0)
+        return 0;
 
-            if (squid_curtime - last_warning > 60) {
-                debugs(78, DBG_IMPORTANT, "WARNING: Reply from unknown nameserver " << from);
-                last_warning = squid_curtime;
-            } else {
-                debugs(78, DBG_IMPORTANT, "WARNING: Reply from unknown nameserver " << from << " (retrying..." <<  (squid_curtime-last_warning) << "<=60)" );
-            }
-            continue;
-        }
+    if (len < 0) {
+        idnsReportReadError(fd, errno);
+        return 0;
+    }
+
+    const auto from = bugbypass; // BUG BYPASS. see notes above.
+    idnsHandleReply(fd, rbuf, len, from);
+    return 1;
+}
+#endif /* HAVE_RECVMMSG */
+
+static void
+idnsRead(int fd, void *)
+{
+    int max = INCOMING_DNS_MAX;
 
-        idnsGrokReply(rbuf, len, nsn);
+    debugs(78, 3, "idnsRead: starting with FD " << fd);
+
+    // Always keep reading. This stops (or at least makes harder) several
+    // attacks on the DNS client.
+    Comm::SetSelect(fd, COMM_SELECT_READ, idnsRead, nullptr, 0);
+
+    while (max > 0) {
+        const auto received = idnsReceive(fd, max);
+        if (!received)
+            break;
+        max -= received;
     }
 }
 
@@ -1434,7 +1583,7 @@ idnsCheckQueue(void *)
         debugs(78, 3, "idnsCheckQueue: ID " << q->xact_id <<
                " QID 0x" << asHex(q->query_id).minDigits(4) << ": timeout");
 
-        dlinkDelete(&q->lru, &lru_list);
+        idnsUnqueue(q);
         q->pending = 0;
 
         if ((time_msec_t)tvSubMsec(q->start_t, current_time) < Config.Timeout.idns_query) {
@@ -1481,7 +1630,7 @@ idnsReadVC(const Comm::ConnectionPointer &conn, char *buf, size_t len, Comm::Fla
     assert(vc->ns < nameservers.size());
     debugs(78, 3, conn << ": received " << vc->msg->contentSize() << " bytes via TCP from " << nameservers[vc->ns].S << ".");
 
-    idnsGrokReply(vc->msg->buf, vc->msg->contentSize(), vc->ns);
+    idnsGrokReply(vc->msg->buf, vc->msg->contentSize(), vc->ns, -1);
     vc->msg->clean();
     AsyncCall::Pointer call = commCbCall(5,4, "idnsReadVCHeader",
                                          CommIoCbPtrFun(idnsReadVCHeader, vc));
@@ -1545,6 +1694,31 @@ idnsRcodeCount(int rcode, int attempt)
             ++ RcodeMatrix[rcode][attempt];
 }
 
+/// opens dns_udp_sockets UDP sockets bound to the given address
+static void
+idnsOpenUdpSockets(std::vector<int> &pool, const Ip::Address &addr, const char *note)
+{
+    assert(pool.empty());
+    const auto count = std::max(Config.dns.udp_sockets, 1);
+    for (int i = 0; i < count; ++i) {
+        auto localAddr = addr; // each socket gets its own port
+        const auto fd = comm_open_listener(SOCK_DGRAM,
+                                           IPPROTO_UDP,
+                                           localAddr,
+                                           COMM_NONBLOCKING,
+                                           note);
+        if (fd < 0)
+            break; // use the sockets we have (if any)
+
+        if (i > 0) {
+            comm_local_port(fd);
+            debugs(78, 2, note << " #" << (i+1) << " created at " << addr << ", FD " << fd);
+        }
+        Comm::SetSelect(fd, COMM_SELECT_READ, idnsRead, nullptr, 0);
+        pool.push_back(fd);
+    }
+}
+
 void
 Dns::Init(void)
 {
@@ -1563,20 +1737,16 @@ Dns::Init(void)
 
         if (Ip::EnableIpv6 && addrV6.isIPv6()) {
             debugs(78, 2, "idnsInit: attempt open DNS socket to: " << addrV6);
-            DnsSocketB = comm_open_listener(SOCK_DGRAM,
-                                            IPPROTO_UDP,
-                                            addrV6,
-                                            COMM_NONBLOCKING,
-                                            "DNS Socket IPv6");
+            idnsOpenUdpSockets(DnsSocketsB, addrV6, "DNS Socket IPv6");
+            if (!DnsSocketsB.empty())
+                DnsSocketB = DnsSocketsB.front();
         }
 
         if (addrV4.isIPv4()) {
             debugs(78, 2, "idnsInit: attempt open DNS socket to: " << addrV4);
-            DnsSocketA = comm_open_listener(SOCK_DGRAM,
-                                            IPPROTO_UDP,
-                                            addrV4,
-                                            COMM_NONBLOCKING,
-                                            "DNS Socket IPv4");
+            idnsOpenUdpSockets(DnsSocketsA, addrV4, "DNS Socket IPv4");
+            if (!DnsSocketsA.empty())
+                DnsSocketA = DnsSocketsA.front();
         }
 
         if (DnsSocketA < 0 && DnsSocketB < 0)
@@ -1588,12 +1758,10 @@ Dns::Init(void)
         if (DnsSocketB >= 0) {
             comm_local_port(DnsSocketB);
             debugs(78, Important(16), "DNS IPv6 socket created at " << addrV6 << ", FD " << DnsSocketB);
-            Comm::SetSelect(DnsSocketB, COMM_SELECT_READ, idnsRead, nullptr, 0);
         }
         if (DnsSocketA >= 0) {
             comm_local_port(DnsSocketA);
             debugs(78, Important(64), "DNS IPv4 socket created at " << addrV4 << ", FD " << DnsSocketA);
-            Comm::SetSelect(DnsSocketA, COMM_SELECT_READ, idnsRead, nullptr, 0);
         }
     }
 
@@ -1647,15 +1815,15 @@ idnsShutdownAndFreeState(const char *reason)
 
     debugs(78, 2, reason << ": Closing DNS sockets");
 
-    if (DnsSocketA >= 0 ) {
-        comm_close(DnsSocketA);
-        DnsSocketA = -1;
-    }
+    for (const auto fd : DnsSocketsA)
+        comm_close(fd);
+    DnsSocketsA.clear();
+    DnsSocketA = -1;
 
-    if (DnsSocketB >= 0 ) {
-        comm_close(DnsSocketB);
-        DnsSocketB = -1;
-    }
+    for (const auto fd : DnsSocketsB)
+        comm_close(fd);
+    DnsSocketsB.clear();
+    DnsSocketB = -1;
 
     for (const auto &server : nameservers) {
         if (const auto vc = server.vc) {
@@ -15,6 +15,7 @@
 #include "Store.h"
 #include "tools.h"
 
+#include <algorithm>
 #include <cmath>
 
 /* The list of event processes */
@@ -92,8 +93,7 @@ ev_entry::ev_entry(char const * aName, EVH * aFunction, void * aArgument, double
     arg(haveArg ? cbdataReference(aArgument) : aArgument),
     when(evWhen),
     weight(aWeight),
-    cbdata(haveArg),
-    next(nullptr)
+    cbdata(haveArg)
 {
 }
 
@@ -149,7 +149,7 @@ eventFind(EVH * func, void *arg)
 
 EventScheduler EventScheduler::_instance;
 
-EventScheduler::EventScheduler(): tasks(nullptr)
+EventScheduler::EventScheduler()
 {}
 
 EventScheduler::~EventScheduler()
@@ -157,40 +157,143 @@ EventScheduler::~EventScheduler()
     clean();
 }
 
+/// whether event a must fire before event b
+bool
+EventScheduler::Earlier(const ev_entry *a, const ev_entry *b)
+{
+    if (a->when != b->when)
+        return a->when < b->when;
+    return a->sequence < b->sequence; // preserve submission order
+}
+
+/// stores the event at the given heap position
 void
-EventScheduler::cancel(EVH * func, void *arg)
+EventScheduler::place(ev_entry *event, const size_t position)
 {
-    ev_entry **E;
-    ev_entry *event;
+    tasks[position] = event;
+    event->heapPosition = position;
+}
 
-    for (E = &tasks; (event = *E) != nullptr; E = &(*E)->next) {
-        if (event->func != func)
-            continue;
+void
+EventScheduler::siftUp(size_t position)
+{
+    const auto event = tasks[position];
+    while (position > 0) {
+        const auto parent = (position - 1) / 2;
+        if (!Earlier(event, tasks[parent]))
+            break;
+        place(tasks[parent], position);
+        position = parent;
+    }
+    place(event, position);
+}
 
-        if (arg && event->arg != arg)
-            continue;
+void
+EventScheduler::siftDown(size_t position)
+{
+    const auto event = tasks[position];
+    const auto count = tasks.size();
+    while (true) {
+        auto child = 2*position + 1;
+        if (child >= count)
+            break;
+        if (child + 1 < count && Earlier(tasks[child + 1], tasks[child]))
+            ++child;
+        if (!Earlier(tasks[child], event))
+            break;
+        place(tasks[child], position);
+        position = child;
+    }
+    place(event, position);
+}
 
-        *E = event->next;
+/// adds a new event to the heap and the index
+void
+EventScheduler::push(ev_entry *event)
+{
+    event->sequence = nextSequence++;
+    tasks.push_back(event);
+    siftUp(tasks.size() - 1);
+    index.emplace(EventKey(event->func, event->arg), event);
+}
 
-        delete event;
+/// removes the event from the index (but not from the heap)
+void
+EventScheduler::unindex(ev_entry *event)
+{
+    const auto range = index.equal_range(EventKey(event->func, event->arg));
+    for (auto i = range.first; i != range.second; ++i) {
+        if (i->second == event) {
+            index.erase(i);
+            return;
+        }
+    }
+    assert(false); // every scheduled event is indexed
+}
+
+/// removes the event from the heap and the index without destroying it
+void
+EventScheduler::remove(ev_entry *event)
+{
+    unindex(event);
+
+    const auto position = event->heapPosition;
+    assert(position < tasks.size() && tasks[position] == event);
+    const auto last = tasks.back();
+    tasks.pop_back();
+    if (last == event)
+        return;
+
+    place(last, position);
+    if (position > 0 && Earlier(last, tasks[(position - 1) / 2]))
+        siftUp(position);
+    else
+        siftDown(position);
+}
 
-        if (arg)
+void
+EventScheduler::cancel(EVH * func, void *arg)
+{
+    if (arg) {
+        // cancel the matching event that would have fired first
+        ev_entry *victim = nullptr;
+        const auto range = index.equal_range(EventKey(func, arg));
+        for (auto i = range.first; i != range.second; ++i) {
+            if (!victim || Earlier(i->second, victim))
+                victim = i->second;
+        }
+
+        if (!victim) {
+            debug_trap("eventDelete: event not found");
             return;
-        /*
-         * DPW 2007-04-12
-         * Since this method may now delete multiple events (when
-         * arg is NULL) it no longer returns after a deletion and
-         * we have a potential NULL pointer problem.  If we just
-         * deleted the last event in the list then *E is now equal
-         * to NULL.  We need to break here or else we'll get a NULL
-         * pointer dereference in the last clause of the for loop.
-         */
-        if (nullptr == *E)
-            break;
+        }
+
+        remove(victim);
+        delete victim;
+        return;
+    }
+
+    // cancel all events with the given func, regardless of their arg
+    std::vector<ev_entry *> survivors;
+    survivors.reserve(tasks.size());
+    for (const auto event: tasks) {
+        if (event->func == func) {
+            unindex(event);
+            delete event;
+        } else {
+            survivors.push_back(event);
+        }
     }
 
-    if (arg)
-        debug_trap("eventDelete: event not found");
+    if (survivors.size() == tasks.size())
+        return;
+
+    tasks.swap(survivors);
+    std::make_heap(tasks.begin(), tasks.end(), [](const ev_entry *a, const ev_entry *b) {
+        return Earlier(b, a);
+    });
+    for (size_t position = 0; position < tasks.size(); ++position)
+        tasks[position]->heapPosition = position;
 }
 
 // The event API does not guarantee exact timing, but guarantees that no event
@@ -198,13 +301,14 @@ EventScheduler::cancel(EVH * func, void *arg)
 int
 EventScheduler::timeRemaining() const
 {
-    if (!tasks)
+    if (tasks.empty())
         return EVENT_IDLE;
 
-    if (tasks->when <= current_dtime) // we are on time or late
+    const auto next = tasks.front();
+    if (next->when <= current_dtime) // we are on time or late
         return 0; // fire the event ASAP
 
-    const double diff = tasks->when - current_dtime; // seconds
+    const double diff = next->when - current_dtime; // seconds
     // Round UP: If we come back a nanosecond earlier, we will wait again!
     const int timeLeft = static_cast<int>(ceil(1000*diff)); // milliseconds
     // Avoid hot idle: A series of rapid select() calls with zero timeout.
@@ -220,8 +324,8 @@ EventScheduler::checkEvents(int)
         return result;
 
     do {
-        ev_entry *event = tasks;
-        assert(event);
+        assert(!tasks.empty());
+        ev_entry *event = tasks.front();
 
         /* XXX assumes event->name is static memory! */
         AsyncCall::Pointer call = asyncCall(41,5, event->name,
@@ -232,7 +336,7 @@ EventScheduler::checkEvents(int)
         const bool heavy = event->weight &&
                            (!event->cbdata || cbdataReferenceValid(event->arg));
 
-        tasks = event->next;
+        remove(event);
         delete event;
 
         result = timeRemaining();
@@ -249,12 +353,11 @@ EventScheduler::checkEvents(int)
 void
 EventScheduler::clean()
 {
-    while (ev_entry * event = tasks) {
-        tasks = event->next;
+    for (const auto event: tasks)
         delete event;
-    }
 
-    tasks = nullptr;
+    tasks.clear();
+    index.clear();
 }
 
 void
@@ -269,7 +372,11 @@ EventScheduler::dump(Packable *out)
                  "Weight",
                  "Callback Valid?");
 
-    for (auto *e = tasks; e; e = e->next) {
+    // the heap is only partially ordered; report events in their firing order
+    auto sorted = tasks;
+    std::sort(sorted.begin(), sorted.end(), Earlier);
+
+    for (const auto e: sorted) {
         out->appendf("%-25s\t%0.3f sec\t%5d\t %s\n",
                      e->name, (e->when ? e->when - current_dtime : 0), e->weight,
                      (e->arg && e->cbdata) ? cbdataReferenceValid(e->arg) ? "yes" : "no" : "N/A");
@@ -279,15 +386,7 @@ EventScheduler::dump(Packable *out)
 bool
 EventScheduler::find(EVH * func, void * arg)
 {
-
-    ev_entry *event;
-
-    for (event = tasks; event != nullptr; event = event->next) {
-        if (event->func == func && event->arg == arg)
-            return true;
-    }
-
-    return false;
+    return index.find(EventKey(func, arg)) != index.end();
 }
 
 EventScheduler *
@@ -305,16 +404,7 @@ EventScheduler::schedule(const char *name, EVH * func, void *arg, double when, i
     const double timestamp = when > 0.0 ? current_dtime + when : 0;
     ev_entry *event = new ev_entry(name, func, arg, timestamp, weight, cbdata);
 
-    ev_entry **E;
     debugs(41, 7, "schedule: Adding '" << name << "', in " << when << " seconds");
-    /* Insert after the last event with the same or earlier time */
-
-    for (E = &tasks; *E; E = &(*E)->next) {
-        if ((*E)->when > event->when)
-            break;
-    }
-
-    event->next = *E;
-    *E = event;
+    push(event);
 }
 
@@ -13,6 +13,10 @@
 #include "base/Packable.h"
 #include "mem/forward.h"
 
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 /* event scheduling facilities - run a callback after a given time period. */
 
 typedef void EVH(void *);
@@ -38,7 +42,10 @@ public:
     int weight;
     bool cbdata;
 
-    ev_entry *next;
+    /// submission order; breaks ties among events with the same when value
+    uint64_t sequence = 0;
+    /// our current position in the EventScheduler heap
+    size_t heapPosition = 0;
 };
 
 // manages time-based events
@@ -63,9 +70,44 @@ public:
     int checkEvents(int timeout) override;
     static EventScheduler *GetInstance();
 
+    /// the number of scheduled but not yet dispatched events
+    size_t size() const { return tasks.size(); }
+
 private:
+    /// (func, arg) pair used as an index key
+    using EventKey = std::pair<EVH *, void *>;
+
+    /// hashes EventKey
+    class EventKeyHash
+    {
+    public:
+        size_t operator()(const EventKey &key) const {
+            return std::hash<void *>()(reinterpret_cast<void *>(key.first)) ^
+                   (std::hash<void *>()(key.second) << 1);
+        }
+    };
+
+    using Index = std::unordered_multimap<EventKey, ev_entry *, EventKeyHash>;
+
+    static bool Earlier(const ev_entry *, const ev_entry *);
+
+    void push(ev_entry *);
+    void remove(ev_entry *);
+    void unindex(ev_entry *);
+    void place(ev_entry *, size_t position);
+    void siftUp(size_t position);
+    void siftDown(size_t position);
+
     static EventScheduler _instance;
-    ev_entry * tasks;
+
+    /// pending events, stored as a binary min-heap ordered by Earlier()
+    std::vector<ev_entry *> tasks;
+
+    /// pending events, indexed by (func, arg) so that cancel() and find() avoid heap scans
+    Index index;
+
+    /// the sequence number of the next scheduled event
+    uint64_t nextSequence = 0;
 };
 
 #endif /* SQUID_SRC_EVENT_H */
@@ -29,6 +29,26 @@ fde::setIo(READ_HANDLER *reader, WRITE_HANDLER *writer)
     writeMethod_ = writer;
 }
 
+bool
+fde::readsDirectly() const
+{
+#if _SQUID_WINDOWS_
+    return false;
+#else
+    return readMethod_ == &default_read_method && !flags.read_pending;
+#endif
+}
+
+bool
+fde::writesDirectly() const
+{
+#if _SQUID_WINDOWS_
+    return false;
+#else
+    return writeMethod_ == &default_write_method;
+#endif
+}
+
 void
 fde::useDefaultIo()
 {
@@ -87,6 +87,14 @@ public:
     int read(int fd, char *buf, int len) { return readMethod_(fd, buf, len); }
     int write(int fd, const char *buf, int len) { return writeMethod_(fd, buf, len); }
 
+    /// whether read() returns bytes received by the descriptor as is (e.g.,
+    /// without TLS decryption or internal buffering)
+    bool readsDirectly() const;
+
+    /// whether write() sends bytes to the descriptor as is (e.g., without
+    /// TLS encryption), allowing direct scatter-gather writev(2) calls
+    bool writesDirectly() const;
+
     /* NOTE: memset is used on fdes today. 20030715 RBC */
     static void DumpStats(StoreEntry *);
 
@@ -129,6 +137,8 @@ public:
         bool transparent = false;
         /// whether comm_reset_close() (or old_comm_reset_close()) has been called
         bool harshClosureRequested = false;
+        /// a listening socket that other SMP workers are also accepting from
+        bool sharedListener = false;
     } flags;
 
     int64_t bytes_read = 0;
@@ -13,6 +13,7 @@
 #include "dns/forward.h"
 #include "dns/LookupDetails.h"
 #include "dns/rfc1035.h"
+#include "dns/SharedCache.h"
 #include "event.h"
 #include "fqdncache.h"
 #include "helper.h"
@@ -114,6 +115,7 @@ static struct _fqdn_cache_stats {
     int hits;
     int misses;
     int negative_hits;
+    int shared_hits;
 } FqdncacheStats;
 
 /// \ingroup FQDNCacheInternal
@@ -381,6 +383,65 @@ fqdncacheParse(fqdncache_entry *f, const rfc1035_rr * answers, int nr, const cha
     return f->name_count;
 }
 
+/// \ingroup FQDNCacheInternal
+/// makes a fresh DNS lookup result available to other SMP workers
+static void
+fqdncacheShare(const fqdncache_entry &f)
+{
+    const auto cache = Dns::SharedFqdnCache();
+    if (!cache)
+        return;
+
+    Dns::SharedCache::Entry entry;
+    entry.expires = f.expires;
+    if (f.flags.negcached) {
+        entry.setError(f.error_message);
+    } else {
+        for (int k = 0; k < f.name_count; ++k) {
+            if (!entry.append(f.names[k], strlen(f.names[k]) + 1)) {
+                debugs(35, 5, "too many names to share: " << hashKeyStr(&f.hash));
+                return;
+            }
+        }
+    }
+    cache->put(hashKeyStr(&f.hash), entry);
+}
+
+/// \ingroup FQDNCacheInternal
+/// \returns a new cached entry for a fresh lookup result shared by another
+/// SMP worker or nil if there is no such result
+static fqdncache_entry *
+fqdncacheGetShared(const char *name)
+{
+    const auto cache = Dns::SharedFqdnCache();
+    if (!cache)
+        return nullptr;
+
+    Dns::SharedCache::Entry entry;
+    if (!cache->get(name, entry))
+        return nullptr;
+
+    const auto f = new fqdncache_entry(name);
+    f->expires = entry.expires;
+    if (entry.negative) {
+        f->flags.negcached = true;
+        f->error_message = xstrdup(entry.error());
+    } else {
+        for (size_t offset = 0; offset < entry.size && f->name_count < FQDN_MAX_NAMES;) {
+            const auto sharedName = entry.data + offset;
+            const auto length = strnlen(sharedName, entry.size - offset);
+            f->names[f->name_count] = xstrndup(sharedName, length + 1);
+            ++ f->name_count;
+            offset += length + 1;
+        }
+    }
+
+    debugs(35, 4, "shared " << name << " with " << int(f->name_count) << " names");
+    ++ FqdncacheStats.shared_hits;
+    fqdncacheAddEntry(f);
+    return f;
+}
+
 /**
  \ingroup FQDNCacheAPI
  *
@@ -397,6 +458,7 @@ fqdncacheHandleReply(void *data, const rfc1035_rr * answers, int na, const char
     statCounter.dns.svcTime.count(age);
     fqdncacheParse(f, answers, na, error_message);
     fqdncacheAddEntry(f);
+    fqdncacheShare(*f);
     fqdncacheCallback(f, age);
 }
 
@@ -432,12 +494,14 @@ fqdncache_nbgethostbyaddr(const Ip::Address &addr, FQDNH * handler, void *handle
 
     if (nullptr == f) {
         /* miss */
-        (void) 0;
+        f = fqdncacheGetShared(name);
     } else if (fqdncacheExpiredEntry(f)) {
         /* hit, but expired -- bummer */
         fqdncacheRelease(f);
-        f = nullptr;
-    } else {
+        f = fqdncacheGetShared(name);
+    }
+
+    if (f) {
         /* hit */
         debugs(35, 4, "fqdncache_nbgethostbyaddr: HIT for '" << name << "'");
 
@@ -493,10 +557,14 @@ fqdncache_gethostbyaddr(const Ip::Address &addr, int flags)
     f = fqdncache_get(name);
 
     if (nullptr == f) {
-        (void) 0;
+        f = fqdncacheGetShared(name);
     } else if (fqdncacheExpiredEntry(f)) {
         fqdncacheRelease(f);
-        f = nullptr;
+        f = fqdncacheGetShared(name);
+    }
+
+    if (nullptr == f) {
+        (void) 0;
     } else if (f->flags.negcached) {
         debugs(35, 5, "negative HIT: " << addr);
         ++ FqdncacheStats.negative_hits;
@@ -556,6 +624,14 @@ fqdnStats(StoreEntry * sentry)
     storeAppendPrintf(sentry, "FQDNcache Misses: %d\n",
                       FqdncacheStats.misses);
 
+    if (const auto cache = Dns::SharedFqdnCache()) {
+        storeAppendPrintf(sentry, "FQDNcache Shared Hits: %d\n",
+                          FqdncacheStats.shared_hits);
+
+        storeAppendPrintf(sentry, "FQDNcache Shared Entries Limit: %d\n",
+                          cache->limit());
+    }
+
     storeAppendPrintf(sentry, "FQDN Cache Contents:\n\n");
 
     storeAppendPrintf(sentry, "%-45.45s %3s %3s %3s %s\n",
@@ -0,0 +1,579 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 47    Store Directory Routines */
+
+#include "squid.h"
+#include "base/TextException.h"
+#include "compat/unistd.h"
+#include "debug/Stream.h"
+#include "fs/rock/RockIndexCheckpoint.h"
+#include "fs/rock/RockSwapDir.h"
+#include "fs_io.h"
+#include "globals.h"
+#include "ipc/mem/Page.h"
+#include "md5.h"
+#include "sbuf/Stream.h"
+#include "time/gadgets.h"
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#if HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+namespace Rock
+{
+
+/// identifies index checkpoint files (and their format version)
+static const char CheckpointMagic[] = "rock index v2";
+
+/// the beginning of an index checkpoint file: describes the indexed db
+class CheckpointHeader
+{
+public:
+    char magic[16]; ///< CheckpointMagic, padded with zeros
+    uint64_t slotSize; ///< SwapDir::slotSize
+    int64_t slotLimit; ///< SwapDir::slotLimitActual()
+    int64_t entryLimit; ///< SwapDir::entryLimitActual()
+    uint64_t dbInode; ///< db file serial number
+    int64_t dbSize; ///< db file size in bytes
+    int64_t dbModified; ///< db file modification time in nanoseconds
+};
+
+/// An index checkpoint file record describing a stored entry. Followed by
+/// sliceCount CheckpointSlice records. The last record has no slices.
+class CheckpointEntry
+{
+public:
+    uint64_t key[2]; ///< StoreMapAnchor::key
+    int64_t timestamp; ///< StoreMapAnchor::Basics::timestamp
+    int64_t lastref; ///< StoreMapAnchor::Basics::lastref
+    int64_t expires; ///< StoreMapAnchor::Basics::expires
+    int64_t lastmod; ///< StoreMapAnchor::Basics::lastmod
+    uint64_t swapFileSize; ///< StoreMapAnchor::Basics::swap_file_sz
+    uint16_t refcount; ///< StoreMapAnchor::Basics::refcount
+    uint16_t flags; ///< StoreMapAnchor::Basics::flags
+    int32_t splicingPoint; ///< StoreMapAnchor::splicingPoint
+    uint32_t sliceCount; ///< the number of slices in the entry chain
+    uint32_t reserved; ///< explicit padding; always zero
+};
+
+/// an index checkpoint file record describing one slice of an entry chain
+class CheckpointSlice
+{
+public:
+    int32_t id; ///< slot ID
+    uint32_t size; ///< StoreMapSlice::size
+};
+
+/// buffered index checkpoint output that also checksums all written bytes
+class CheckpointWriter
+{
+public:
+    explicit CheckpointWriter(const SBuf &aPath);
+    ~CheckpointWriter();
+
+    /// adds the given bytes to the checkpoint
+    void write(const void *data, size_t size);
+
+    /// appends the checksum and makes sure the checkpoint reaches the disk
+    void finish();
+
+private:
+    void flush();
+
+    SBuf path; ///< checkpoint file location
+    int fd; ///< checkpoint file descriptor
+    std::vector<char> buf; ///< bytes waiting to be written
+    SquidMD5_CTX md5; ///< checksum of all written bytes
+};
+
+/// buffered index checkpoint input that also checksums all read bytes
+class CheckpointReader
+{
+public:
+    explicit CheckpointReader(int aFd);
+    ~CheckpointReader();
+
+    /// fills the given buffer or throws
+    void read(void *data, size_t size);
+
+    /// checks the checksum and that nothing follows it; throws on errors
+    void finish();
+
+    /// starts reading from the beginning of the checkpoint again
+    void rewind();
+
+private:
+    size_t fill(char *data, size_t size);
+    void readRaw(void *data, size_t size);
+
+    int fd; ///< checkpoint file descriptor
+    std::vector<char> buf; ///< read but not yet consumed bytes
+    size_t bufPos = 0; ///< the first unconsumed buf byte
+    SquidMD5_CTX md5; ///< checksum of all consumed bytes
+};
+
+/// how much checkpoint I/O we buffer
+static const size_t CheckpointBufferSize = 1024*1024;
+
+} // namespace Rock
+
+/* Rock::CheckpointWriter */
+
+Rock::CheckpointWriter::CheckpointWriter(const SBuf &aPath):
+    path(aPath)
+{
+    fd = xopen(path.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_BINARY, 0600);
+    if (fd < 0)
+        throw TextException(ToSBuf("cannot create ", path, ": ", xstrerr(errno)), Here());
+    buf.reserve(CheckpointBufferSize);
+    SquidMD5Init(&md5);
+}
+
+Rock::CheckpointWriter::~CheckpointWriter()
+{
+    if (fd >= 0)
+        xclose(fd);
+}
+
+void
+Rock::CheckpointWriter::write(const void *data, const size_t size)
+{
+    SquidMD5Update(&md5, data, size);
+    const auto bytes = static_cast<const char *>(data);
+    if (buf.size() + size > CheckpointBufferSize)
+        flush();
+    buf.insert(buf.end(), bytes, bytes + size);
+}
+
+void
+Rock::CheckpointWriter::flush()
+{
+    size_t written = 0;
+    while (written < buf.size()) {
+        const auto result = xwrite(fd, buf.data() + written, buf.size() - written);
+        if (result < 0) {
+            const auto xerrno = errno;
+            if (xerrno == EINTR)
+                continue;
+            throw TextException(ToSBuf("cannot write ", path, ": ", xstrerr(xerrno)), Here());
+        }
+        written += result;
+    }
+    buf.clear();
+}
+
+void
+Rock::CheckpointWriter::finish()
+{
+    uint8_t digest[SQUID_MD5_DIGEST_LENGTH];
+    SquidMD5Final(digest, &md5);
+    buf.insert(buf.end(), digest, digest + sizeof(digest));
+    flush();
+
+    if (fsync(fd) != 0)
+        throw TextException(ToSBuf("cannot sync ", path, ": ", xstrerr(errno)), Here());
+    const auto closedFd = fd;
+    fd = -1;
+    if (xclose(closedFd) != 0)
+        throw TextException(ToSBuf("cannot close ", path, ": ", xstrerr(errno)), Here());
+}
+
+/* Rock::CheckpointReader */
+
+Rock::CheckpointReader::CheckpointReader(const int aFd):
+    fd(aFd)
+{
+    SquidMD5Init(&md5);
+}
+
+Rock::CheckpointReader::~CheckpointReader()
+{
+    xclose(fd);
+}
+
+/// copies up to size unconsumed bytes into data, reading more when necessary
+/// \returns the number of copied bytes; zero at the end of the file
+size_t
+Rock::CheckpointReader::fill(char * const data, const size_t size)
+{
+    if (bufPos >= buf.size()) {
+        buf.resize(CheckpointBufferSize);
+        bufPos = 0;
+        int result;
+        do {
+            result = xread(fd, buf.data(), buf.size());
+        } while (result < 0 && errno == EINTR);
+        if (result < 0) {
+            const auto xerrno = errno;
+            buf.clear();
+            throw TextException(ToSBuf("read error: ", xstrerr(xerrno)), Here());
+        }
+        buf.resize(result);
+    }
+
+    const auto copied = std::min(size, buf.size() - bufPos);
+    memcpy(data, buf.data() + bufPos, copied);
+    bufPos += copied;
+    return copied;
+}
+
+/// read() without checksumming
+void
+Rock::CheckpointReader::readRaw(void * const data, const size_t size)
+{
+    const auto bytes = static_cast<char *>(data);
+    size_t copied = 0;
+    while (copied < size) {
+        const auto result = fill(bytes + copied, size - copied);
+        if (!result)
+            throw TextException("truncated checkpoint", Here());
+        copied += result;
+    }
+}
+
+void
+Rock::CheckpointReader::read(void * const data, const size_t size)
+{
+    readRaw(data, size);
+    SquidMD5Update(&md5, data, size);
+}
+
+void
+Rock::CheckpointReader::finish()
+{
+    uint8_t expectedDigest[SQUID_MD5_DIGEST_LENGTH];
+    SquidMD5Final(expectedDigest, &md5);
+
+    uint8_t storedDigest[SQUID_MD5_DIGEST_LENGTH];
+    readRaw(storedDigest, sizeof(storedDigest));
+    if (memcmp(expectedDigest, storedDigest, sizeof(storedDigest)) != 0)
+        throw TextException("checksum mismatch", Here());
+
+    char extra;
+    if (fill(&extra, sizeof(extra)))
+        throw TextException("unexpected data after the checksum", Here());
+}
+
+void
+Rock::CheckpointReader::rewind()
+{
+    if (lseek(fd, 0, SEEK_SET) < 0)
+        throw TextException(ToSBuf("cannot seek: ", xstrerr(errno)), Here());
+    buf.clear();
+    bufPos = 0;
+    SquidMD5Init(&md5);
+}
+
+/* Rock::IndexCheckpoint */
+
+/// describes the current state of the given cache_dir db file
+static Rock::CheckpointHeader
+DescribeDb(const Rock::SwapDir &dir, const char * const dbPath)
+{
+    struct stat sb;
+    if (stat(dbPath, &sb) != 0)
+        throw TextException(ToSBuf("cannot stat ", dbPath, ": ", xstrerr(errno)), Here());
+
+    Rock::CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    static_assert(sizeof(Rock::CheckpointMagic) <= sizeof(header.magic), "CheckpointMagic fits");
+    memcpy(header.magic, Rock::CheckpointMagic, sizeof(Rock::CheckpointMagic));
+    header.slotSize = dir.slotSize;
+    header.slotLimit = dir.slotLimitActual();
+    header.entryLimit = dir.entryLimitActual();
+    header.dbInode = sb.st_ino;
+    header.dbSize = sb.st_size;
+#if HAVE_STRUCT_STAT_ST_MTIM
+    header.dbModified = static_cast<int64_t>(sb.st_mtim.tv_sec)*1000000000 + sb.st_mtim.tv_nsec;
+#else
+    header.dbModified = static_cast<int64_t>(sb.st_mtime)*1000000000;
+#endif
+    return header;
+}
+
+/// flushes OS buffers of the given db file so that a checkpoint does not
+/// describe slots that may be lost if the system crashes
+static void
+SyncDb(const char * const dbPath)
+{
+    const auto fd = xopen(dbPath, O_RDONLY|O_BINARY);
+    if (fd < 0)
+        throw TextException(ToSBuf("cannot open ", dbPath, ": ", xstrerr(errno)), Here());
+    const auto synced = fsync(fd) == 0;
+    const auto xerrno = errno;
+    xclose(fd);
+    if (!synced)
+        throw TextException(ToSBuf("cannot sync ", dbPath, ": ", xstrerr(xerrno)), Here());
+}
+
+/// Describes a read-locked entry and its slice chain. Ignores entries that
+/// are not fully stored; they would not survive a db scan either.
+/// \returns whether the entry should be saved
+static bool
+DescribeEntry(const Ipc::StoreMap &map, const sfileno fileno, const Ipc::StoreMapAnchor &anchor, Rock::CheckpointEntry &record, std::vector<Rock::CheckpointSlice> &chain)
+{
+    memset(&record, 0, sizeof(record));
+    record.key[0] = anchor.key[0];
+    record.key[1] = anchor.key[1];
+    record.timestamp = anchor.basics.timestamp;
+    record.lastref = anchor.basics.lastref;
+    record.expires = anchor.basics.expires;
+    record.lastmod = anchor.basics.lastmod;
+    record.swapFileSize = anchor.basics.swap_file_sz;
+    record.refcount = anchor.basics.refcount;
+    record.flags = anchor.basics.flags;
+    record.splicingPoint = anchor.splicingPoint;
+
+    chain.clear();
+    uint64_t chainSize = 0;
+    for (auto sliceId = anchor.start.load(); sliceId >= 0;) {
+        if (chain.size() >= static_cast<size_t>(map.sliceLimit()))
+            return false; // a loop
+        const auto &slice = map.readableSlice(fileno, sliceId);
+        chain.push_back(Rock::CheckpointSlice{sliceId, slice.size});
+        chainSize += slice.size;
+        sliceId = slice.next;
+    }
+    record.sliceCount = chain.size();
+    return record.sliceCount && chainSize == record.swapFileSize;
+}
+
+/// adds a validated checkpoint entry to the map
+/// \returns false if the map has no room for the entry
+static bool
+ImportEntry(Ipc::StoreMap &map, const Rock::CheckpointEntry &record, const std::vector<Rock::CheckpointSlice> &chain)
+{
+    const auto key = reinterpret_cast<const cache_key *>(record.key);
+
+    sfileno fileno = -1;
+    for (int way = 0; way < map.ways(); ++way) {
+        const auto candidate = map.fileNoByKey(key, way);
+        const auto &anchor = map.peekAtEntry(candidate);
+        if (anchor.sameKey(key))
+            return false; // paranoid: each key is saved at most once
+        if (fileno < 0 && anchor.empty())
+            fileno = candidate;
+    }
+    if (fileno < 0)
+        return false;
+
+    const auto anchor = map.openForWritingAt(fileno, false);
+    if (!anchor)
+        return false;
+
+    anchor->setKey(key);
+    anchor->basics.timestamp = record.timestamp;
+    anchor->basics.lastref = record.lastref;
+    anchor->basics.expires = record.expires;
+    anchor->basics.lastmod = record.lastmod;
+    anchor->basics.swap_file_sz = record.swapFileSize;
+    anchor->basics.refcount = record.refcount;
+    anchor->basics.flags = record.flags;
+    anchor->start = chain.front().id;
+    anchor->splicingPoint = record.splicingPoint;
+
+    for (size_t i = 0; i < chain.size(); ++i) {
+        Ipc::StoreMapSlice slice;
+        slice.size = chain[i].size;
+        slice.next = i + 1 < chain.size() ? chain[i + 1].id : -1;
+        map.importSlice(chain[i].id, slice);
+    }
+
+    map.closeForWriting(fileno);
+    return true;
+}
+
+/// Validates and, if the map is given, imports checkpoint entries. Marks
+/// slots of valid (and imported) entries as used. Throws on problems.
+/// \returns the number of valid (and imported) entries
+static int64_t
+ParseEntries(const Rock::SwapDir &dir, Rock::CheckpointReader &in, std::vector<bool> &usedSlots, Ipc::StoreMap * const map)
+{
+    const auto slotLimit = dir.slotLimitActual();
+    usedSlots.assign(slotLimit, false);
+
+    int64_t entries = 0;
+    std::vector<Rock::CheckpointSlice> chain;
+    while (true) {
+        Rock::CheckpointEntry record;
+        in.read(&record, sizeof(record));
+        if (!record.sliceCount)
+            break;
+
+        Must(record.key[0] || record.key[1]);
+        Must(record.sliceCount <= static_cast<uint64_t>(slotLimit));
+        chain.resize(record.sliceCount);
+        in.read(chain.data(), chain.size() * sizeof(chain[0]));
+
+        uint64_t chainSize = 0;
+        auto splicingPointFound = record.splicingPoint < 0;
+        for (const auto &slice: chain) {
+            Must(0 <= slice.id && slice.id < slotLimit);
+            Must(!usedSlots[slice.id]); // no loops or sharing
+            Must(slice.size > 0);
+            usedSlots[slice.id] = true;
+            chainSize += slice.size;
+            splicingPointFound = splicingPointFound || slice.id == record.splicingPoint;
+        }
+        Must(chainSize == record.swapFileSize);
+        Must(splicingPointFound);
+
+        if (map && !ImportEntry(*map, record, chain)) {
+            debugs(47, 3, "no room for an entry in cache_dir #" << dir.index);
+            for (const auto &slice: chain)
+                usedSlots[slice.id] = false;
+            continue;
+        }
+
+        ++entries;
+        Must(entries <= dir.entryLimitActual());
+    }
+    in.finish();
+    return entries;
+}
+
+SBuf
+Rock::IndexCheckpoint::Path(const SwapDir &dir)
+{
+    return ToSBuf(dir.filePath, ".index");
+}
+
+void
+Rock::IndexCheckpoint::Save(const SwapDir &dir)
+{
+    const auto stats = shm_old(Rebuild::Stats)(Rebuild::Stats::Path(dir.path).c_str());
+    if (!stats->completed(dir)) {
+        debugs(47, 2, "not saving partially indexed cache_dir #" << dir.index);
+        return;
+    }
+
+    auto path = Path(dir);
+    auto newPath = ToSBuf(path, ".new");
+    try {
+        getCurrentTime();
+        const auto start = current_time;
+
+        SyncDb(dir.filePath);
+
+        CheckpointWriter out(newPath);
+        const auto header = DescribeDb(dir, dir.filePath);
+        out.write(&header, sizeof(header));
+
+        Ipc::StoreMap map(dir.inodeMapPath());
+        int64_t entries = 0;
+        CheckpointEntry record;
+        std::vector<CheckpointSlice> chain;
+        for (sfileno fileno = 0; fileno < map.entryLimit(); ++fileno) {
+            const auto &peek = map.peekAtEntry(fileno);
+            if (!peek.complete())
+                continue;
+
+            uint64_t key[2] = { peek.key[0], peek.key[1] };
+            const auto anchor = map.openForReadingAt(fileno, reinterpret_cast<const cache_key *>(key));
+            if (!anchor)
+                continue;
+            const auto saving = DescribeEntry(map, fileno, *anchor, record, chain);
+            map.closeForReading(fileno);
+
+            if (saving) {
+                out.write(&record, sizeof(record));
+                out.write(chain.data(), chain.size() * sizeof(chain[0]));
+                ++entries;
+            }
+        }
+
+        memset(&record, 0, sizeof(record)); // no slices mark the end of entries
+        out.write(&record, sizeof(record));
+        out.finish();
+
+        if (!FileRename(newPath, path))
+            throw TextException(ToSBuf("cannot rename ", newPath, " to ", path), Here());
+
+        getCurrentTime();
+        debugs(47, DBG_IMPORTANT, "Saved " << entries << " cache_dir #" << dir.index <<
+               " entries to " << path << " in " << tvSubDsec(start, current_time) << " seconds");
+    } catch (...) {
+        debugs(47, DBG_IMPORTANT, "ERROR: Cannot save cache_dir #" << dir.index << " index" <<
+               Debug::Extra << "problem: " << CurrentException);
+        (void)unlink(newPath.c_str());
+    }
+}
+
+bool
+Rock::IndexCheckpoint::Load(const SwapDir &dir, Ipc::StoreMap &map, Ipc::Mem::PageStack &freeSlots, Rebuild::Stats &stats)
+{
+    auto path = Path(dir);
+    const auto fd = xopen(path.c_str(), O_RDONLY|O_BINARY);
+    if (fd < 0) {
+        const auto xerrno = errno;
+        debugs(47, (xerrno == ENOENT ? 3 : DBG_IMPORTANT), "cannot open " << path << ": " << xstrerr(xerrno));
+        return false;
+    }
+
+    getCurrentTime();
+    const auto start = current_time;
+
+    CheckpointReader in(fd);
+    std::vector<bool> usedSlots;
+    try {
+        CheckpointHeader header;
+        in.read(&header, sizeof(header));
+        const auto expectedHeader = DescribeDb(dir, dir.filePath);
+        if (memcmp(&header, &expectedHeader, sizeof(header)) != 0)
+            throw TextException("the checkpoint describes a different db file or cache_dir configuration", Here());
+        (void)ParseEntries(dir, in, usedSlots, nullptr);
+    } catch (...) {
+        debugs(47, DBG_IMPORTANT, "WARNING: Ignoring cache_dir #" << dir.index << " index checkpoint " << path <<
+               Debug::Extra << "problem: " << CurrentException);
+        (void)unlink(path.c_str());
+        return false;
+    }
+
+    // a checkpoint must not outlive the index it populates because that index
+    // will change while the checkpoint will not
+    if (unlink(path.c_str()) != 0) {
+        const auto xerrno = errno;
+        debugs(47, DBG_IMPORTANT, "WARNING: Ignoring cache_dir #" << dir.index << " index checkpoint " << path <<
+               Debug::Extra << "problem: cannot remove it: " << xstrerr(xerrno));
+        return false;
+    }
+
+    // the checkpoint was validated above; the map is modified from now on
+    in.rewind();
+    CheckpointHeader header;
+    in.read(&header, sizeof(header));
+    const auto entries = ParseEntries(dir, in, usedSlots, &map);
+
+    const auto slotLimit = dir.slotLimitActual();
+    for (int64_t slotId = 0; slotId < slotLimit; ++slotId) {
+        if (!usedSlots[slotId]) {
+            Ipc::Mem::PageId pageId;
+            pageId.pool = Ipc::Mem::PageStack::IdForSwapDirSpace(dir.index);
+            pageId.number = slotId + 1;
+            freeSlots.push(pageId);
+        }
+    }
+
+    // Rebuild::Start() will not scan the db
+    stats.counts.scancount = slotLimit;
+    stats.counts.validations = dir.entryLimitActual() + (opt_store_doublecheck ? slotLimit : 0);
+    stats.counts.objcount = entries;
+    stats.counts.updateStartTime(start);
+    Must(stats.completed(dir));
+
+    getCurrentTime();
+    debugs(47, DBG_IMPORTANT, "Loaded " << entries << " cache_dir #" << dir.index <<
+           " entries from " << path << " in " << tvSubDsec(start, current_time) << " seconds");
+    return true;
+}
+
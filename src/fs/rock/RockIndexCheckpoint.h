@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_FS_ROCK_ROCKINDEXCHECKPOINT_H
+#define SQUID_SRC_FS_ROCK_ROCKINDEXCHECKPOINT_H
+
+#include "fs/rock/forward.h"
+#include "fs/rock/RockRebuild.h"
+#include "ipc/mem/PageStack.h"
+#include "ipc/StoreMap.h"
+#include "sbuf/SBuf.h"
+
+namespace Rock
+{
+
+/// A snapshot of a cache_dir index (i.e. its entry anchors and slot chains)
+/// saved next to the db file when Squid shuts down cleanly. The next Squid
+/// instance loads the snapshot instead of scanning every db slot. A snapshot
+/// is used at most once: Squid removes it before trusting its contents, so
+/// that a crash cannot leave a stale snapshot behind. Any mismatch between the
+/// snapshot and the db file results in the usual db scan.
+class IndexCheckpoint
+{
+public:
+    /// Saves the fully indexed cache_dir map. The caller must ensure that no
+    /// process can modify the map or the db file while (or after) we save.
+    static void Save(const SwapDir &);
+
+    /// Populates the freshly created (and still empty) cache_dir map and
+    /// free slot stack using a saved snapshot, removing that snapshot.
+    /// On success, marks cache_dir indexing as completed in the given stats.
+    /// \returns whether the snapshot was loaded
+    static bool Load(const SwapDir &, Ipc::StoreMap &, Ipc::Mem::PageStack &freeSlots, Rebuild::Stats &);
+
+private:
+    static SBuf Path(const SwapDir &);
+};
+
+} // namespace Rock
+
+#endif /* SQUID_SRC_FS_ROCK_ROCKINDEXCHECKPOINT_H */
+
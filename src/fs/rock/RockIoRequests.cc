@@ -24,8 +24,6 @@ Rock::ReadRequest::ReadRequest(const ::ReadRequest &base, const IoState::Pointer
 Rock::WriteRequest::WriteRequest(const ::WriteRequest &base, const IoState::Pointer &anSio, const IoXactionId anId):
     ::WriteRequest(base),
     sio(anSio),
-    sidPrevious(-1),
-    sidCurrent(-1),
     id(anId),
     eof(false)
 {
@@ -14,6 +14,8 @@
 #include "fs/rock/forward.h"
 #include "fs/rock/RockIoState.h"
 
+#include <vector>
+
 class DiskFile;
 
 namespace Rock
@@ -36,16 +38,28 @@ class WriteRequest: public ::WriteRequest
     CBDATA_CLASS(WriteRequest);
 
 public:
+    /// a db slot written by a WriteRequest
+    class Slot
+    {
+    public:
+        /// slot that will point to the current one in the cache_dir map
+        SlotId previous = -1;
+
+        /// slot being written
+        SlotId current = -1;
+
+        /// the number of entry bytes (excluding DbCellHeader) in the slot
+        size_t payloadSize = 0;
+    };
+
     WriteRequest(const ::WriteRequest &, const IoState::Pointer &, const IoXactionId);
     IoState::Pointer sio;
 
-    /* We own these two reserved slots until SwapDir links them into the map. */
-
-    /// slot that will point to sidCurrent in the cache_dir map
-    SlotId sidPrevious;
+    /* We own these reserved slots until SwapDir links them into the map. */
 
-    /// slot being written using this write request
-    SlotId sidCurrent;
+    /// Slots being written using this write request, in entry order. Their
+    /// db cells are adjacent and together span len bytes starting at offset.
+    std::vector<Slot> slots;
 
     /// identifies this write transaction for the requesting IoState
     IoXactionId id;
@@ -18,10 +18,13 @@
 #include "fs/rock/RockIoState.h"
 #include "fs/rock/RockSwapDir.h"
 #include "globals.h"
+#include "ipc/mem/Pages.h"
 #include "MemObject.h"
 #include "Parsing.h"
 #include "Transients.h"
 
+#include <algorithm>
+
 Rock::IoState::IoState(Rock::SwapDir::Pointer &aDir,
                        StoreEntry *anEntry,
                        StoreIOState::STIOCB *cbIo,
@@ -40,7 +43,9 @@ Rock::IoState::IoState(Rock::SwapDir::Pointer &aDir,
     sidNext(-1),
     requestsSent(0),
     repliesReceived(0),
-    theBuf(dir->slotSize)
+    theBuf(dir->slotSize),
+    // a WriteRequest buffer must fit into a single shared memory I/O page
+    maxPendingSlots(std::max<size_t>(1, Ipc::Mem::PageSize() / dir->slotSize))
 {
     e = anEntry;
     e->lock("rock I/O");
@@ -61,6 +66,9 @@ Rock::IoState::~IoState()
     cbdataReferenceDone(callback_data);
     theFile = nullptr;
 
+    for (const auto &slot: pendingSlots)
+        memFreeBuf(slot.capacity, slot.buf);
+
     e->unlock("rock I/O");
 }
 
@@ -232,7 +240,10 @@ Rock::IoState::tryWrite(char const *buf, size_t size, off_t coreOff)
         // we do not want to risk writing a payload-free slot on EOF.
         if (overflow) {
             Must(sidNext < 0);
-            sidNext = dir->reserveSlotForWriting();
+            // reserve in entry order so that entry slots may be adjacent
+            if (sidFirst < 0)
+                sidCurrent = sidFirst = dir->reserveSlotForWriting();
+            sidNext = dir->reserveSlotForWriting(sidCurrent + 1);
             assert(sidNext >= 0);
             writeToDisk();
             Must(sidNext < 0); // short sidNext lifetime simplifies code logic
@@ -261,7 +272,8 @@ Rock::IoState::writeToBuffer(char const *buf, size_t size)
     return forCurrentSlot;
 }
 
-/// write what was buffered during write() calls
+/// finalizes what was buffered during write() calls and writes it to disk,
+/// possibly together with the next entry slots if they are adjacent on disk
 void
 Rock::IoState::writeToDisk()
 {
@@ -301,23 +313,16 @@ Rock::IoState::writeToDisk()
     // copy finalized db cell header into buffer
     memcpy(theBuf.mem, &header, sizeof(DbCellHeader));
 
-    // and now allocate another buffer for the WriteRequest so that
+    // and now allocate another buffer for the pending cell so that
     // we can support concurrent WriteRequests (and to ease cleaning)
     // TODO: should we limit the number of outstanding requests?
-    size_t wBufCap = 0;
-    void *wBuf = memAllocBuf(theBuf.size, &wBufCap);
-    memcpy(wBuf, theBuf.mem, theBuf.size);
-
-    const uint64_t diskOffset = dir->diskOffset(sidCurrent);
-    debugs(79, 5, swap_filen << " at " << diskOffset << '+' <<
-           theBuf.size);
-    const auto id = ++requestsSent;
-    WriteRequest *const r = new WriteRequest(
-        ::WriteRequest(static_cast<char*>(wBuf), diskOffset, theBuf.size,
-                       memFreeBufFunc(wBufCap)), this, id);
-    r->sidCurrent = sidCurrent;
-    r->sidPrevious = sidPrevious;
-    r->eof = lastWrite;
+    PendingSlot slot;
+    slot.previous = sidPrevious;
+    slot.current = sidCurrent;
+    slot.buf = static_cast<char*>(memAllocBuf(theBuf.size, &slot.capacity));
+    slot.size = theBuf.size;
+    memcpy(slot.buf, theBuf.mem, theBuf.size);
+    pendingSlots.push_back(slot);
 
     sidPrevious = sidCurrent;
     sidCurrent = sidNext; // sidNext may be cleared/negative already
@@ -325,10 +330,98 @@ Rock::IoState::writeToDisk()
 
     theBuf.clear();
 
+    // keep the cell if the next one may join it in the same WriteRequest
+    if (lastWrite || pendingSlots.size() >= maxPendingSlots || !adjacentToPendingSlots(sidCurrent))
+        writePendingSlots(lastWrite);
+}
+
+/// whether the given slot borders the slots of pending cells
+bool
+Rock::IoState::adjacentToPendingSlots(const SlotId sid) const
+{
+    if (sid < 0)
+        return false;
+    for (const auto &slot: pendingSlots) {
+        if (sid == slot.current + 1 || sid + 1 == slot.current)
+            return true;
+    }
+    return false;
+}
+
+/// sends all pending cells to disk using a single WriteRequest
+void
+Rock::IoState::writePendingSlots(const bool eof)
+{
+    assert(theFile != nullptr);
+    Must(!pendingSlots.empty());
+
+    auto first = pendingSlots.front().current;
+    auto last = first;
+    for (const auto &slot: pendingSlots) {
+        first = std::min(first, slot.current);
+        last = std::max(last, slot.current);
+    }
+    Must(static_cast<size_t>(last - first) < pendingSlots.size()); // no gaps
+
+    char *wBuf = nullptr;
+    size_t wBufSize = 0;
+    size_t wBufCap = 0;
+    if (pendingSlots.size() == 1) {
+        // the common case: give the cell buffer to the WriteRequest
+        const auto &slot = pendingSlots.front();
+        wBuf = slot.buf;
+        wBufSize = slot.size;
+        wBufCap = slot.capacity;
+    } else {
+        // place each cell at its db location relative to the first slot
+        wBufSize = (last - first) * slotSize;
+        for (const auto &slot: pendingSlots) {
+            if (slot.current == last)
+                wBufSize += slot.size;
+        }
+        wBuf = static_cast<char*>(memAllocBuf(wBufSize, &wBufCap));
+        for (const auto &slot: pendingSlots) {
+            const auto cellOffset = (slot.current - first) * slotSize;
+            memcpy(wBuf + cellOffset, slot.buf, slot.size);
+            if (slot.current != last) // pad the short last entry cell, if any
+                memset(wBuf + cellOffset + slot.size, 0, slotSize - slot.size);
+            memFreeBuf(slot.capacity, slot.buf);
+        }
+    }
+
+    const uint64_t diskOffset = dir->diskOffset(first);
+    debugs(79, 5, swap_filen << " at " << diskOffset << '+' << wBufSize <<
+           " slots: " << pendingSlots.size());
+    const auto id = ++requestsSent;
+    WriteRequest *const r = new WriteRequest(
+        ::WriteRequest(wBuf, diskOffset, wBufSize,
+                       memFreeBufFunc(wBufCap)), this, id);
+    for (const auto &slot: pendingSlots) {
+        WriteRequest::Slot written;
+        written.previous = slot.previous;
+        written.current = slot.current;
+        written.payloadSize = slot.size - sizeof(DbCellHeader);
+        r->slots.push_back(written);
+    }
+    r->eof = eof;
+
+    pendingSlots.clear();
+
     // theFile->write may call writeCompleted immediately
     theFile->write(r);
 }
 
+/// releases pending cells and their reserved slots
+void
+Rock::IoState::forgetPendingSlots()
+{
+    for (const auto &slot: pendingSlots) {
+        dir->noteFreeMapSlice(slot.current);
+        memFreeBuf(slot.capacity, slot.buf);
+    }
+    pendingSlots.clear();
+}
+
 bool
 Rock::IoState::expectedReply(const IoXactionId receivedId)
 {
@@ -356,6 +449,7 @@ Rock::IoState::finishedWriting(const int errFlag)
         dir->noteFreeMapSlice(sidNext);
         sidNext = -1;
     }
+    forgetPendingSlots();
 
     // we incremented offset_ while accumulating data in write()
     // we do not reset writeableAnchor_ here because we still keep the lock
@@ -13,6 +13,8 @@
 #include "fs/rock/RockSwapDir.h"
 #include "sbuf/MemBlob.h"
 
+#include <vector>
+
 class DiskFile;
 
 namespace Rock
@@ -70,6 +72,9 @@ private:
     void tryWrite(char const *buf, size_t size, off_t offset);
     size_t writeToBuffer(char const *buf, size_t size);
     void writeToDisk();
+    bool adjacentToPendingSlots(SlotId) const;
+    void writePendingSlots(bool eof);
+    void forgetPendingSlots();
 
     void callReaderBack(const char *buf, int rlen);
     void callBack(int errflag);
@@ -102,6 +107,25 @@ private:
 
     RefCount<DiskFile> theFile; // "file" responsible for this I/O
     MemBlob theBuf; // use for write content accumulation only
+
+    /// a finalized db cell that has not been given to theFile yet
+    class PendingSlot
+    {
+    public:
+        SlotId previous = -1; ///< the entry slot pointing to this one
+        SlotId current = -1; ///< the slot this cell is destined for
+        char *buf = nullptr; ///< the cell, starting with DbCellHeader
+        size_t size = 0; ///< the number of cell bytes in buf
+        size_t capacity = 0; ///< buf allocation size (for memFreeBuf())
+    };
+
+    /// Finalized db cells (in entry order) destined for adjacent slots. Sent
+    /// to theFile as a single WriteRequest when the next entry slot cannot
+    /// join them or when they reach maxPendingSlots.
+    std::vector<PendingSlot> pendingSlots;
+
+    /// the maximum number of slots written by a single WriteRequest
+    const size_t maxPendingSlots;
 };
 
 } // namespace Rock
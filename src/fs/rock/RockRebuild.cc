@@ -884,14 +884,39 @@ Rock::Rebuild::sameEntry(const sfileno fileno, const DbCellHeader &header) const
     return anchor.sameKey(reinterpret_cast<const cache_key*>(header.key));
 }
 
+/// the map position for the entry with the given key: the position of an
+/// entry with that key (if any) or the first key position we have not used
+/// \returns -1 if all positions available to the key are already taken
+sfileno
+Rock::Rebuild::loadingPosition(const cache_key *const key)
+{
+    const auto &map = *sd->map;
+    const auto keyPosition = map.fileNoByKey(key);
+    if (map.peekAtEntry(keyPosition).sameKey(key))
+        return keyPosition; // earlier slots of this entry or a fresher miss
+
+    for (int way = 0; way < map.ways(); ++way) {
+        const auto fileno = map.fileNoByKey(key, way);
+        if (loadingEntry(fileno).state() == LoadingEntry::leEmpty)
+            return fileno;
+    }
+    return -1;
+}
+
 /// handle freshly loaded (and validated) db slot header
 void
 Rock::Rebuild::useNewSlot(const SlotId slotId, const DbCellHeader &header)
 {
     const cache_key *const key =
         reinterpret_cast<const cache_key*>(header.key);
-    const sfileno fileno = sd->map->fileNoByKey(key);
-    assert(0 <= fileno && fileno < dbEntryLimit);
+    const sfileno fileno = loadingPosition(key);
+    if (fileno < 0) {
+        // all map positions for this key are occupied by other entries
+        debugs(47, 9, "no room for entry with key " << storeKeyText(key));
+        freeUnusedSlot(slotId, false);
+        return;
+    }
+    assert(fileno < dbEntryLimit);
 
     LoadingEntry le = loadingEntry(fileno);
     debugs(47,9, "entry " << fileno << " state: " << le.state() << ", inode: " <<
@@ -20,10 +20,12 @@
 #include "DiskIO/ReadRequest.h"
 #include "DiskIO/WriteRequest.h"
 #include "fs/rock/RockHeaderUpdater.h"
+#include "fs/rock/RockIndexCheckpoint.h"
 #include "fs/rock/RockIoRequests.h"
 #include "fs/rock/RockIoState.h"
 #include "fs/rock/RockSwapDir.h"
 #include "globals.h"
+#include "ipc/Kids.h"
 #include "ipc/mem/Pages.h"
 #include "MemObject.h"
 #include "Parsing.h"
@@ -41,7 +43,8 @@
 
 Rock::SwapDir::SwapDir(): ::SwapDir("rock"),
     slotSize(HeaderSize), filePath(nullptr), map(nullptr), io(nullptr),
-    waitingForPage(nullptr)
+    waitingForPage(nullptr),
+    replacement(Ipc::StoreMapPolicy::fifo)
 {
 }
 
@@ -291,6 +294,7 @@ Rock::SwapDir::init()
     Must(!map);
     map = new DirMap(inodeMapPath());
     map->cleaner = this;
+    map->replacementPolicy(replacement);
 
     const char *ioModule = needsDiskStrand() ? "IpcIo" : "Blocking";
     if (DiskIOModule *m = DiskIOModule::Find(ioModule)) {
@@ -345,6 +349,8 @@ Rock::SwapDir::reconfigure()
     parseSize(true);
     parseOptions(1);
     // TODO: can we reconfigure the replacement policy (repl)?
+    if (map)
+        map->replacementPolicy(replacement);
     validateOptions();
 }
 
@@ -376,6 +382,8 @@ Rock::SwapDir::getOptionTree() const
         vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseSizeOption, &SwapDir::dumpSizeOption));
         vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseTimeOption, &SwapDir::dumpTimeOption));
         vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseRateOption, &SwapDir::dumpRateOption));
+        vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseIoOption, &SwapDir::dumpIoOption));
+        vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseReplacementOption, &SwapDir::dumpReplacementOption));
     } else {
         // we don't know how to handle copt, as it's not a ConfigOptionVector.
         // free it (and return nullptr)
@@ -490,6 +498,61 @@ Rock::SwapDir::dumpRateOption(StoreEntry * e) const
         storeAppendPrintf(e, " max-swap-rate=%d", fileConfig.ioRate);
 }
 
+/// parses disker I/O options; mimics ::SwapDir::optionObjectSizeParse()
+bool
+Rock::SwapDir::parseIoOption(char const *option, const char *value, int reconfig)
+{
+    if (strcmp(option, "direct-io") == 0) {
+        const bool newDirectIo = value ? (xatoi(value) != 0) : true;
+        if (!reconfig)
+            fileConfig.directIo = newDirectIo;
+        else if (fileConfig.directIo != newDirectIo) {
+            debugs(3, DBG_IMPORTANT, "WARNING: cache_dir " << path << ' ' << option
+                   << " cannot be changed dynamically, value left unchanged: " <<
+                   (fileConfig.directIo ? "on" : "off"));
+        }
+        return true;
+    }
+
+    if (strcmp(option, "io-queue-depth") != 0)
+        return false;
+
+    if (!value) {
+        self_destruct();
+        return false;
+    }
+
+    const int maxDepth = 4096;
+    const int64_t parsedValue = strtoll(value, nullptr, 10);
+    if (parsedValue < 1 || parsedValue > maxDepth) {
+        debugs(3, DBG_CRITICAL, "FATAL: cache_dir " << path << ' ' << option << " must be between 1 and " << maxDepth << " but is: " << parsedValue);
+        self_destruct();
+        return false;
+    }
+
+    const int newDepth = static_cast<int>(parsedValue);
+
+    if (!reconfig)
+        fileConfig.ioQueueDepth = newDepth;
+    else if (fileConfig.ioQueueDepth != newDepth) {
+        debugs(3, DBG_IMPORTANT, "WARNING: cache_dir " << path << ' ' << option
+               << " cannot be changed dynamically, value left unchanged: " <<
+               fileConfig.ioQueueDepth);
+    }
+
+    return true;
+}
+
+/// reports disker I/O options; mimics ::SwapDir::optionObjectSizeDump()
+void
+Rock::SwapDir::dumpIoOption(StoreEntry * e) const
+{
+    if (fileConfig.ioQueueDepth != 1)
+        storeAppendPrintf(e, " io-queue-depth=%d", fileConfig.ioQueueDepth);
+    if (fileConfig.directIo)
+        storeAppendPrintf(e, " direct-io");
+}
+
 /// parses size-specific options; mimics ::SwapDir::optionObjectSizeParse()
 bool
 Rock::SwapDir::parseSizeOption(char const *option, const char *value, int reconfig)
@@ -537,6 +600,30 @@ Rock::SwapDir::dumpSizeOption(StoreEntry * e) const
     storeAppendPrintf(e, " slot-size=%" PRId64, slotSize);
 }
 
+/// parses replacement-policy option
+bool
+Rock::SwapDir::parseReplacementOption(char const *option, const char *value, int)
+{
+    if (strcmp(option, "replacement-policy") != 0)
+        return false;
+
+    if (!value) {
+        self_destruct();
+        return false;
+    }
+
+    replacement = Ipc::StoreMap::ParsePolicy(SBuf(value));
+    return true;
+}
+
+/// reports replacement-policy option
+void
+Rock::SwapDir::dumpReplacementOption(StoreEntry * e) const
+{
+    if (replacement != Ipc::StoreMapPolicy::fifo)
+        storeAppendPrintf(e, " replacement-policy=%s", Ipc::StoreMap::PolicyName(replacement));
+}
+
 /// check the results of the configuration; only level-0 debugging works here
 void
 Rock::SwapDir::validateOptions()
@@ -544,6 +631,16 @@ Rock::SwapDir::validateOptions()
     if (slotSize <= 0)
         fatal("Rock store requires a positive slot-size");
 
+    // O_DIRECT writes are padded to alignment boundaries, and slots (that
+    // start after our aligned db header) must not overlap the padding
+    const auto directIoAlignment = DiskFile::Config::DirectIoAlignment;
+    static_assert(HeaderSize % directIoAlignment == 0, "the db header preserves slot alignment");
+    if (fileConfig.directIo && slotSize % directIoAlignment != 0) {
+        debugs(47, DBG_CRITICAL, "FATAL: Rock cache_dir " << path << " direct-io requires a slot-size that is a multiple of " <<
+               directIoAlignment << " bytes; configured slot-size: " << slotSize);
+        fatal("Rock store direct-io requires an aligned slot-size");
+    }
+
     const int64_t maxSizeRoundingWaste = 1024 * 1024; // size is configured in MB
     const int64_t slotSizeRoundingWaste = slotSize;
     const int64_t maxRoundingWaste =
@@ -696,11 +793,11 @@ Rock::SwapDir::diskOffsetLimit() const
 }
 
 Rock::SlotId
-Rock::SwapDir::reserveSlotForWriting()
+Rock::SwapDir::reserveSlotForWriting(const SlotId preferred)
 {
     Ipc::Mem::PageId pageId;
 
-    if (freeSlots->pop(pageId)) {
+    if (validSlotId(preferred) ? freeSlots->pop(pageId, preferred + 1) : freeSlots->pop(pageId)) {
         const auto slotId = pageId.number - 1;
         debugs(47, 5, "got a previously free slot: " << slotId);
         map->prepFreeSlice(slotId);
@@ -857,7 +954,8 @@ Rock::SwapDir::writeCompleted(int errflag, size_t, RefCount< ::WriteRequest> r)
     // quit if somebody called IoState::close() while we were waiting
     if (!sio.stillWaiting()) {
         debugs(79, 3, "ignoring closed entry " << sio.swap_filen);
-        noteFreeMapSlice(request->sidCurrent);
+        for (const auto &slot: request->slots)
+            noteFreeMapSlice(slot.current);
         return;
     }
 
@@ -879,24 +977,28 @@ void
 Rock::SwapDir::handleWriteCompletionSuccess(const WriteRequest &request)
 {
     auto &sio = *(request.sio);
-    sio.splicingPoint = request.sidCurrent;
     // do not increment sio.offset_ because we do it in sio->write()
 
     assert(sio.writeableAnchor_);
-    if (sio.writeableAnchor_->start < 0) { // wrote the first slot
-        Must(request.sidPrevious < 0);
-        sio.writeableAnchor_->start = request.sidCurrent;
-    } else {
-        Must(request.sidPrevious >= 0);
-        map->writeableSlice(sio.swap_filen, request.sidPrevious).next = request.sidCurrent;
-    }
+    Must(!request.slots.empty());
+    for (const auto &slot: request.slots) {
+        sio.splicingPoint = slot.current;
+
+        if (sio.writeableAnchor_->start < 0) { // wrote the first slot
+            Must(slot.previous < 0);
+            sio.writeableAnchor_->start = slot.current;
+        } else {
+            Must(slot.previous >= 0);
+            map->writeableSlice(sio.swap_filen, slot.previous).next = slot.current;
+        }
 
-    // finalize the shared slice info after writing slice contents to disk;
-    // the chain gets possession of the slice we were writing
-    Ipc::StoreMap::Slice &slice =
-        map->writeableSlice(sio.swap_filen, request.sidCurrent);
-    slice.size = request.len - sizeof(DbCellHeader);
-    Must(slice.next < 0);
+        // finalize the shared slice info after writing slice contents to disk;
+        // the chain gets possession of the slice we were writing
+        Ipc::StoreMap::Slice &slice =
+            map->writeableSlice(sio.swap_filen, slot.current);
+        slice.size = slot.payloadSize;
+        Must(slice.next < 0);
+    }
 
     if (request.eof) {
         assert(sio.e);
@@ -919,7 +1021,8 @@ Rock::SwapDir::handleWriteCompletionProblem(const int errflag, const WriteReques
 {
     auto &sio = *request.sio;
 
-    noteFreeMapSlice(request.sidCurrent);
+    for (const auto &slot: request.slots)
+        noteFreeMapSlice(slot.current);
 
     writeError(sio);
     sio.finishedWriting(errflag);
@@ -1062,6 +1165,10 @@ Rock::SwapDir::statfs(StoreEntry &e) const
         const int entryCount = map->entryCount();
         storeAppendPrintf(&e, "Current entries: %9d %.2f%%\n",
                           entryCount, (100.0 * entryCount / entryLimit));
+
+        Ipc::StoreMapStats mapStats;
+        map->updateStats(mapStats);
+        mapStats.dump(e);
     }
 
     storeAppendPrintf(&e, "Maximum slots:   %9d\n", slotLimit);
@@ -1139,10 +1246,37 @@ void Rock::SwapDirRr::create()
             Ipc::Mem::Owner<Ipc::Mem::PageStack> *const freeSlotsOwner =
                 shm_new(Ipc::Mem::PageStack)(sd->freeSlotsPath(), config);
             freeSlotsOwners.push_back(freeSlotsOwner);
+
+            // -z may re-create the db; keep the checkpoint for the next run
+            if (!opt_create_swap_dirs) {
+                SwapDir::DirMap map(sd->inodeMapPath());
+                IndexCheckpoint::Load(*sd, map, *freeSlotsOwner->object(), *rebuildStatsOwners.back()->object());
+            }
         }
     }
 }
 
+void Rock::SwapDirRr::finishShutdown()
+{
+    // Only the process that created the shared maps saves them. The master
+    // process does that after all kids have exited; no kid can modify a map
+    // or a db file at that point. This process saw no create() otherwise.
+    if (mapOwners.empty())
+        return;
+
+    // a kid that died or was killed may have left a map or a db half-updated;
+    // the next start will scan the db instead
+    if (!TheKids.allExitedHappy()) {
+        debugs(47, DBG_IMPORTANT, "WARNING: Not saving rock cache_dir indexes because some kid processes did not exit cleanly");
+        return;
+    }
+
+    for (size_t i = 0; i < Config.cacheSwap.n_configured; ++i) {
+        if (const Rock::SwapDir *const sd = dynamic_cast<Rock::SwapDir *>(INDEXSD(i)))
+            IndexCheckpoint::Save(*sd);
+    }
+}
+
 Rock::SwapDirRr::~SwapDirRr()
 {
     for (size_t i = 0; i < mapOwners.size(); ++i) {
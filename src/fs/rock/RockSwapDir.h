@@ -52,6 +52,7 @@ public:
     void create() override;
     void parse(int index, char *path) override;
     bool smpAware() const override { return true; }
+    int64_t allocationUnit() const override { return slotSize; }
     bool hasReadableEntry(const StoreEntry &) const override;
 
     // temporary path to the shared memory map of first slots of cached entries
@@ -68,7 +69,9 @@ public:
     bool validSlotId(const SlotId slotId) const;
 
     /// finds and returns a free db slot to fill or throws
-    SlotId reserveSlotForWriting();
+    /// \param preferred the slot to return if it is free; otherwise, a free
+    /// slot near it is preferred (so that entry slots stay adjacent on disk)
+    SlotId reserveSlotForWriting(SlotId preferred = -1);
 
     /// purges one or more entries to make full() false and free some slots
     void purgeSome();
@@ -115,8 +118,12 @@ protected:
     void dumpTimeOption(StoreEntry * e) const;
     bool parseRateOption(char const *option, const char *value, int reconfiguring);
     void dumpRateOption(StoreEntry * e) const;
+    bool parseIoOption(char const *option, const char *value, int reconfiguring);
+    void dumpIoOption(StoreEntry * e) const;
     bool parseSizeOption(char const *option, const char *value, int reconfiguring);
     void dumpSizeOption(StoreEntry * e) const;
+    bool parseReplacementOption(char const *option, const char *value, int reconfiguring);
+    void dumpReplacementOption(StoreEntry * e) const;
 
     bool full() const; ///< no more entries can be stored without purging
     void trackReferences(StoreEntry &e); ///< add to replacement policy scope
@@ -132,6 +139,7 @@ protected:
     friend class Rebuild;
     friend class IoState;
     friend class HeaderUpdater;
+    friend class IndexCheckpoint;
     const char *filePath; ///< location of cache storage file inside path/
     DirMap *map; ///< entry key/sfileno to MaxExtras/inode mapping
 
@@ -147,6 +155,7 @@ private:
 
     /* configurable options */
     DiskFile::Config fileConfig; ///< file-level configuration options
+    Ipc::StoreMapPolicy replacement; ///< how map purges entries
 
     static const int64_t HeaderSize = 16*1024; ///< on-disk db header size
 };
@@ -157,6 +166,7 @@ class SwapDirRr: public Ipc::Mem::RegisteredRunner
 public:
     /* ::RegisteredRunner API */
     ~SwapDirRr() override;
+    void finishShutdown() override;
 
 protected:
     /* Ipc::Mem::RegisteredRunner API */
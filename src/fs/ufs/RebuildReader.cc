@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 47    Store Directory Routines */
+
+#include "squid.h"
+#include "defines.h"
+#include "fs/ufs/RebuildReader.h"
+#include "fs/ufs/UFSSwapLogParser.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#if HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#if HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+
+namespace Fs
+{
+namespace Ufs
+{
+
+/// the maximum number of results in one batch
+static const size_t BatchSize = 1024;
+
+/// the maximum number of unclaimed batches; limits memory usage when the
+/// main thread is busy
+static const size_t MaxReadyBatches = 64;
+
+/// leaves signal handling to the main thread
+static void
+BlockSignals()
+{
+    sigset_t signals;
+    sigfillset(&signals);
+    (void)pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+}
+
+} // namespace Ufs
+} // namespace Fs
+
+Fs::Ufs::RebuildReader::RebuildReader(UFSSwapLogParser &parser):
+    nextDirectory(0),
+    stopping(false)
+{
+    startThreads(1, [this, &parser] { readSwapLog(parser); });
+}
+
+Fs::Ufs::RebuildReader::RebuildReader(const std::vector<Directory> &dirs, const int threads):
+    directories(dirs),
+    nextDirectory(0),
+    stopping(false)
+{
+    startThreads(threads, [this] { scanDirectories(); });
+}
+
+Fs::Ufs::RebuildReader::~RebuildReader()
+{
+    stop();
+}
+
+template <class Work>
+void
+Fs::Ufs::RebuildReader::startThreads(const int threads, Work work)
+{
+    try {
+        for (int i = 0; i < threads; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++runningThreads;
+            }
+            try {
+                threads_.emplace_back([this, work] {
+                    BlockSignals();
+                    work();
+                    threadFinished();
+                });
+            } catch (...) {
+                threadFinished();
+                throw;
+            }
+        }
+    } catch (...) {
+        stop(); // the destructor is not called when the constructor throws
+        throw;
+    }
+}
+
+/// tells helper threads to quit and waits for them to do so
+void
+Fs::Ufs::RebuildReader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    roomAvailable.notify_all();
+    for (auto &thread: threads_)
+        thread.join();
+    threads_.clear();
+}
+
+bool
+Fs::Ufs::RebuildReader::get(Batch &batch, const bool wait)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (wait)
+        resultsReady.wait(lock, [this] { return !ready.empty() || !runningThreads; });
+
+    if (ready.empty())
+        return false;
+
+    batch = std::move(ready.front());
+    ready.pop_front();
+    roomAvailable.notify_one();
+    return true;
+}
+
+bool
+Fs::Ufs::RebuildReader::exhausted()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return ready.empty() && !runningThreads;
+}
+
+/// helper thread code that reads swap.state records until the end of the log
+void
+Fs::Ufs::RebuildReader::readSwapLog(UFSSwapLogParser &parser)
+{
+    bool more = true;
+    while (more && !stopping) {
+        Batch batch;
+        batch.records.resize(BatchSize);
+        size_t count = 0;
+        while (count < BatchSize && parser.ReadRecord(batch.records[count]))
+            ++count;
+        more = count == BatchSize;
+        batch.records.resize(count);
+        if (!deliver(batch))
+            return;
+    }
+}
+
+/// helper thread code that loads cache files from unclaimed directories
+void
+Fs::Ufs::RebuildReader::scanDirectories()
+{
+    while (!stopping) {
+        const auto index = nextDirectory++;
+        if (index >= directories.size())
+            return;
+        const auto &directory = directories[index];
+
+        Batch batch;
+        const auto dir = opendir(directory.path.c_str());
+        if (!dir) {
+            batch.files.emplace_back();
+            auto &failure = batch.files.back();
+            failure.directory = &directory;
+            failure.failedCall = "opendir";
+            failure.xerrno = errno;
+        } else {
+            while (const auto entry = readdir(dir)) {
+                int fn = 0;
+                if (sscanf(entry->d_name, "%x", &fn) != 1)
+                    continue; // not a cache file name (e.g., "." or "..")
+
+                batch.files.emplace_back();
+                auto &file = batch.files.back();
+                file.directory = &directory;
+                file.fileno = fn;
+                loadFile(file, entry->d_name);
+
+                if (batch.files.size() >= BatchSize) {
+                    if (!deliver(batch)) {
+                        closedir(dir);
+                        return;
+                    }
+                    batch = Batch();
+                }
+            }
+            closedir(dir);
+        }
+
+        batch.scannedDirectories = 1;
+        if (!deliver(batch))
+            return;
+    }
+}
+
+/// fills file details using the named file in file.directory
+void
+Fs::Ufs::RebuildReader::loadFile(DiskFile &file, const char * const name) const
+{
+    const auto fileName = file.directory->path + '/' + name;
+    const auto fd = open(fileName.c_str(), O_RDONLY | O_BINARY);
+    if (fd < 0) {
+        file.failedCall = "open";
+        file.xerrno = errno;
+        return;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) < 0) {
+        file.failedCall = "fstat";
+        file.xerrno = errno;
+    } else {
+        file.size = sb.st_size > 0 ? static_cast<uint64_t>(sb.st_size) : 0;
+        file.meta.resize(SM_PAGE_SIZE - 1); // leaves room for MemBuf 0-termination
+        const auto len = read(fd, file.meta.data(), file.meta.size());
+        if (len < 0) {
+            file.failedCall = "read";
+            file.xerrno = errno;
+            file.meta.clear();
+        } else {
+            file.meta.resize(len);
+        }
+    }
+    close(fd);
+}
+
+/// gives the batch to the main thread, waiting for queue space if needed
+/// \returns false if the helper thread must quit
+bool
+Fs::Ufs::RebuildReader::deliver(Batch &batch)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    roomAvailable.wait(lock, [this] { return stopping || ready.size() < MaxReadyBatches; });
+    if (stopping)
+        return false;
+    ready.push_back(std::move(batch));
+    resultsReady.notify_one();
+    return true;
+}
+
+void
+Fs::Ufs::RebuildReader::threadFinished()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    --runningThreads;
+    resultsReady.notify_one();
+}
+
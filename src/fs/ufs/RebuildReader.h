@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_FS_UFS_REBUILDREADER_H
+#define SQUID_SRC_FS_UFS_REBUILDREADER_H
+
+#include "store/forward.h"
+#include "StoreSwapLogData.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Fs
+{
+namespace Ufs
+{
+
+class UFSSwapLogParser;
+
+/// Reads swap.state records or cache file metadata on helper threads, giving
+/// the results to the main thread in batches. The main thread still does all
+/// the indexing. Helper threads only make system calls and use standard C++
+/// containers: Squid memory pools, debugging, and globals are off limits.
+class RebuildReader
+{
+public:
+    /// a second-level cache_dir subdirectory
+    class Directory
+    {
+    public:
+        std::string path; ///< full subdirectory name
+        int l1 = 0; ///< first-level subdirectory number
+        int l2 = 0; ///< second-level subdirectory number
+    };
+
+    /// the beginning of a cache file found in a Directory (or a scan error)
+    class DiskFile
+    {
+    public:
+        const Directory *directory = nullptr; ///< where the file was found
+        sfileno fileno = -1; ///< file number based on its name
+        uint64_t size = 0; ///< file size according to fstat(2)
+        std::vector<char> meta; ///< leading file bytes; see storeRebuildLoadEntry()
+
+        /// the name of the failed system call or nil
+        /// opendir(3) failures have a negative fileno
+        const char *failedCall = nullptr;
+        int xerrno = 0; ///< failedCall errno
+    };
+
+    /// results given to the main thread at once
+    class Batch
+    {
+    public:
+        std::vector<StoreSwapLogData> records; ///< swap.state records, in log order
+        std::vector<DiskFile> files; ///< cache files, in no particular order
+        size_t scannedDirectories = 0; ///< directories finished by this batch
+    };
+
+    /// starts a thread that reads all records using the given parser
+    explicit RebuildReader(UFSSwapLogParser &);
+
+    /// starts threads that load all cache files in the given directories
+    RebuildReader(const std::vector<Directory> &, int threads);
+
+    ~RebuildReader();
+
+    RebuildReader(RebuildReader &&) = delete; // no copying or moving of any kind
+
+    /// Gives the oldest unclaimed batch to the caller, if any. Waits for a
+    /// batch to become available if requested and more results are expected.
+    /// \returns whether the given batch was filled
+    bool get(Batch &, bool wait);
+
+    /// whether all results have been claimed and no more will come
+    bool exhausted();
+
+private:
+    template <class Work>
+    void startThreads(int threads, Work);
+    void stop();
+
+    void readSwapLog(UFSSwapLogParser &);
+    void scanDirectories();
+    void loadFile(DiskFile &, const char *name) const;
+    bool deliver(Batch &);
+    void threadFinished();
+
+    const std::vector<Directory> directories; ///< scanDirectories() input
+    std::atomic<size_t> nextDirectory; ///< the first unclaimed directories item
+
+    std::mutex mutex; ///< protects the members below
+    std::condition_variable resultsReady; ///< main thread waits on this
+    std::condition_variable roomAvailable; ///< helper threads wait on this
+    std::deque<Batch> ready; ///< unclaimed batches
+    int runningThreads = 0; ///< helper threads that may add more batches
+    std::atomic<bool> stopping; ///< whether helper threads must quit
+
+    std::vector<std::thread> threads_;
+};
+
+} // namespace Ufs
+} // namespace Fs
+
+#endif /* SQUID_SRC_FS_UFS_REBUILDREADER_H */
+
@@ -10,10 +10,13 @@
 
 #include "squid.h"
 #include "base/IoManip.h"
+#include "base/TextException.h"
 #include "fs_io.h"
 #include "globals.h"
 #include "RebuildState.h"
+#include "sbuf/Stream.h"
 #include "SquidConfig.h"
+#include "StatCounters.h"
 #include "store/Disks.h"
 #include "store_key_md5.h"
 #include "store_rebuild.h"
@@ -76,10 +79,14 @@ Fs::Ufs::RebuildState::RebuildState(const RefCount<UFSSwapDir> &aSwapDir) :
 
     debugs(47, DBG_IMPORTANT, "Rebuilding storage in " << sd->path << " (" <<
            (clean ? "clean log" : (LogParser ? "dirty log" : "no log")) << ")");
+
+    startReader();
 }
 
 Fs::Ufs::RebuildState::~RebuildState()
 {
+    delete reader; // before LogParser, which reader may be using
+
     sd->closeTmpSwapLog();
 
     if (LogParser)
@@ -102,6 +109,42 @@ Fs::Ufs::RebuildState::RebuildStep(void *data)
     }
 }
 
+/// starts loading swap.state records or cache files on helper threads if
+/// the cache_dir is configured to do so
+void
+Fs::Ufs::RebuildState::startReader()
+{
+    const auto threads = sd->rebuildThreads();
+    if (threads <= 0)
+        return;
+
+    try {
+        if (fromLog) {
+            (void)LogParser->SwapLogEntries(); // caches the total before reader uses LogParser
+            reader = new RebuildReader(*LogParser);
+            debugs(47, 2, "reading " << sd->path << " swaplog using a helper thread");
+        } else {
+            std::vector<RebuildReader::Directory> directories;
+            for (int l1 = 0; sd->validL1(l1); ++l1) {
+                for (int l2 = 0; sd->validL2(l2); ++l2) {
+                    RebuildReader::Directory directory;
+                    directory.path = ToSBuf(sd->path, '/', asHex(l1).upperCase().minDigits(2),
+                                            '/', asHex(l2).upperCase().minDigits(2)).toStdString();
+                    directory.l1 = l1;
+                    directory.l2 = l2;
+                    directories.push_back(directory);
+                }
+            }
+            totalDirectories = directories.size();
+            reader = new RebuildReader(directories, threads);
+            debugs(47, DBG_IMPORTANT, "Scanning " << sd->path << " dir using " << threads << " helper threads");
+        }
+    } catch (...) {
+        debugs(47, DBG_IMPORTANT, "WARNING: Cannot use helper threads to rebuild " << sd->path << ": " << CurrentException);
+        reader = nullptr;
+    }
+}
+
 /// load entries from swap.state or files until we run out of entries or time
 void
 Fs::Ufs::RebuildState::rebuildStep()
@@ -115,7 +158,10 @@ Fs::Ufs::RebuildState::rebuildStep()
     const int totalEntries = LogParser ? LogParser->SwapLogEntries() : -1;
 
     while (!isDone()) {
-        if (fromLog)
+        if (reader) {
+            if (!rebuildFromReader())
+                break; // wait for helper threads (or stop because we are done)
+        } else if (fromLog)
             rebuildFromSwapLog();
         else
             rebuildFromDirectory();
@@ -141,8 +187,6 @@ Fs::Ufs::RebuildState::rebuildStep()
 void
 Fs::Ufs::RebuildState::rebuildFromDirectory()
 {
-    cache_key key[SQUID_MD5_DIGEST_LENGTH];
-
     struct stat sb;
     int fd = -1;
     debugs(47, 3, "DIR #" << sd->index);
@@ -153,9 +197,7 @@ Fs::Ufs::RebuildState::rebuildFromDirectory()
     fd = getNextFile(&filn, &size);
 
     if (fd == -2) {
-        debugs(47, DBG_IMPORTANT, "Done scanning " << sd->path << " dir (" <<
-               n_read << " entries)");
-        _done = true;
+        finishDirectories();
         return;
     } else if (fd < 0) {
         return;
@@ -177,20 +219,30 @@ Fs::Ufs::RebuildState::rebuildFromDirectory()
 
     MemBuf buf;
     buf.init(SM_PAGE_SIZE, SM_PAGE_SIZE);
-    if (!storeRebuildLoadEntry(fd, sd->index, buf, counts))
+    const auto loaded = storeRebuildLoadEntry(fd, sd->index, buf, counts);
+
+    file_close(fd);
+    --store_open_disk_fd;
+    fd = -1;
+
+    if (!loaded)
         return;
 
     const uint64_t expectedSize = sb.st_size > 0 ?
                                   static_cast<uint64_t>(sb.st_size) : 0;
+    indexFile(filn, buf, expectedSize);
+}
+
+/// indexes a cache file given its leading bytes and size
+void
+Fs::Ufs::RebuildState::indexFile(const sfileno filn, MemBuf &buf, const uint64_t expectedSize)
+{
+    cache_key key[SQUID_MD5_DIGEST_LENGTH];
 
     StoreEntry tmpe;
     const bool parsed = storeRebuildParseEntry(buf, tmpe, key, counts,
                         expectedSize);
 
-    file_close(fd);
-    --store_open_disk_fd;
-    fd = -1;
-
     bool accepted = parsed && tmpe.swap_file_sz > 0;
     if (parsed && !accepted) {
         debugs(47, DBG_IMPORTANT, "WARNING: Ignoring ufs cache entry with " <<
@@ -272,16 +324,18 @@ Fs::Ufs::RebuildState::rebuildFromSwapLog()
     StoreSwapLogData swapData;
 
     if (LogParser->ReadRecord(swapData) != 1) {
-        debugs(47, DBG_IMPORTANT, "Done reading " << sd->path << " swaplog (" << n_read << " entries)");
-        LogParser->Close();
-        delete LogParser;
-        LogParser = nullptr;
-        _done = true;
+        finishSwapLog();
         return;
     }
 
     ++n_read;
+    indexLogRecord(swapData);
+}
 
+/// processes one swap log entry
+void
+Fs::Ufs::RebuildState::indexLogRecord(StoreSwapLogData &swapData)
+{
     if (!swapData.sane()) {
         ++counts.invalid;
         return;
@@ -350,6 +404,113 @@ Fs::Ufs::RebuildState::rebuildFromSwapLog()
                swapData.flags);
 }
 
+/// indexes one swap.state record or cache file loaded by reader
+/// \returns false if there is nothing to index until the next rebuildStep()
+bool
+Fs::Ufs::RebuildState::rebuildFromReader()
+{
+    while (batchPos >= batch.records.size() + batch.files.size()) {
+        if (!reader->get(batch, opt_foreground_rebuild)) {
+            if (reader->exhausted()) {
+                if (fromLog)
+                    finishSwapLog();
+                else
+                    finishDirectories();
+            }
+            return false;
+        }
+
+        batchPos = 0;
+        if (batch.scannedDirectories) {
+            scannedDirectories += batch.scannedDirectories;
+            storeRebuildProgress(sd->index, totalDirectories, scannedDirectories);
+        }
+    }
+
+    if (batchPos < batch.records.size()) {
+        ++n_read;
+        indexLogRecord(batch.records[batchPos++]);
+    } else {
+        indexDiskFile(batch.files[batchPos++ - batch.records.size()]);
+    }
+    return true;
+}
+
+/// indexes one cache file loaded by reader; mimics rebuildFromDirectory()
+void
+Fs::Ufs::RebuildState::indexDiskFile(const RebuildReader::DiskFile &file)
+{
+    const auto &directory = *file.directory;
+
+    if (file.fileno < 0) {
+        debugs(47, DBG_IMPORTANT, "ERROR: " << MYNAME << "in opendir (" << directory.path << "): " << xstrerr(file.xerrno));
+        return;
+    }
+
+    if (!UFSSwapDir::FilenoBelongsHere(file.fileno, sd->index, directory.l1, directory.l2)) {
+        debugs(47, 3, asHex(file.fileno).upperCase().minDigits(8) <<
+               " does not belong in " << sd->index << "/" <<
+               asHex(directory.l1).upperCase().minDigits(2) << "/" <<
+               asHex(directory.l2).upperCase().minDigits(2));
+        return;
+    }
+
+    if (sd->mapBitTest(file.fileno)) {
+        debugs(47, 3, "Locked, continuing with next.");
+        return;
+    }
+
+    ++n_read;
+
+    if (file.failedCall) {
+        debugs(47, DBG_IMPORTANT, "ERROR: Cannot load " << directory.path << '/' <<
+               asHex(file.fileno).upperCase().minDigits(8) << ": " <<
+               file.failedCall << "() failure: " << xstrerr(file.xerrno));
+        return;
+    }
+
+    ++statCounter.syscalls.disk.reads;
+
+    MemBuf buf;
+    buf.init(SM_PAGE_SIZE, SM_PAGE_SIZE);
+    buf.append(file.meta.data(), file.meta.size());
+    indexFile(file.fileno, buf, file.size);
+}
+
+void
+Fs::Ufs::RebuildState::finishSwapLog()
+{
+    debugs(47, DBG_IMPORTANT, "Done reading " << sd->path << " swaplog (" << n_read << " entries)");
+    delete reader; // before LogParser, which reader may be using
+    reader = nullptr;
+    LogParser->Close();
+    delete LogParser;
+    LogParser = nullptr;
+    _done = true;
+    reportSpeed();
+}
+
+void
+Fs::Ufs::RebuildState::finishDirectories()
+{
+    debugs(47, DBG_IMPORTANT, "Done scanning " << sd->path << " dir (" <<
+           n_read << " entries)");
+    delete reader;
+    reader = nullptr;
+    _done = true;
+    reportSpeed();
+}
+
+/// reports how fast this cache_dir was indexed
+void
+Fs::Ufs::RebuildState::reportSpeed() const
+{
+    const auto elapsedSeconds = tvSubDsec(counts.startTime, current_time);
+    debugs(47, DBG_IMPORTANT, "Indexed " << counts.objcount << " " << sd->path << " entries in " <<
+           elapsedSeconds << " seconds (" <<
+           (elapsedSeconds > 0 ? counts.objcount / elapsedSeconds : 0.0) << " entries/sec)");
+}
+
 int
 Fs::Ufs::RebuildState::getNextFile(sfileno * filn_p, int *)
 {
@@ -10,10 +10,12 @@
 #define SQUID_SRC_FS_UFS_REBUILDSTATE_H
 
 #include "base/RefCount.h"
+#include "fs/ufs/RebuildReader.h"
 #include "store_rebuild.h"
 #include "UFSSwapDir.h"
 #include "UFSSwapLogParser.h"
 
+class MemBuf;
 class StoreEntry;
 
 namespace Fs
@@ -59,9 +61,17 @@ public:
     StoreRebuildData counts;
 
 private:
+    void startReader();
     void rebuildFromDirectory();
     void rebuildFromSwapLog();
+    bool rebuildFromReader();
     void rebuildStep();
+    void indexFile(sfileno, MemBuf &, uint64_t expectedSize);
+    void indexLogRecord(StoreSwapLogData &);
+    void indexDiskFile(const RebuildReader::DiskFile &);
+    void finishSwapLog();
+    void finishDirectories();
+    void reportSpeed() const;
     void addIfFresh(const cache_key *key,
                     sfileno file_number,
                     uint64_t swap_file_sz,
@@ -75,6 +85,14 @@ private:
     int getNextFile(sfileno *, int *size);
     bool fromLog;
     bool _done;
+
+    /// loads index sources on helper threads (if configured)
+    RebuildReader *reader = nullptr;
+    RebuildReader::Batch batch; ///< reader results being indexed
+    size_t batchPos = 0; ///< the number of batch records and files indexed
+    size_t totalDirectories = 0; ///< the number of directories given to reader
+    size_t scannedDirectories = 0; ///< directories fully scanned by reader
+
     // TODO: (callback) should be hidden behind a proper human readable name
     void (callback)(void *cbdata);
     void *cbdata;
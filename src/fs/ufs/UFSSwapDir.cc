@@ -201,7 +201,8 @@ Fs::Ufs::UFSSwapDir::changeIO(DiskIOModule *module)
     IO->io = anIO;
     /* Change the IO Options */
 
-    if (currentIOOptions && currentIOOptions->options.size() > 2) {
+    // skip SwapDir, IOEngine, and rebuild-threads options
+    if (currentIOOptions && currentIOOptions->options.size() > 3) {
         delete currentIOOptions->options.back();
         currentIOOptions->options.pop_back();
     }
@@ -246,6 +247,41 @@ Fs::Ufs::UFSSwapDir::optionIODump(StoreEntry * e) const
     storeAppendPrintf(e, " IOEngine=%s", ioType);
 }
 
+/// parses the rebuild-threads option
+bool
+Fs::Ufs::UFSSwapDir::optionRebuildParse(char const *option, const char *value, int isaReconfig)
+{
+    if (strcmp(option, "rebuild-threads") != 0)
+        return false;
+
+    if (!value) {
+        self_destruct();
+        return false;
+    }
+
+    const int maxThreads = 64;
+    const int64_t parsedValue = strtoll(value, nullptr, 10);
+    if (parsedValue < 0 || parsedValue > maxThreads) {
+        debugs(3, DBG_CRITICAL, "FATAL: cache_dir " << path << ' ' << option << " must be between 0 and " << maxThreads << " but is: " << parsedValue);
+        self_destruct();
+        return false;
+    }
+
+    // the new value will only matter when (if) the cache_dir is rebuilt again
+    if (isaReconfig && rebuildThreads_ != parsedValue)
+        debugs(3, DBG_IMPORTANT, "cache_dir " << path << ' ' << option << " now " << parsedValue);
+
+    rebuildThreads_ = static_cast<int>(parsedValue);
+    return true;
+}
+
+void
+Fs::Ufs::UFSSwapDir::optionRebuildDump(StoreEntry * e) const
+{
+    if (rebuildThreads_)
+        storeAppendPrintf(e, " rebuild-threads=%d", rebuildThreads_);
+}
+
 ConfigOption *
 Fs::Ufs::UFSSwapDir::getOptionTree() const
 {
@@ -258,6 +294,8 @@ Fs::Ufs::UFSSwapDir::getOptionTree() const
 
     currentIOOptions->options.push_back(new ConfigOptionAdapter<UFSSwapDir>(*const_cast<UFSSwapDir *>(this), &UFSSwapDir::optionIOParse, &UFSSwapDir::optionIODump));
 
+    currentIOOptions->options.push_back(new ConfigOptionAdapter<UFSSwapDir>(*const_cast<UFSSwapDir *>(this), &UFSSwapDir::optionRebuildParse, &UFSSwapDir::optionRebuildDump));
+
     if (ConfigOption *ioOptions = IO->io->getOptionTree())
         currentIOOptions->options.push_back(ioOptions);
 
@@ -554,6 +592,13 @@ Fs::Ufs::UFSSwapDir::openStoreIO(StoreEntry &e, StoreIOState::STIOCB * const aCa
     return IO->open(this, &e, aCallback, callback_data);
 }
 
+int
+Fs::Ufs::UFSSwapDir::openEntryFile(const StoreEntry &e)
+{
+    // a blocking open(2), but cheaper than the StoreIOState reads it replaces
+    return file_open(fullPath(e.swap_filen, nullptr), O_RDONLY | O_BINARY);
+}
+
 int
 Fs::Ufs::UFSSwapDir::mapBitTest(sfileno filn)
 {
@@ -58,6 +58,7 @@ public:
     bool dereference(StoreEntry &) override;
     StoreIOState::Pointer createStoreIO(StoreEntry &, StoreIOState::STIOCB *, void *) override;
     StoreIOState::Pointer openStoreIO(StoreEntry &, StoreIOState::STIOCB *, void *) override;
+    int openEntryFile(const StoreEntry &) override;
     void openLog() override;
     void closeLog() override;
     int writeCleanStart() override;
@@ -111,6 +112,10 @@ public:
     bool validL2(int) const;
     bool validL1(int) const;
 
+    /// the number of helper threads loading cache_dir index sources during
+    /// a rebuild; zero means loading them in the main thread
+    int rebuildThreads() const { return rebuildThreads_; }
+
     /** Add and remove the given StoreEntry from the replacement policy in use */
     void replacementAdd(StoreEntry *e);
     void replacementRemove(StoreEntry *e);
@@ -144,11 +149,14 @@ private:
     void changeIO(DiskIOModule *);
     bool optionIOParse(char const *option, const char *value, int reconfiguring);
     void optionIODump(StoreEntry * e) const;
+    bool optionRebuildParse(char const *option, const char *value, int reconfiguring);
+    void optionRebuildDump(StoreEntry * e) const;
     mutable ConfigOptionVector *currentIOOptions;
     char const *ioType;
     uint64_t cur_size; ///< currently used space in the storage area
     uint64_t n_disk_objects; ///< total number of objects stored
     bool rebuilding_; ///< whether RebuildState is writing the new swap.state
+    int rebuildThreads_ = 0; ///< rebuild-threads option value
 };
 
 } //namespace Ufs
@@ -11,6 +11,7 @@
 #ifndef SQUID_SRC_FS_IO_H
 #define SQUID_SRC_FS_IO_H
 
+#include "base/RefCount.h"
 #include "mem/forward.h"
 #include "sbuf/forward.h"
 #include "typedefs.h" //DRCB, DWCB
@@ -68,6 +69,20 @@ void file_write(int, off_t, void const *, int len, DWCB *, void *, FREE *);
 void file_read(int, char *, int, off_t, DRCB *, void *);
 void safeunlink(const char *path, int quiet);
 
+/// A file_open()ed descriptor used by several independent parties (e.g., a
+/// transaction and its pending Comm::SendFile()). The last user closes it.
+class SharedFile: public RefCountable
+{
+public:
+    using Pointer = RefCount<SharedFile>;
+
+    explicit SharedFile(const int aFd): fd(aFd) {}
+    SharedFile(SharedFile &&) = delete; // no copying or moving of any kind
+    ~SharedFile() override { file_close(fd); }
+
+    const int fd; ///< the open file descriptor
+};
+
 /*
  * Wrapper for rename(2) which complains if something goes wrong;
  * the caller is responsible for handing and explaining the
@@ -9,25 +9,31 @@
 #include "squid.h"
 #include "client_side_request.h"
 #include "clientStream.h"
+#include "fde.h"
+#include "fs_io.h"
 #include "http/Stream.h"
 #include "HttpHdrContRange.h"
 #include "HttpHeaderTools.h"
+#include "SquidConfig.h"
 #include "Store.h"
+#include "store/Disk.h"
 #include "TimeOrTag.h"
 #if USE_DELAY_POOLS
 #include "acl/FilledChecklist.h"
 #include "ClientInfo.h"
-#include "fde.h"
 #include "MessageDelayPools.h"
 #endif
 
+#include <sys/stat.h>
+
 Http::Stream::Stream(const Comm::ConnectionPointer &aConn, ClientHttpRequest *aReq) :
     clientConnection(aConn),
     http(aReq),
     reply(nullptr),
     writtenToSocket(0),
     mayUseConnection_(false),
-    connRegistered_(false)
+    connRegistered_(false),
+    diskBodyStart_(0)
 {
     assert(http != nullptr);
     memset(reqbuf, '\0', sizeof (reqbuf));
@@ -77,7 +83,8 @@ Http::Stream::writeComplete(size_t size)
     switch (socketState()) {
 
     case STREAM_NONE:
-        pullData();
+        if (!sendBodyFromDisk())
+            pullData();
         break;
 
     case STREAM_COMPLETE: {
@@ -122,6 +129,88 @@ Http::Stream::pullData()
     clientStreamRead(getTail(), http, readBuffer);
 }
 
+/// Sends the next portion of the response body from the cache file (if
+/// possible), bypassing the store client and Squid memory.
+/// \returns false if the caller should pullData() instead
+bool
+Http::Stream::sendBodyFromDisk()
+{
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+    if (!diskFile_ && !openDiskHitFile())
+        return false;
+
+    const auto entry = http->storeEntry();
+    const auto bodySize = entry->objectLen() - entry->mem().baseReply().hdr_sz;
+    const auto bodyLeft = bodySize - http->out.offset;
+    if (bodyLeft <= 0)
+        return false; // let the store client conclude the transaction
+
+    // bounds each Comm::SendFile() so that Comm::IoCallback::size fits
+    static const int64_t MaxSendFileSize = 1024*1024;
+    const auto size = static_cast<int>(std::min(bodyLeft, MaxSendFileSize));
+    const auto fileOffset = diskBodyStart_ + http->out.offset;
+    debugs(33, 5, "sending " << size << " body bytes at " << fileOffset << " of " << *entry << " from FD " << diskFile_->fd);
+    noteSentBodyBytes(size);
+    getConn()->sendFile(diskFile_, fileOffset, size);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/// Decides whether the rest of the response body should be sent from the
+/// cache file of a whole-object disk hit. If it should, opens that file.
+bool
+Http::Stream::openDiskHitFile()
+{
+    if (!Config.onoff.disk_hit_zero_copy)
+        return false;
+
+    // the response must reach the socket as stored
+    if (!reply || http->request->range || reply->contentRange() ||
+            http->request->flags.chunkedReply)
+        return false;
+
+    // no clientStream nodes (e.g., ESI) between us and the store client
+    if (getClientReplyContext() != http->client_stream.head->data)
+        return false;
+
+#if USE_DELAY_POOLS
+    if (writeQuotaHandler)
+        return false;
+#endif
+
+    if (!Comm::IsConnOpen(clientConnection) || !fd_table[clientConnection->fd].writesDirectly())
+        return false;
+
+    const auto entry = http->storeEntry();
+    if (!entry || entry->store_status != STORE_OK || !entry->swappedOut() ||
+            !entry->hasDisk() || !entry->mem_obj || entry->objectLen() < 0)
+        return false;
+
+    const auto bodySize = entry->objectLen() - entry->mem().baseReply().hdr_sz;
+    const auto fileSize = static_cast<int64_t>(entry->swap_file_sz);
+    if (bodySize <= http->out.offset || fileSize < bodySize)
+        return false;
+
+    const auto fd = INDEXSD(entry->swap_dirn)->openEntryFile(*entry);
+    if (fd < 0)
+        return false;
+
+    // guard against files that do not match the index entry
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || sb.st_size != fileSize) {
+        debugs(33, 3, "file size mismatch for " << *entry << " in FD " << fd);
+        file_close(fd);
+        return false;
+    }
+
+    debugs(33, 3, "sending " << *entry << " body from FD " << fd);
+    diskFile_ = new SharedFile(fd);
+    diskBodyStart_ = fileSize - bodySize;
+    return true;
+}
+
 bool
 Http::Stream::multipartRangeRequest() const
 {
@@ -277,15 +366,20 @@ Http::Stream::sendStartOfMessage(HttpReply *rep, StoreIOBuffer bodyData)
     /* Save length of headers for persistent conn checks */
     http->out.headers_sz = mb->contentSize();
 
+    // body bytes to send after mb without copying them into it
+    Comm::IoSegment extras[2];
+    int extrasCount = 0;
     if (bodyData.data && bodyData.length) {
         if (multipartRangeRequest())
             packRange(bodyData, mb);
         else if (http->request->flags.chunkedReply) {
-            packChunk(bodyData, *mb);
+            const auto length = packChunkStart(bodyData, *mb);
+            extras[extrasCount++] = Comm::IoSegment{bodyData.data, static_cast<int>(length)};
+            extras[extrasCount++] = Comm::IoSegment{"\r\n", 2};
         } else {
             size_t length = lengthToSend(bodyData.range());
             noteSentBodyBytes(length);
-            mb->append(bodyData.data, length);
+            extras[extrasCount++] = Comm::IoSegment{bodyData.data, static_cast<int>(length)};
         }
     }
 #if USE_DELAY_POOLS
@@ -307,7 +401,7 @@ Http::Stream::sendStartOfMessage(HttpReply *rep, StoreIOBuffer bodyData)
     }
 #endif
 
-    getConn()->write(mb);
+    getConn()->write(mb, extras, extrasCount);
     delete mb;
 }
 
@@ -323,11 +417,18 @@ Http::Stream::sendBody(StoreIOBuffer bodyData)
 
     MemBuf mb;
     mb.init();
-    if (multipartRangeRequest())
-        packRange(bodyData, &mb);
-    else
-        packChunk(bodyData, mb);
+    if (!multipartRangeRequest()) {
+        // send chunk data without copying it into mb
+        const auto length = packChunkStart(bodyData, mb);
+        const Comm::IoSegment extras[] = {
+            Comm::IoSegment{bodyData.data, static_cast<int>(length)},
+            Comm::IoSegment{"\r\n", 2}
+        };
+        getConn()->write(&mb, extras, 2);
+        return;
+    }
 
+    packRange(bodyData, &mb);
     if (mb.contentSize())
         getConn()->write(&mb);
     else
@@ -572,19 +673,19 @@ Http::Stream::prepareReply(HttpReply *rep)
 }
 
 /**
- * Packs bodyData into mb using chunked encoding.
+ * Packs the chunk-size line of the bodyData chunk into mb. The caller sends
+ * the returned number of bodyData bytes followed by CRLF, without copying.
  * Packs the last-chunk if bodyData is empty.
  */
-void
-Http::Stream::packChunk(const StoreIOBuffer &bodyData, MemBuf &mb)
+size_t
+Http::Stream::packChunkStart(const StoreIOBuffer &bodyData, MemBuf &mb)
 {
     const uint64_t length =
         static_cast<uint64_t>(lengthToSend(bodyData.range()));
     noteSentBodyBytes(length);
 
     mb.appendf("%" PRIX64 "\r\n", length);
-    mb.append(bodyData.data, length);
-    mb.append("\r\n", 2);
+    return length;
 }
 
 /**
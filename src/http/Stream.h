@@ -13,6 +13,7 @@
 #include "comm/forward.h"
 #include "debug/Stream.h"
 #include "error/Error.h"
+#include "fs_io.h"
 #include "http/forward.h"
 #include "log/forward.h"
 #include "mem/forward.h"
@@ -161,12 +162,19 @@ public: // HTTP/1.x state data
 
 private:
     void prepareReply(HttpReply *);
-    void packChunk(const StoreIOBuffer &bodyData, MemBuf &);
+    size_t packChunkStart(const StoreIOBuffer &bodyData, MemBuf &);
     void packRange(StoreIOBuffer const &, MemBuf *);
     void doClose();
+    bool sendBodyFromDisk();
+    bool openDiskHitFile();
 
     bool mayUseConnection_; /* This request may use the connection. Don't read anymore requests for now */
     bool connRegistered_;
+
+    /// the cache file sendBodyFromDisk() sends the response body from, if any
+    SharedFile::Pointer diskFile_;
+    /// the diskFile_ offset of the first response body byte
+    int64_t diskBodyStart_;
 #if USE_DELAY_POOLS
     MessageBucket::Pointer writeQuotaHandler; ///< response write limiter, if configured
 #endif
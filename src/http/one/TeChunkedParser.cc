@@ -91,6 +91,8 @@ Http::One::TeChunkedParser::parseChunkSize(Tokenizer &tok)
 {
     Must(theChunkSize <= 0); // Should(), really
 
+    parseSimpleChunks(tok);
+
     static const SBuf bannedHexPrefixLower("0x");
     static const SBuf bannedHexPrefixUpper("0X");
     if (tok.skip(bannedHexPrefixLower) || tok.skip(bannedHexPrefixUpper))
@@ -116,6 +118,68 @@ Http::One::TeChunkedParser::parseChunkSize(Tokenizer &tok)
     return false; // should not be reachable
 }
 
+/// \returns the value of a hexadecimal digit or -1 for other characters
+static int
+HexDigitValue(const char c)
+{
+    if ('0' <= c && c <= '9')
+        return c - '0';
+    if ('a' <= c && c <= 'f')
+        return c - 'a' + 10;
+    if ('A' <= c && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/// Optimization: Decodes a sequence of complete "chunk-size CRLF chunk-data
+/// CRLF" chunks that have no chunk extensions and fit into theOut, without
+/// tokenizing their metadata. Origins streaming many small chunks send little
+/// else. Leaves the first chunk it cannot fully decode (e.g., the last-chunk,
+/// a partially received chunk, or anything unusual) to the general code.
+void
+Http::One::TeChunkedParser::parseSimpleChunks(Tokenizer &tok)
+{
+    // at most 15 hex digits so that any size is also a valid int64_t
+    const int maxDigits = 15;
+
+    buf_ = tok.remaining(); // sync buffers before buf_ use
+    const auto start = buf_.rawContent();
+    const auto end = start + buf_.length();
+
+    auto pos = start;
+    size_t chunks = 0;
+    while (pos < end) {
+        uint64_t size = 0;
+        auto cur = pos;
+        for (int value = 0; cur < end && cur - pos < maxDigits && (value = HexDigitValue(*cur)) >= 0; ++cur)
+            size = (size << 4) | value;
+
+        if (!size)
+            break; // no chunk-size, 0x prefix, or last-chunk
+
+        if (end - cur < 2 || cur[0] != '\r' || cur[1] != '\n')
+            break; // extensions, BWS, too many digits, or insufficient input
+        cur += 2;
+
+        if (static_cast<uint64_t>(end - cur) < size + 2 || size > static_cast<uint64_t>(theOut->potentialSpaceSize()))
+            break; // insufficient input or space
+
+        const auto dataEnd = cur + size;
+        if (dataEnd[0] != '\r' || dataEnd[1] != '\n')
+            break; // malformed chunk end
+
+        theOut->append(cur, size);
+        pos = dataEnd + 2;
+        ++chunks;
+    }
+
+    if (pos != start) {
+        debugs(94, 7, "decoded " << chunks << " simple chunk(s) of " << (pos - start) << " bytes");
+        buf_.consume(pos - start); // parse checkpoint
+        tok.reset(buf_);
+    }
+}
+
 /// Parses "[chunk-ext] CRLF" from RFC 7230 section 4.1.1:
 ///   chunk = chunk-size [ chunk-ext ] CRLF chunk-data CRLF
 ///   last-chunk = 1*"0" [ chunk-ext ] CRLF
@@ -70,6 +70,7 @@ public:
 
 private:
     bool parseChunkSize(Tokenizer &tok);
+    void parseSimpleChunks(Tokenizer &tok);
     bool parseChunkMetadataSuffix(Tokenizer &);
     void parseChunkExtensions(Tokenizer &);
     void parseOneChunkExtension(Tokenizer &);
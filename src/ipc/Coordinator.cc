@@ -14,12 +14,16 @@
 #include "CacheManager.h"
 #include "comm.h"
 #include "comm/Connection.h"
+#include "compat/socket.h"
 #include "compat/unistd.h"
+#include "CpuAffinityMap.h"
+#include "globals.h"
 #include "ipc/Coordinator.h"
 #include "ipc/SharedListen.h"
 #include "mgr/Inquirer.h"
 #include "mgr/Request.h"
 #include "mgr/Response.h"
+#include "SquidConfig.h"
 #include "tools.h"
 #if SQUID_SNMP
 #include "snmp/Inquirer.h"
@@ -29,6 +33,9 @@
 
 #include <cerrno>
 
+#if HAVE_LINUX_FILTER_H
+#include <linux/filter.h>
+#endif
 #if HAVE_SYS_UNISTD_H
 #include <sys/unistd.h>
 #endif
@@ -153,10 +160,14 @@ Ipc::Coordinator::handleSharedListenRequest(const SharedListenRequest& request)
 {
     debugs(54, 4, "kid" << request.requestorId <<
            " needs shared listen FD for " << request.params.addr);
-    Listeners::const_iterator i = listeners.find(request.params);
     int errNo = 0;
-    const Comm::ConnectionPointer c = (i != listeners.end()) ?
-                                      i->second : openListenSocket(request, errNo);
+    Comm::ConnectionPointer c;
+    if (request.params.flags & COMM_REUSEPORT_CPU) {
+        c = steeredListenSocket(request, errNo);
+    } else {
+        Listeners::const_iterator i = listeners.find(request.params);
+        c = (i != listeners.end()) ? i->second : openListenSocket(request, errNo);
+    }
 
     debugs(54, 3, "sending shared listen " << c << " for " <<
            request.params.addr << " to kid" << request.requestorId <<
@@ -283,6 +294,101 @@ Ipc::Coordinator::openListenSocket(const SharedListenRequest& request,
     return newConn;
 }
 
+/// Attaches a classic BPF program to a SO_REUSEPORT group, making the kernel
+/// pick the group socket of the worker bound to the CPU that received the
+/// connection (per cpu_affinity_map) or, without a map, worker CPU%workers.
+/// The Nth group socket must belong to worker kidN+1.
+static void
+AttachCpuSteering(const Comm::ConnectionPointer &conn)
+{
+#if HAVE_LINUX_FILTER_H && defined(SO_ATTACH_REUSEPORT_CBPF)
+    const auto workers = static_cast<uint32_t>(Config.workers);
+    std::vector<sock_filter> code;
+    code.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+    if (Config.cpuAffinityMap) {
+        const auto &processes = Config.cpuAffinityMap->processes();
+        const auto &cores = Config.cpuAffinityMap->cores();
+        for (size_t i = 0; i < processes.size() && i < cores.size(); ++i) {
+            const auto kid = processes[i];
+            if (kid < 1 || static_cast<uint32_t>(kid) > workers)
+                continue; // not a worker
+            // cores are numbered from one while SKF_AD_CPU starts at zero
+            code.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(cores[i] - 1), 0, 1));
+            code.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(kid - 1)));
+        }
+        // an out-of-range answer makes the kernel fall back to hashing
+        code.push_back(BPF_STMT(BPF_RET | BPF_K, workers));
+    } else {
+        code.push_back(BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, workers));
+        code.push_back(BPF_STMT(BPF_RET | BPF_A, 0));
+    }
+
+    sock_fprog program;
+    program.len = code.size();
+    program.filter = code.data();
+    if (xsetsockopt(conn->fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) < 0) {
+        const auto xerrno = errno;
+        debugs(54, DBG_IMPORTANT, "ERROR: cannot steer " << conn << " connections by CPU: " << xstrerr(xerrno) <<
+               Debug::Extra << "connections will be spread among workers by hash");
+        return;
+    }
+    debugs(54, 3, "steering " << conn << " connections by CPU using " << code.size() << " BPF instructions");
+#else
+    debugs(54, DBG_IMPORTANT, "ERROR: cannot steer " << conn << " connections by CPU: no SO_ATTACH_REUSEPORT_CBPF support");
+#endif
+}
+
+Comm::ConnectionPointer
+Ipc::Coordinator::steeredListenSocket(const SharedListenRequest& request, int &errNo)
+{
+    const OpenListenerParams &p = request.params;
+    auto &group = steeredListeners[p];
+
+    if (group.empty()) {
+        // The kernel numbers SO_REUSEPORT group sockets in their listen(2)
+        // order. We open and listen on all of them now, in worker order,
+        // and keep them open so that the numbering survives worker restarts.
+        for (int kid = 1; kid <= Config.workers; ++kid) {
+            Comm::ConnectionPointer newConn = new Comm::Connection;
+            newConn->local = p.addr; // comm_open_listener may modify it
+            newConn->flags = p.flags;
+
+            enter_suid();
+            comm_open_listener(p.sock_type, p.proto, newConn, FdNote(p.fdNote));
+            errNo = Comm::IsConnOpen(newConn) ? 0 : errno;
+            leave_suid();
+
+            if (!errNo && xlisten(newConn->fd, Squid_MaxFD >> 2) < 0)
+                errNo = errno;
+
+            if (errNo) {
+                debugs(54, DBG_IMPORTANT, "ERROR: cannot open CPU-steered listener at " << p.addr <<
+                       " for kid" << kid << ": " << xstrerr(errNo));
+                for (const auto &conn: group)
+                    conn->close();
+                steeredListeners.erase(p);
+                if (Comm::IsConnOpen(newConn))
+                    newConn->close();
+                return newConn;
+            }
+
+            debugs(54, 6, "listening on " << newConn << " for kid" << kid);
+            group.push_back(newConn);
+        }
+        AttachCpuSteering(group.front());
+    }
+
+    const auto position = request.requestorId - 1;
+    if (position < 0 || static_cast<size_t>(position) >= group.size()) {
+        debugs(54, DBG_IMPORTANT, "ERROR: kid" << request.requestorId << " is not a worker; " <<
+               "refusing to give it a CPU-steered listener at " << p.addr);
+        errNo = EINVAL;
+        return new Comm::Connection;
+    }
+
+    return group[position];
+}
+
 void Ipc::Coordinator::broadcastSignal(int sig) const
 {
     typedef StrandCoords::const_iterator SCI;
@@ -22,6 +22,7 @@
 #endif
 #include <list>
 #include <map>
+#include <vector>
 
 namespace Ipc
 {
@@ -64,6 +65,8 @@ protected:
 #endif
     /// calls comm_open_listener()
     Comm::ConnectionPointer openListenSocket(const SharedListenRequest& request, int &errNo);
+    /// returns the requestor's socket in a cached or new CPU-steered group
+    Comm::ConnectionPointer steeredListenSocket(const SharedListenRequest& request, int &errNo);
 
 private:
     StrandCoords strands_; ///< registered processes and threads
@@ -74,6 +77,10 @@ private:
     typedef std::map<OpenListenerParams, Comm::ConnectionPointer> Listeners; ///< params:connection map
     Listeners listeners; ///< cached comm_open_listener() results
 
+    /// params:connections map; the Nth connection belongs to worker kidN+1
+    typedef std::map<OpenListenerParams, std::vector<Comm::ConnectionPointer> > SteeredListeners;
+    SteeredListeners steeredListeners; ///< cached steeredListenSocket() groups
+
     static Coordinator* TheInstance; ///< the only class instance in existence
 
 private:
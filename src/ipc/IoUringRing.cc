@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 54    Interprocess Communication */
+
+#include "squid.h"
+
+#if USE_IO_URING
+
+#include "base/TextException.h"
+#include "debug/Stream.h"
+#include "ipc/IoUringRing.h"
+#include "sbuf/Stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+Ipc::IoUringRing::IoUringRing(const unsigned int entries)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ringFd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ringFd < 0)
+        throw TextException(ToSBuf("io_uring_setup(2) failure: ", xstrerr(errno)), Here());
+    features_ = params.features;
+
+    try {
+        // we map both rings at once and rely on the kernel never dropping completions
+        const auto required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP;
+        if ((features_ & required) != required)
+            throw TextException(ToSBuf("io_uring lacks required features: ", features_), Here());
+
+        const auto sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        const auto cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        ringAreaSize = std::max<size_t>(sqRingSize, cqRingSize);
+        ringArea = mmap(nullptr, ringAreaSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (ringArea == MAP_FAILED) {
+            ringArea = nullptr;
+            throw TextException(ToSBuf("io_uring mmap(2) failure: ", xstrerr(errno)), Here());
+        }
+
+        sqesAreaSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqesArea = mmap(nullptr, sqesAreaSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (sqesArea == MAP_FAILED) {
+            sqesArea = nullptr;
+            throw TextException(ToSBuf("io_uring mmap(2) failure: ", xstrerr(errno)), Here());
+        }
+    } catch (...) {
+        releaseResources(); // the destructor is not called when the constructor throws
+        throw;
+    }
+
+    const auto ring = static_cast<char *>(ringArea);
+    sqHead = reinterpret_cast<unsigned *>(ring + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned *>(ring + params.sq_off.tail);
+    sqArray = reinterpret_cast<unsigned *>(ring + params.sq_off.array);
+    sqMask = *reinterpret_cast<unsigned *>(ring + params.sq_off.ring_mask);
+    sqEntries = params.sq_entries;
+    sqes = static_cast<io_uring_sqe *>(sqesArea);
+
+    cqHead = reinterpret_cast<unsigned *>(ring + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned *>(ring + params.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned *>(ring + params.cq_off.ring_mask);
+    cqEntries = params.cq_entries;
+    cqes = reinterpret_cast<io_uring_cqe *>(ring + params.cq_off.cqes);
+
+    debugs(54, 3, "FD " << ringFd << " submission queue entries: " << sqEntries << ", completion queue entries: " << cqEntries);
+}
+
+Ipc::IoUringRing::~IoUringRing()
+{
+    releaseResources();
+}
+
+void
+Ipc::IoUringRing::releaseResources()
+{
+    if (sqesArea)
+        munmap(sqesArea, sqesAreaSize);
+    if (ringArea)
+        munmap(ringArea, ringAreaSize);
+    if (ringFd >= 0)
+        close(ringFd); // the kernel completes or cancels requests in flight
+}
+
+bool
+Ipc::IoUringRing::supports(const int opcode) const
+{
+    // IORING_REGISTER_PROBE appeared after io_uring itself; treat probe
+    // failures as a lack of support for anything beyond the basics
+    const auto maxOps = 256;
+    const auto probeSize = sizeof(io_uring_probe) + maxOps * sizeof(io_uring_probe_op);
+    std::unique_ptr<char[]> probeBuf(new char[probeSize]());
+    const auto probe = reinterpret_cast<io_uring_probe *>(probeBuf.get());
+    if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, maxOps) < 0) {
+        debugs(54, 3, "io_uring probe failure: " << xstrerr(errno));
+        return false;
+    }
+    return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+}
+
+io_uring_sqe &
+Ipc::IoUringRing::nextSqe()
+{
+    const auto tail = *sqTail; // only we modify the tail
+    if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+        submit(); // make room
+        if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+            throw TextException("io_uring submission queue overflow", Here());
+    }
+
+    const auto index = tail & sqMask;
+    auto &sqe = sqes[index];
+    memset(&sqe, 0, sizeof(sqe));
+    sqArray[index] = index;
+    // the caller fills the entry before the next enter() makes it visible
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++unsubmitted_;
+    return sqe;
+}
+
+int
+Ipc::IoUringRing::enter(const unsigned int minComplete, const unsigned int flags, const void * const arg, const size_t argSize)
+{
+    ++enterCalls;
+    const auto result = syscall(__NR_io_uring_enter, ringFd, unsubmitted_, minComplete, flags, arg, argSize);
+    if (result > 0) {
+        submitted += result;
+        unsubmitted_ -= std::min<unsigned>(unsubmitted_, result);
+    }
+    return result;
+}
+
+void
+Ipc::IoUringRing::submit()
+{
+    while (unsubmitted_) {
+        if (enter(0, 0, nullptr, 0) < 0) {
+            const auto xerrno = errno;
+            if (xerrno == EINTR)
+                continue;
+            // EAGAIN and EBUSY are not expected because users never reserve
+            // more entries than the completion queue can hold
+            throw TextException(ToSBuf("io_uring_enter(2) failure: ", xstrerr(xerrno)), Here());
+        }
+    }
+}
+
+bool
+Ipc::IoUringRing::hasCompletions() const
+{
+    return __atomic_load_n(cqTail, __ATOMIC_ACQUIRE) != *cqHead; // only we modify the head
+}
+
+const io_uring_cqe &
+Ipc::IoUringRing::frontCompletion() const
+{
+    return cqes[*cqHead & cqMask];
+}
+
+void
+Ipc::IoUringRing::popCompletion()
+{
+    __atomic_store_n(cqHead, *cqHead + 1, __ATOMIC_RELEASE);
+}
+
+#endif /* USE_IO_URING */
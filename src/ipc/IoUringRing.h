@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_IPC_IOURINGRING_H
+#define SQUID_SRC_IPC_IOURINGRING_H
+
+#if USE_IO_URING
+
+#include <cstddef>
+#include <cstdint>
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace Ipc
+{
+
+/// A memory-mapped io_uring(7) instance: the submission and completion queues
+/// that this process shares with the kernel. Users fill submission queue
+/// entries and consume completions; the meaning of both is up to them.
+class IoUringRing
+{
+public:
+    /// Creates a ring with (at least) the given number of submission queue
+    /// entries. Throws if the running kernel cannot give us a usable ring.
+    explicit IoUringRing(unsigned int entries);
+    ~IoUringRing();
+
+    IoUringRing(IoUringRing &&) = delete; // no copying or moving of any kind
+
+    /// the io_uring_setup(2) descriptor
+    int fd() const { return ringFd; }
+
+    /// IORING_FEAT_* flags reported by the kernel
+    uint32_t features() const { return features_; }
+
+    /// whether the kernel supports the given IORING_OP_* request type
+    bool supports(int opcode) const;
+
+    /// Reserves a blank submission queue entry for the caller to fill before
+    /// the next enter() or submit() call. Submits queued entries to make room
+    /// if needed. Throws if there is still no room.
+    io_uring_sqe &nextSqe();
+
+    /// the number of reserved entries not yet passed to the kernel
+    unsigned int unsubmitted() const { return unsubmitted_; }
+
+    /// A thin io_uring_enter(2) wrapper that submits all reserved entries
+    /// and waits as the flags and arguments say. \returns the system call
+    /// result (with errno set on failures)
+    int enter(unsigned int minComplete, unsigned int flags, const void *arg, size_t argSize);
+
+    /// passes all reserved entries to the kernel without waiting; throws on
+    /// io_uring_enter(2) failures other than EINTR
+    void submit();
+
+    /// whether the completion queue has entries we have not consumed yet
+    bool hasCompletions() const;
+
+    /// the oldest unconsumed completion; requires hasCompletions()
+    const io_uring_cqe &frontCompletion() const;
+
+    /// lets the kernel reuse the frontCompletion() slot
+    void popCompletion();
+
+    unsigned int submissionQueueSize() const { return sqEntries; }
+    unsigned int completionQueueSize() const { return cqEntries; }
+
+    uint64_t enterCalls = 0; ///< io_uring_enter(2) calls
+    uint64_t submitted = 0; ///< submission queue entries accepted by the kernel
+
+private:
+    void releaseResources();
+
+    int ringFd = -1; ///< io_uring_setup(2) result
+    uint32_t features_ = 0; ///< io_uring_params::features
+
+    void *ringArea = nullptr; ///< mmap(2)ed submission and completion rings
+    size_t ringAreaSize = 0; ///< ringArea size in bytes
+    void *sqesArea = nullptr; ///< mmap(2)ed submission queue entries
+    size_t sqesAreaSize = 0; ///< sqesArea size in bytes
+
+    /* submission queue */
+    unsigned *sqHead = nullptr;
+    unsigned *sqTail = nullptr;
+    unsigned *sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    io_uring_sqe *sqes = nullptr;
+    unsigned unsubmitted_ = 0; ///< reserved entries not yet seen by the kernel
+
+    /* completion queue */
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned cqMask = 0;
+    unsigned cqEntries = 0;
+    io_uring_cqe *cqes = nullptr;
+};
+
+} // namespace Ipc
+
+#endif /* USE_IO_URING */
+
+#endif /* SQUID_SRC_IPC_IOURINGRING_H */
@@ -35,10 +35,12 @@ Ipc::StartListening(int sock_type, int proto, const Comm::ConnectionPointer &lis
     auto &answer = callback.answer();
     answer.conn = listenConn;
 
-    const auto giveEachWorkerItsOwnQueue = listenConn->flags & COMM_REUSEPORT;
+    // Coordinator opens all CPU-steered queues in worker order
+    const auto steerByCpu = listenConn->flags & COMM_REUSEPORT_CPU;
+    const auto giveEachWorkerItsOwnQueue = (listenConn->flags & COMM_REUSEPORT) && !steerByCpu;
     if (!giveEachWorkerItsOwnQueue && UsingSmp()) {
         // Ask Coordinator for a listening socket.
-        // All askers share one listening queue.
+        // All askers share one listening queue (unless steerByCpu).
         OpenListenerParams p;
         p.sock_type = sock_type;
         p.proto = proto;
@@ -10,16 +10,21 @@
 
 #include "squid.h"
 #include "base/IoManip.h"
+#include "base/TextException.h"
 #include "ipc/StoreMap.h"
 #include "sbuf/SBuf.h"
+#include "sbuf/Stream.h"
 #include "SquidConfig.h"
 #include "StatCounters.h"
 #include "Store.h"
 #include "store/Controller.h"
 #include "store_key_md5.h"
+#include "time/gadgets.h"
 #include "tools.h"
 
+#include <algorithm>
 #include <chrono>
+#include <limits>
 
 static SBuf
 StoreMapSlicesId(const SBuf &path)
@@ -56,7 +61,8 @@ Ipc::StoreMap::StoreMap(const SBuf &aPath): cleaner(nullptr), path(aPath),
     fileNos(shm_old(FileNos)(StoreMapFileNosId(path).c_str())),
     anchors(shm_old(Anchors)(StoreMapAnchorsId(path).c_str())),
     slices(shm_old(Slices)(StoreMapSlicesId(path).c_str())),
-    hitValidation(true)
+    hitValidation(true),
+    policy(StoreMapPolicy::fifo)
 {
     debugs(54, 5, "attached " << path << " with " <<
            fileNos->capacity << '+' <<
@@ -107,15 +113,12 @@ Ipc::StoreMap::openOrCreateForReading(const cache_key *const key, sfileno &filen
            << " for reading " << path);
 
     // start with reading so that we do not overwrite an existing unlocked entry
-    auto idx = fileNoByKey(key);
-    if (const auto anchor = openForReadingAt(idx, key)) {
-        fileno = idx;
+    if (const auto anchor = openForReadingByKey(key, fileno))
         return anchor;
-    }
 
     // the competing openOrCreateForReading() workers race to create a new entry
-    idx = fileNoByKey(key);
-    if (auto anchor = openForWritingAt(idx)) {
+    sfileno idx = -1;
+    if (auto anchor = openForWritingByKey(key, idx)) {
         anchor->setKey(key);
         anchor->lock.switchExclusiveToShared();
         // race ended
@@ -127,11 +130,8 @@ Ipc::StoreMap::openOrCreateForReading(const cache_key *const key, sfileno &filen
 
     // we lost the above race; see if the winner-created entry is now readable
     // TODO: Do some useful housekeeping work here to give the winner more time.
-    idx = fileNoByKey(key);
-    if (const auto anchor = openForReadingAt(idx, key)) {
-        fileno = idx;
+    if (const auto anchor = openForReadingByKey(key, fileno))
         return anchor;
-    }
 
     // slow entry creator or some other problem
     return nullptr;
@@ -142,11 +142,57 @@ Ipc::StoreMap::openForWriting(const cache_key *const key, sfileno &fileno)
 {
     debugs(54, 5, "opening entry with key " << storeKeyText(key)
            << " for writing " << path);
-    const int idx = fileNoByKey(key);
+    return openForWritingByKey(key, fileno);
+}
 
-    if (Anchor *anchor = openForWritingAt(idx)) {
-        fileno = idx;
-        return anchor;
+/// openForWriting() implementation: picks and locks an anchor among those
+/// available to the given key
+Ipc::StoreMap::Anchor *
+Ipc::StoreMap::openForWritingByKey(const cache_key *const key, sfileno &fileno)
+{
+    // the old entry with the same key (if any) must be overwritten
+    // rather than duplicated at another key position
+    const auto keyName = nameWithKey(key);
+    if (keyName >= 0) {
+        const auto idx = fileNoByName(keyName);
+        if (const auto anchor = openForWritingAt(idx)) {
+            fileno = idx;
+            return anchor;
+        }
+        return nullptr;
+    }
+
+    // Prefer empty and doomed positions. Otherwise, evict the entry that was
+    // neither stored, updated, nor found by openForReading() for the longest
+    // time. Unlocked anchors may change while we are looking at them, so this
+    // order and the collision stats are approximate.
+    const auto occupied = [this](const sfileno idx) {
+        const auto &s = anchorAt(idx);
+        return !s.empty() && !s.waitingToBeFreed;
+    };
+    const auto evictionOrder = [this](const sfileno idx) {
+        const auto &s = anchorAt(idx);
+        return (s.empty() || s.waitingToBeFreed) ?
+               std::numeric_limits<time_t>::min() : std::max(s.basics.lastref, s.lastHit.load());
+    };
+
+    const auto wayCount = ways();
+    sfileno candidates[MaxWays];
+    for (int way = 0; way < wayCount; ++way)
+        candidates[way] = fileNoByKey(key, way);
+    std::stable_sort(candidates, candidates + wayCount, [&](const sfileno a, const sfileno b) {
+        return evictionOrder(a) < evictionOrder(b);
+    });
+
+    for (int i = 0; i < wayCount; ++i) {
+        const auto idx = candidates[i];
+        const auto evicting = occupied(idx);
+        if (const auto anchor = openForWritingAt(idx)) {
+            if (evicting)
+                ++stats_.collisionEvictions;
+            fileno = idx;
+            return anchor;
+        }
     }
 
     return nullptr;
@@ -327,36 +373,73 @@ Ipc::StoreMap::freeEntry(const sfileno fileno)
     return s.waitingToBeFreed.compare_exchange_strong(expected, true);
 }
 
+bool
+Ipc::StoreMap::freeEntry(const sfileno fileno, const cache_key *const key)
+{
+    debugs(54, 5, "marking entry " << fileno << " with key " << storeKeyText(key) <<
+           " to be freed in " << path);
+
+    Anchor &s = anchorAt(fileno);
+
+    if (s.lock.lockExclusive()) {
+        if (!s.sameKey(key)) {
+            s.lock.unlockExclusive();
+            return false; // do not free unrelated entries
+        }
+        const bool result = !s.waitingToBeFreed && !s.empty();
+        freeChain(fileno, s, false);
+        return result;
+    }
+
+    // we cannot be sure that the entry we found is ours because we do not
+    // have a lock on it, but we still check to minimize false deletions
+    if (!s.sameKey(key))
+        return false;
+
+    uint8_t expected = false;
+    // mark to free the locked entry later (if not already marked)
+    return s.waitingToBeFreed.compare_exchange_strong(expected, true);
+}
+
 void
 Ipc::StoreMap::freeEntryByKey(const cache_key *const key)
 {
     debugs(54, 5, "marking entry with key " << storeKeyText(key)
            << " to be freed in " << path);
 
-    const int idx = fileNoByKey(key);
-    Anchor &s = anchorAt(idx);
-    if (s.lock.lockExclusive()) {
-        if (s.sameKey(key))
-            freeChain(idx, s, true);
-        s.lock.unlockExclusive();
-    } else if (s.lock.lockShared()) {
-        if (s.sameKey(key))
-            s.waitingToBeFreed = true; // mark to free it later
-        s.lock.unlockShared();
-    } else {
-        // we cannot be sure that the entry we found is ours because we do not
-        // have a lock on it, but we still check to minimize false deletions
-        if (s.sameKey(key))
-            s.waitingToBeFreed = true; // mark to free it later
+    // racing writers may have stored the same key at several positions
+    for (int way = 0; way < ways(); ++way) {
+        const auto idx = fileNoByKey(key, way);
+        Anchor &s = anchorAt(idx);
+        if (!s.sameKey(key))
+            continue; // do not lock unrelated entries
+
+        if (s.lock.lockExclusive()) {
+            if (s.sameKey(key))
+                freeChain(idx, s, true);
+            s.lock.unlockExclusive();
+        } else if (s.lock.lockShared()) {
+            if (s.sameKey(key))
+                s.waitingToBeFreed = true; // mark to free it later
+            s.lock.unlockShared();
+        } else {
+            // we cannot be sure that the entry we found is ours because we do not
+            // have a lock on it, but we still check to minimize false deletions
+            if (s.sameKey(key))
+                s.waitingToBeFreed = true; // mark to free it later
+        }
     }
 }
 
 bool
 Ipc::StoreMap::markedForDeletion(const cache_key *const key)
 {
-    const int idx = fileNoByKey(key);
-    const Anchor &s = anchorAt(idx);
-    return s.sameKey(key) ? bool(s.waitingToBeFreed) : false;
+    for (int way = 0; way < ways(); ++way) {
+        const Anchor &s = anchorAt(fileNoByKey(key, way));
+        if (s.sameKey(key) && s.waitingToBeFreed)
+            return true;
+    }
+    return false;
 }
 
 bool
@@ -441,14 +524,37 @@ Ipc::StoreMap::openForReading(const cache_key *const key, sfileno &fileno)
 {
     debugs(54, 5, "opening entry with key " << storeKeyText(key)
            << " for reading " << path);
-    const int idx = fileNoByKey(key);
-    if (const auto anchor = openForReadingAt(idx, key)) {
-        fileno = idx;
+    ++stats_.lookups;
+    if (const auto anchor = openForReadingByKey(key, fileno)) {
+        ++stats_.hits;
+        // avoid dirtying a shared cache line when the bit is already set
+        if (policy == StoreMapPolicy::clock && !anchor->referenced)
+            anchor->referenced = true;
+        // and when the entry was already found during this second
+        if (anchor->lastHit.load(std::memory_order_relaxed) != squid_curtime)
+            anchor->lastHit.store(squid_curtime, std::memory_order_relaxed);
         return anchor; // locked for reading
     }
     return nullptr;
 }
 
+/// openForReading() without stats accounting
+const Ipc::StoreMap::Anchor *
+Ipc::StoreMap::openForReadingByKey(const cache_key *const key, sfileno &fileno)
+{
+    for (int way = 0; way < ways(); ++way) {
+        const auto idx = fileNoByKey(key, way);
+        // avoid locking anchors that (currently) store other keys
+        if (!anchorAt(idx).sameKey(key))
+            continue;
+        if (const auto anchor = openForReadingAt(idx, key)) {
+            fileno = idx;
+            return anchor; // locked for reading
+        }
+    }
+    return nullptr;
+}
+
 const Ipc::StoreMap::Anchor *
 Ipc::StoreMap::openForReadingAt(const sfileno fileno, const cache_key *const key)
 {
@@ -525,13 +631,22 @@ Ipc::StoreMap::openForUpdating(Update &update, const sfileno fileNoHint)
     Must(update.entry);
     const StoreEntry &entry = *update.entry;
     const cache_key *const key = reinterpret_cast<const cache_key*>(entry.key);
-    update.stale.name = nameByKey(key);
 
     if (!validEntry(fileNoHint)) {
         debugs(54, 5, "opening entry with key " << storeKeyText(key) <<
                " for updating " << path);
+        update.stale.name = nameWithKey(key);
+        if (update.stale.name < 0) {
+            debugs(54, 5, "cannot open missing entry for updating " << path);
+            return false;
+        }
         update.stale.fileNo = fileNoByName(update.stale.name);
     } else {
+        update.stale.name = nameOfFileNo(key, fileNoHint);
+        if (update.stale.name < 0) {
+            debugs(54, 5, "cannot open relocated entry " << fileNoHint << " for updating " << path);
+            return false;
+        }
         update.stale.fileNo = fileNoHint;
     }
 
@@ -701,9 +816,17 @@ Ipc::StoreMap::visitVictims(const NameFilter visitor)
 bool
 Ipc::StoreMap::purgeOne()
 {
+    // With CLOCK, give referenced entries a second chance, but stop doing that
+    // half way through the search so that a busy index still yields a victim.
+    auto secondChances = (policy == StoreMapPolicy::clock) ? min(10000, entryLimit())/2 : 0;
     return visitVictims([&](const sfileno name) {
         const sfileno fileno = fileNoByName(name);
         Anchor &s = anchorAt(fileno);
+        if (secondChances > 0 && s.referenced) {
+            --secondChances;
+            s.referenced = false;
+            return false;
+        }
         if (s.lock.lockExclusive()) {
             // the caller wants a free slice; empty anchor is not enough
             if (!s.empty() && s.start >= 0) {
@@ -754,6 +877,14 @@ Ipc::StoreMap::updateStats(ReadWriteLockStats &stats) const
         anchorAt(i).lock.updateStats(stats);
 }
 
+void
+Ipc::StoreMap::updateStats(StoreMapStats &stats) const
+{
+    stats.lookups += stats_.lookups;
+    stats.hits += stats_.hits;
+    stats.collisionEvictions += stats_.collisionEvictions;
+}
+
 bool
 Ipc::StoreMap::validEntry(const int pos) const
 {
@@ -880,14 +1011,68 @@ Ipc::StoreMap::anchorAt(const sfileno fileno) const
     return const_cast<StoreMap&>(*this).anchorAt(fileno);
 }
 
+Ipc::StoreMapPolicy
+Ipc::StoreMap::ParsePolicy(const SBuf &name)
+{
+    if (name.cmp("fifo") == 0)
+        return StoreMapPolicy::fifo;
+    if (name.cmp("clock") == 0)
+        return StoreMapPolicy::clock;
+    throw TextException(ToSBuf("unsupported shared cache replacement policy: ", name,
+                               "; supported policies: fifo, clock"), Here());
+}
+
+const char *
+Ipc::StoreMap::PolicyName(const StoreMapPolicy aPolicy)
+{
+    switch (aPolicy) {
+    case StoreMapPolicy::fifo:
+        return "fifo";
+    case StoreMapPolicy::clock:
+        return "clock";
+    }
+    return "fifo"; // not reached
+}
+
+int
+Ipc::StoreMap::ways() const
+{
+    return min(MaxWays, entryLimit());
+}
+
 sfileno
-Ipc::StoreMap::nameByKey(const cache_key *const key) const
+Ipc::StoreMap::nameByKey(const cache_key *const key, const int way) const
 {
     assert(key);
+    assert(0 <= way && way < ways());
     const uint64_t *const k = reinterpret_cast<const uint64_t *>(key);
-    // TODO: use a better hash function
-    const int hash = (k[0] + k[1]) % entryLimit();
-    return hash;
+    // Fibonacci-multiply one half so that (x,y) and (y,x) keys do not collide
+    // and keys sharing a half are spread across the whole index
+    const uint64_t hash = k[0] ^ (k[1] * 0x9E3779B97F4A7C15ULL);
+    const uint64_t limit = entryLimit();
+    return static_cast<sfileno>((hash % limit + way) % limit);
+}
+
+sfileno
+Ipc::StoreMap::nameWithKey(const cache_key *const key) const
+{
+    for (int way = 0; way < ways(); ++way) {
+        const auto name = nameByKey(key, way);
+        if (anchorAt(fileNoByName(name)).sameKey(key))
+            return name;
+    }
+    return -1;
+}
+
+sfileno
+Ipc::StoreMap::nameOfFileNo(const cache_key *const key, const sfileno fileno) const
+{
+    for (int way = 0; way < ways(); ++way) {
+        const auto name = nameByKey(key, way);
+        if (fileNoByName(name) == fileno)
+            return name;
+    }
+    return -1;
 }
 
 sfileno
@@ -911,8 +1096,21 @@ Ipc::StoreMap::relocate(const sfileno name, const sfileno fileno)
 sfileno
 Ipc::StoreMap::fileNoByKey(const cache_key *const key) const
 {
-    const int name = nameByKey(key);
-    return fileNoByName(name);
+    const auto name = nameWithKey(key);
+    return fileNoByName(name >= 0 ? name : nameByKey(key, 0));
+}
+
+sfileno
+Ipc::StoreMap::fileNoWithKey(const cache_key *const key) const
+{
+    const auto name = nameWithKey(key);
+    return name >= 0 ? fileNoByName(name) : -1;
+}
+
+sfileno
+Ipc::StoreMap::fileNoByKey(const cache_key *const key, const int way) const
+{
+    return fileNoByName(nameByKey(key, way));
 }
 
 Ipc::StoreMap::Anchor &
@@ -936,7 +1134,7 @@ Ipc::StoreMap::sliceAt(const SliceId sliceId) const
 
 /* Ipc::StoreMapAnchor */
 
-Ipc::StoreMapAnchor::StoreMapAnchor(): start(0), splicingPoint(-1)
+Ipc::StoreMapAnchor::StoreMapAnchor(): lastHit(0), start(0), splicingPoint(-1)
 {
     // keep in sync with rewind()
 }
@@ -1009,9 +1207,24 @@ Ipc::StoreMapAnchor::rewind()
     basics.clear();
     waitingToBeFreed = false;
     writerHalted = false;
+    referenced = false;
+    lastHit = 0;
     // but keep the lock
 }
 
+/* Ipc::StoreMapStats */
+
+void
+Ipc::StoreMapStats::dump(StoreEntry &e) const
+{
+    storeAppendPrintf(&e, "Key lookups:     %9" PRIu64 "\n", lookups);
+    if (lookups) {
+        storeAppendPrintf(&e, "Key hits:        %9" PRIu64 " %6.2f%%\n",
+                          hits, (100.0 * hits / lookups));
+    }
+    storeAppendPrintf(&e, "Collision evictions: %9" PRIu64 "\n", collisionEvictions);
+}
+
 /* Ipc::StoreMapUpdate */
 
 Ipc::StoreMapUpdate::StoreMapUpdate(StoreEntry *anEntry):
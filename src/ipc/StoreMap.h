@@ -9,6 +9,7 @@
 #ifndef SQUID_SRC_IPC_STOREMAP_H
 #define SQUID_SRC_IPC_STOREMAP_H
 
+#include "ipc/forward.h"
 #include "ipc/mem/FlexibleArray.h"
 #include "ipc/mem/Pointer.h"
 #include "ipc/ReadWriteLock.h"
@@ -81,6 +82,13 @@ public:
     std::atomic<uint8_t> waitingToBeFreed; ///< may be accessed w/o a lock
     /// whether StoreMap::abortWriting() was called for a read-locked entry
     std::atomic<uint8_t> writerHalted;
+    /// whether the entry was read since the last StoreMapPolicy::clock sweep;
+    /// may be accessed w/o a lock
+    mutable std::atomic<uint8_t> referenced;
+    /// the last time StoreMap::openForReading() found this entry (or zero);
+    /// orders eviction candidates together with basics.lastref, which only
+    /// changes when the entry is stored or updated; may be accessed w/o a lock
+    mutable std::atomic<time_t> lastHit;
 
     // fields marked with [app] can be modified when appending-while-reading
     // fields marked with [update] can be modified when updating-while-reading
@@ -169,6 +177,7 @@ public:
 
     std::atomic<int32_t> count; ///< current number of entries
     std::atomic<uint32_t> victim; ///< starting point for purge search
+
     const int capacity; ///< total number of anchors
     Ipc::Mem::FlexibleArray<StoreMapAnchor> items; ///< anchors storage
 };
@@ -209,12 +218,28 @@ public:
     Edition fresh; ///< new anchor and the updated chain prefix
 };
 
+/// key lookup and placement stats of a StoreMap, collected by each process
+/// separately to keep shared memory cache lines clean
+class StoreMapStats
+{
+public:
+    void dump(StoreEntry &e) const;
+
+    uint64_t lookups = 0; ///< openForReading() attempts by key
+    uint64_t hits = 0; ///< successful openForReading() attempts by key
+    uint64_t collisionEvictions = 0; ///< entries purged to store another key
+};
+
 class StoreMapCleaner;
 
 /// Manages shared Store index (e.g., locking/unlocking/freeing entries) using
 /// StoreMapFileNos indexed by hashed entry keys (a.k.a. entry names),
 /// StoreMapAnchors indexed by fileno, and
 /// StoreMapSlices indexed by slice ID.
+///
+/// The index is set-associative: An entry key may be stored at any of the
+/// ways() consecutive names starting at the key hash. Colliding keys occupy
+/// different names of the same set instead of evicting each other.
 class StoreMap
 {
 public:
@@ -247,16 +272,33 @@ public:
 
     StoreMap(const SBuf &aPath);
 
-    /// computes map entry anchor position for a given entry key
+    /// the maximum number of names (i.e. anchor positions) an entry key may use
+    static constexpr int MaxWays = 8;
+
+    /// computes map entry anchor position for a given entry key: the position
+    /// of an anchor with that key (if any) or the first position of the key set
+    /// The result is approximate unless the caller holds a lock on the anchor.
     sfileno fileNoByKey(const cache_key *const key) const;
 
+    /// the anchor position of an entry with the given key or -1 if there is no
+    /// such entry; the result is approximate unless the caller holds a lock
+    sfileno fileNoWithKey(const cache_key *const key) const;
+
+    /// the anchor position `way` within the set of positions available to the
+    /// given entry key; 0 <= way < ways()
+    sfileno fileNoByKey(const cache_key *const key, const int way) const;
+
+    /// the number of anchor positions available to each entry key
+    int ways() const;
+
     /// Like strcmp(mapped, new), but for store entry versions/timestamps.
     /// Returns +2 if the mapped entry does not exist; -1/0/+1 otherwise.
     /// Comparison may be inaccurate unless the caller is a lock holder.
     int compareVersions(const sfileno oldFileno, time_t newVersion) const;
 
     /// finds, locks, and returns an anchor for an empty key position,
-    /// erasing the old entry (if any)
+    /// erasing the old entry with the same key (if any) or, if all key
+    /// positions are occupied, the least recently referenced entry
     Anchor *openForWriting(const cache_key *const key, sfileno &fileno);
     /// locks and returns an anchor for the empty fileno position; if
     /// overwriteExisting is false and the position is not empty, returns nil
@@ -293,6 +335,10 @@ public:
     /// free the entry if possible or mark it as waiting to be freed if not
     /// \returns whether the entry was neither empty nor marked
     bool freeEntry(const sfileno);
+    /// freeEntry() but only if the entry at the given position has the given
+    /// key; the key check is approximate if we cannot lock the entry
+    /// \returns whether the keyed entry was neither empty nor marked
+    bool freeEntry(const sfileno, const cache_key *const key);
     /// free the entry if possible or mark it as waiting to be freed if not
     /// does nothing if we cannot check that the key matches the cached entry
     void freeEntryByKey(const cache_key *const key);
@@ -345,6 +391,15 @@ public:
 
     void disableHitValidation() { hitValidation = false; }
 
+    /// configures how purgeOne() selects its victims
+    void replacementPolicy(const StoreMapPolicy aPolicy) { policy = aPolicy; }
+
+    /// \returns the StoreMapPolicy named by the given configuration token
+    /// \throws TextException for unknown policy names
+    static StoreMapPolicy ParsePolicy(const SBuf &name);
+    /// \returns the configuration token naming the given policy
+    static const char *PolicyName(const StoreMapPolicy);
+
     /// copies slice to its designated position
     void importSlice(const SliceId sliceId, const Slice &slice);
 
@@ -357,6 +412,8 @@ public:
 
     /// adds approximate current stats to the supplied ones
     void updateStats(ReadWriteLockStats &stats) const;
+    /// adds key lookup stats of this process to the supplied ones
+    void updateStats(StoreMapStats &stats) const;
 
     StoreMapCleaner *cleaner; ///< notified before a readable entry is freed
 
@@ -367,8 +424,13 @@ protected:
     Mem::Pointer<StoreMapSlices> slices; ///< chained entry pieces positions
 
 private:
-    /// computes entry name (i.e., key hash) for a given entry key
-    sfileno nameByKey(const cache_key *const key) const;
+    /// computes entry name (i.e., key hash) for a given entry key and way
+    sfileno nameByKey(const cache_key *const key, const int way) const;
+    /// the name of a (possibly) keyed anchor or -1; the result is
+    /// approximate unless the caller holds a lock on the anchor
+    sfileno nameWithKey(const cache_key *const key) const;
+    /// the name of the given anchor position within the key set or -1
+    sfileno nameOfFileNo(const cache_key *const key, const sfileno fileno) const;
     /// computes anchor position for a given entry name
     sfileno fileNoByName(const sfileno name) const;
     void relocate(const sfileno name, const sfileno fileno);
@@ -380,6 +442,8 @@ private:
     Slice &sliceAt(const SliceId sliceId);
     const Slice &sliceAt(const SliceId sliceId) const;
     Anchor *openForReading(Slice &s);
+    const Anchor *openForReadingByKey(const cache_key *const key, sfileno &fileno);
+    Anchor *openForWritingByKey(const cache_key *const key, sfileno &fileno);
     bool openKeyless(Update::Edition &edition);
     void closeForUpdateFinal(Update &update);
 
@@ -391,6 +455,12 @@ private:
 
     /// whether paranoid_hit_validation should be performed
     bool hitValidation;
+
+    /// how purgeOne() selects its victims
+    StoreMapPolicy policy;
+
+    /// key lookups and evictions by this process
+    StoreMapStats stats_;
 };
 
 /// API for adjusting external state when dirty map slice is being freed
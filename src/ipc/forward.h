@@ -24,6 +24,12 @@ class StrandCoord;
 class StrandMessage;
 class TypedMsgHdr;
 
+/// how a shared Store index selects entries to purge
+enum class StoreMapPolicy {
+    fifo, ///< purge entries in index order, ignoring their popularity
+    clock ///< give recently read entries a second chance (CLOCK algorithm)
+};
+
 } // namespace Ipc
 
 #endif /* SQUID_SRC_IPC_FORWARD_H */
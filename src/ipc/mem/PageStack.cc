@@ -265,9 +265,10 @@ Ipc::Mem::IdSet::innerPush(const Position pos, const NavigationDirection dir)
 }
 
 /// accounts for future ID removal from a subtree of the given position
+/// \param preferred the direction to take if its subtree has any IDs
 /// \returns the direction of the subtree chosen to relinquish the ID
 Ipc::Mem::IdSet::NavigationDirection
-Ipc::Mem::IdSet::innerPop(const Position pos)
+Ipc::Mem::IdSet::innerPop(const Position pos, const NavigationDirection preferred)
 {
     NavigationDirection direction = dirNone;
 
@@ -276,7 +277,7 @@ Ipc::Mem::IdSet::innerPop(const Position pos)
     IdSetInnerNode newValue;
     do {
         newValue = IdSetInnerNode::Unpack(oldValue);
-        if (newValue.left) {
+        if (newValue.left && (preferred == dirLeft || !newValue.right)) {
             --newValue.left;
             direction = dirLeft;
         } else if (newValue.right) {
@@ -315,20 +316,37 @@ int trailingZeros(uint64_t x)
     return count;
 }
 
+/// a temporary C++20 countl_zero() replacement
+static inline
+int leadingZeros(uint64_t x)
+{
+    if (!x)
+        return 64;
+    int count = 0;
+    for (uint64_t mask = uint64_t(1) << 63; !(x & mask); mask >>= 1)
+        ++count;
+    return count;
+}
+
 /// extracts and returns an ID from the leaf node at the given position
+/// \param preferredBit the leaf bit to extract if it is set; otherwise, we
+/// extract the lowest set bit above it or, if there are none, the highest one
 Ipc::Mem::IdSet::size_type
-Ipc::Mem::IdSet::leafPop(const Position pos)
+Ipc::Mem::IdSet::leafPop(const Position pos, const size_type preferredBit)
 {
+    assert(preferredBit < BitsPerLeaf);
     auto &node = nodeAt(pos);
     auto oldValue = node.load();
     Node newValue;
+    int bit = 0;
     do {
         assert(oldValue > 0);
-        const auto mask = oldValue - 1; // flips the rightmost 1 and trailing 0s
-        newValue = oldValue & mask; // clears the rightmost 1
+        const auto above = oldValue & (~Node(0) << preferredBit);
+        bit = above ? trailingZeros(above) : (BitsPerLeaf - 1 - leadingZeros(oldValue));
+        newValue = oldValue & ~(Node(1) << bit);
     } while (!node.compare_exchange_weak(oldValue, newValue));
 
-    return pos.offset*BitsPerLeaf + trailingZeros(oldValue);
+    return pos.offset*BitsPerLeaf + bit;
 }
 
 /// \returns the position of a parent node of the node at the given position
@@ -384,20 +402,39 @@ Ipc::Mem::IdSet::valueAddress(const Position pos)
 }
 
 bool
-Ipc::Mem::IdSet::pop(size_type &id)
-{
+Ipc::Mem::IdSet::pop(size_type &id, const size_type preferred)
+{
+    // While on the path to the leaf with the preferred ID, we descend towards
+    // that leaf. Once a subtree on that path runs out of IDs, we stray into
+    // its sibling and then stay as close to the preferred leaf as we can.
+    const auto preferredLeaf = preferred / BitsPerLeaf;
+    auto strayed = dirNone; // which side of the preferred leaf we ended up on
+    const auto towardsPreferred = [&](const size_type level) {
+        if (strayed != dirNone)
+            return strayed == dirLeft ? dirRight : dirLeft;
+        const auto levelsBelow = measurements.innerLevelCount - 1 - level;
+        return ((preferredLeaf >> levelsBelow) & 1) ? dirRight : dirLeft;
+    };
+    const auto descendFrom = [&](const Position pos, const size_type level, const NavigationDirection direction) {
+        if (strayed == dirNone && direction != towardsPreferred(level))
+            strayed = direction;
+        return descend(pos, direction);
+    };
+
     Position rootPos;
-    const auto directionFromRoot = innerPop(rootPos);
+    const auto directionFromRoot = innerPop(rootPos, towardsPreferred(0));
     if (directionFromRoot == dirEnd)
         return false; // an empty tree
 
-    auto pos = descend(rootPos, directionFromRoot);
-    for (size_t level = 1; level < measurements.innerLevelCount; ++level) {
-        const auto direction = innerPop(pos);
-        pos = descend(pos, direction);
+    auto pos = descendFrom(rootPos, 0, directionFromRoot);
+    for (size_type level = 1; level < measurements.innerLevelCount; ++level) {
+        const auto direction = innerPop(pos, towardsPreferred(level));
+        pos = descendFrom(pos, level, direction);
     }
 
-    id = leafPop(pos);
+    const auto preferredBit = strayed == dirNone ? preferred % BitsPerLeaf :
+                              strayed == dirLeft ? BitsPerLeaf - 1 : 0;
+    id = leafPop(pos, preferredBit);
     return true;
 }
 
@@ -439,15 +476,17 @@ Ipc::Mem::PageStack::PageStack(const Config &config):
 }
 
 bool
-Ipc::Mem::PageStack::pop(PageId &page)
+Ipc::Mem::PageStack::pop(PageId &page, const uint32_t preferredNumber)
 {
     assert(!page);
 
     if (!config_.capacity)
         return false;
 
+    // treat out-of-range preferences as the default preference
+    const auto preferredIndex = (preferredNumber && preferredNumber <= config_.capacity) ? preferredNumber - 1 : 0;
     IdSet::size_type pageIndex = 0;
-    if (!ids_.pop(pageIndex))
+    if (!ids_.pop(pageIndex, preferredIndex))
         return false;
 
     // must decrement after removing the page to avoid underflow
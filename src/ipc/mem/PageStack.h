@@ -66,9 +66,10 @@ public:
     /// optimized to run without atomic protection
     void makeFullBeforeSharing();
 
-    /// finds/extracts (into the given `id`) an ID value and returns true
+    /// finds/extracts (into the given `id`) an ID value and returns true;
+    /// prefers the `preferred` ID and then IDs close to (preferably above) it
     /// \retval false no IDs are left
-    bool pop(size_type &id);
+    bool pop(size_type &id, size_type preferred = 0);
 
     /// makes `id` value available to future pop() callers
     void push(size_type id);
@@ -87,10 +88,10 @@ private:
     void leafTruncate(Position pos, size_type idsToKeep);
 
     void innerPush(Position, NavigationDirection);
-    NavigationDirection innerPop(Position);
+    NavigationDirection innerPop(Position, NavigationDirection preferred);
 
     void leafPush(Position, size_type id);
-    size_type leafPop(Position);
+    size_type leafPop(Position, size_type preferredBit);
 
     Position ascend(Position);
     Position descend(Position, NavigationDirection);
@@ -137,8 +138,10 @@ public:
     /// an approximate number of free pages
     PageCount size() const { return size_.load(); }
 
-    /// sets value and returns true unless no free page numbers are found
-    bool pop(PageId &page);
+    /// sets value and returns true unless no free page numbers are found;
+    /// prefers the given page number and then the nearest free page numbers
+    /// (e.g., to keep related pages together); by default, prefers the lowest
+    bool pop(PageId &page, uint32_t preferredNumber = 1);
     /// makes value available as a free page number to future pop() callers
     void push(PageId &page);
 
@@ -15,6 +15,7 @@
 #include "debug/Messages.h"
 #include "dlink.h"
 #include "dns/LookupDetails.h"
+#include "dns/SharedCache.h"
 #include "dns/rfc3596.h"
 #include "event.h"
 #include "ip/Address.h"
@@ -138,6 +139,9 @@ public:
     hash_link hash;     /* must be first */
     time_t lastref;
     time_t expires;
+    time_t created; ///< when this entry was created (for prefetch decisions)
+    time_t refreshFailed = 0; ///< when the last background refresh failed
+    int hits = 0; ///< the number of positive cache hits on this entry
     ipcache_addrs addrs;
     IpCacheLookupForwarder handler;
     char *error_message;
@@ -145,10 +149,12 @@ public:
     dlink_node lru;
     unsigned short locks;
     struct Flags {
-        Flags() : negcached(false), fromhosts(false) {}
+        Flags() : negcached(false), fromhosts(false), refreshing(false), refresh(false) {}
 
         bool negcached;
         bool fromhosts;
+        bool refreshing; ///< a background lookup is replacing this entry
+        bool refresh; ///< this entry is the result of a background lookup
     } flags;
 
     bool sawCname = false;
@@ -184,6 +190,11 @@ static struct _ipcache_stats {
     int rr_cname;
     int cname_only;
     int invalid;
+    int shared_hits;
+    int stale_hits;
+    int prefetches;
+    int refreshes;
+    int refresh_failures;
 } IpcacheStats;
 
 /// \ingroup IPCacheInternal
@@ -195,6 +206,7 @@ static void stat_ipcache_get(StoreEntry *);
 static FREE ipcacheFreeEntry;
 static IDNSCB ipcacheHandleReply;
 static int ipcacheExpiredEntry(ipcache_entry *);
+static bool ipcacheStaleEntry(const ipcache_entry &);
 static ipcache_entry *ipcache_get(const char *);
 static void ipcacheLockEntry(ipcache_entry *);
 static void ipcacheStatPrint(ipcache_entry *, StoreEntry *);
@@ -345,9 +357,46 @@ ipcacheExpiredEntry(ipcache_entry * i)
     if (i->expires > squid_curtime)
         return 0;
 
+    if (ipcacheStaleEntry(*i))
+        return 0; // still usable while being refreshed
+
     return 1;
 }
 
+/// \ingroup IPCacheInternal
+/// whether the entry has expired but may be used under ipcache_stale_ttl
+static bool
+ipcacheStaleEntry(const ipcache_entry &i)
+{
+    if (i.flags.fromhosts || i.flags.negcached || i.addrs.empty())
+        return false;
+
+    return i.expires <= squid_curtime && squid_curtime < i.expires + Config.ipcache.staleTtl;
+}
+
+/// \ingroup IPCacheInternal
+/// whether a fresh entry is used close enough to its expiration to be
+/// refreshed under ipcache_prefetch
+static bool
+ipcacheShouldPrefetch(const ipcache_entry &i)
+{
+    if (Config.ipcache.prefetch <= 0)
+        return false;
+
+    if (i.flags.fromhosts || i.flags.negcached || i.addrs.empty())
+        return false;
+
+    if (i.expires <= squid_curtime)
+        return false;
+
+    if (i.hits < Config.ipcache.prefetchMinHits)
+        return false; // not popular enough to be worth a background lookup
+
+    const auto lifetime = i.expires - i.created;
+    const auto remaining = i.expires - squid_curtime;
+    return remaining * 100 <= lifetime * Config.ipcache.prefetch;
+}
+
 /// \ingroup IPCacheAPI
 void
 ipcache_purgelru(void *)
@@ -409,6 +458,7 @@ purge_entries_fromhosts(void)
 ipcache_entry::ipcache_entry(const char *aName):
     lastref(0),
     expires(0),
+    created(squid_curtime),
     error_message(nullptr),
     locks(0) // XXX: use Lock type ?
 {
@@ -462,6 +512,112 @@ ipcache_entry::latestError(const char *text)
     error_message = xstrdup(text);
 }
 
+/// \ingroup IPCacheInternal
+/// makes a fresh DNS lookup result available to other SMP workers
+static void
+ipcacheShare(const ipcache_entry &i)
+{
+    const auto cache = Dns::SharedIpCache();
+    if (!cache)
+        return;
+
+    Dns::SharedCache::Entry entry;
+    entry.expires = i.expires;
+    if (i.flags.negcached) {
+        entry.setError(i.error_message);
+    } else {
+        for (const auto &cachedIp: i.addrs.raw()) {
+            struct in6_addr address;
+            cachedIp.ip.getInAddr(address);
+            if (!entry.append(&address, sizeof(address))) {
+                debugs(14, 5, "too many IPs to share: " << i.name());
+                return;
+            }
+        }
+    }
+    cache->put(i.name(), entry);
+}
+
+/// \ingroup IPCacheInternal
+/// \returns a new cached entry for a fresh lookup result shared by another
+/// SMP worker or nil if there is no such result
+static ipcache_entry *
+ipcacheGetShared(const char *name)
+{
+    const auto cache = Dns::SharedIpCache();
+    if (!cache)
+        return nullptr;
+
+    Dns::SharedCache::Entry entry;
+    if (!cache->get(name, entry))
+        return nullptr;
+
+    const auto i = new ipcache_entry(name);
+    i->expires = entry.expires;
+    if (entry.negative) {
+        i->flags.negcached = true;
+        i->error_message = xstrdup(entry.error());
+    } else {
+        for (size_t offset = 0; offset + sizeof(struct in6_addr) <= entry.size; offset += sizeof(struct in6_addr)) {
+            struct in6_addr address;
+            memcpy(&address, entry.data + offset, sizeof(address));
+            i->addrs.pushUnique(Ip::Address(address));
+        }
+    }
+
+    debugs(14, 4, "shared " << i->name() << ": " << i->addrs);
+    ++IpcacheStats.shared_hits;
+    ipcacheAddEntry(i);
+    return i;
+}
+
+/// \ingroup IPCacheInternal
+/// starts a background DNS lookup for the given refreshing entry
+static void
+ipcacheStartRefresh(void *data)
+{
+    const auto fresh = static_cast<ipcache_entry*>(data);
+    debugs(14, 4, fresh->name());
+    fresh->handler.lookupsStarting();
+    idnsALookup(hashKeyStr(&fresh->hash), ipcacheHandleReply, fresh);
+}
+
+/// \ingroup IPCacheInternal
+/// refreshes a stale or soon-to-expire entry unless that is already happening
+static void
+ipcacheRefresh(ipcache_entry &i)
+{
+    if (i.flags.refreshing)
+        return;
+
+    if (i.refreshFailed && squid_curtime - i.refreshFailed < Config.negativeDnsTtl)
+        return; // do not hammer nameservers that just failed us
+
+    ++IpcacheStats.refreshes;
+    i.flags.refreshing = true;
+    const auto fresh = new ipcache_entry(i.name());
+    fresh->flags.refresh = true;
+    // do not start the lookup now: a synchronous lookup answer would
+    // replace the entry that our caller is still using
+    eventAdd("ipcacheStartRefresh", ipcacheStartRefresh, fresh, 0.0, 0);
+}
+
+/// \ingroup IPCacheInternal
+/// refreshes a successfully looked up entry if it is stale or soon will be
+static void
+ipcacheRefreshIfNeeded(ipcache_entry &i)
+{
+    if (ipcacheStaleEntry(i)) {
+        debugs(14, 4, "stale " << i.name());
+        ++IpcacheStats.stale_hits;
+        ipcacheRefresh(i);
+    } else if (ipcacheShouldPrefetch(i)) {
+        debugs(14, 4, "prefetching " << i.name());
+        ++IpcacheStats.prefetches;
+        ipcacheRefresh(i);
+    }
+}
+
 static void
 ipcacheParse(ipcache_entry *i, const rfc1035_rr * answers, int nr, const char *error_message)
 {
@@ -584,8 +740,21 @@ ipcacheHandleReply(void *data, const rfc1035_rr * answers, int na, const char *e
         }
     }
 
+    if (i->flags.refresh && i->flags.negcached) {
+        // RFC 8767: keep using the stale entry (if any) instead of this error
+        if (const auto stale = ipcache_get(i->name())) {
+            debugs(14, 3, "keeping " << stale->name() << " after refresh error: " << i->error_message);
+            ++IpcacheStats.refresh_failures;
+            stale->flags.refreshing = false;
+            stale->refreshFailed = squid_curtime;
+            delete i;
+            return;
+        }
+    }
+
     debugs(14, 3, "done with " << i->name() << ": " << i->addrs);
     ipcacheAddEntry(i);
+    ipcacheShare(*i);
     ipcacheCallback(i, false, age);
 }
 
@@ -648,19 +817,25 @@ ipcache_nbgethostbyname_(const char *name, IpCacheLookupForwarder handler)
 
     if (nullptr == i) {
         /* miss */
-        (void) 0;
+        i = ipcacheGetShared(name);
     } else if (ipcacheExpiredEntry(i)) {
         /* hit, but expired -- bummer */
         ipcacheRelease(i);
-        i = nullptr;
-    } else {
+        i = ipcacheGetShared(name);
+    }
+
+    if (i) {
         /* hit */
         debugs(14, 4, "ipcache_nbgethostbyname: HIT for '" << name << "'");
 
         if (i->flags.negcached)
             ++IpcacheStats.negative_hits;
-        else
+        else {
             ++IpcacheStats.hits;
+            ++i->hits;
+        }
+
+        ipcacheRefreshIfNeeded(*i);
 
         i->handler = std::move(handler);
         ipcacheCallback(i, true, -1); // no lookup
@@ -735,17 +910,23 @@ ipcache_gethostbyname(const char *name, int flags)
     i = ipcache_get(name);
 
     if (nullptr == i) {
-        (void) 0;
+        i = ipcacheGetShared(name);
     } else if (ipcacheExpiredEntry(i)) {
         ipcacheRelease(i);
-        i = nullptr;
+        i = ipcacheGetShared(name);
+    }
+
+    if (nullptr == i) {
+        (void) 0;
     } else if (i->flags.negcached) {
         ++IpcacheStats.negative_hits;
         // ignore i->error_message: the caller just checks IP cache presence
         return nullptr;
     } else {
         ++IpcacheStats.hits;
+        ++i->hits;
         i->lastref = squid_curtime;
+        ipcacheRefreshIfNeeded(*i);
         // ignore i->error_message: the caller just checks IP cache presence
         return &i->addrs;
     }
@@ -845,6 +1026,22 @@ stat_ipcache_get(StoreEntry * sentry)
                       IpcacheStats.cname_only);
     storeAppendPrintf(sentry, "IPcache Invalid Request: %d\n",
                       IpcacheStats.invalid);
+    if (const auto cache = Dns::SharedIpCache()) {
+        storeAppendPrintf(sentry, "IPcache Shared Hits:     %d\n",
+                          IpcacheStats.shared_hits);
+        storeAppendPrintf(sentry, "IPcache Shared Entries Limit: %d\n",
+                          cache->limit());
+    }
+    if (Config.ipcache.staleTtl > 0 || Config.ipcache.prefetch > 0) {
+        storeAppendPrintf(sentry, "IPcache Stale Hits:      %d\n",
+                          IpcacheStats.stale_hits);
+        storeAppendPrintf(sentry, "IPcache Prefetches:      %d\n",
+                          IpcacheStats.prefetches);
+        storeAppendPrintf(sentry, "IPcache Background Refreshes: %d\n",
+                          IpcacheStats.refreshes);
+        storeAppendPrintf(sentry, "IPcache Failed Refreshes: %d\n",
+                          IpcacheStats.refresh_failures);
+    }
     storeAppendPrintf(sentry, "\n\n");
     storeAppendPrintf(sentry, "IP Cache Contents:\n\n");
     storeAppendPrintf(sentry, " %-31.31s %3s %6s %6s  %4s\n",
@@ -869,7 +1066,8 @@ ipcacheInvalidate(const char *name)
     if ((i = ipcache_get(name)) == nullptr)
         return;
 
-    i->expires = squid_curtime;
+    // do not serve purged entries stale
+    i->expires = squid_curtime - Config.ipcache.staleTtl;
 
     /*
      * NOTE, don't call ipcacheRelease here because we might be here due
@@ -1377,10 +1377,14 @@ RegisterModules()
     CallRunnerRegistrator(MemStoreRr);
     CallRunnerRegistrator(PeerPoolMgrsRr);
     CallRunnerRegistrator(PeerSourceHashRr);
+    CallRunnerRegistrator(RefreshRr);
+    CallRunnerRegistrator(RegexAclsRr);
+    CallRunnerRegistrator(RegexSetRr);
     CallRunnerRegistrator(SharedMemPagesRr);
     CallRunnerRegistrator(SharedSessionCacheRr);
     CallRunnerRegistrator(TransientsRr);
     CallRunnerRegistratorIn(Dns, ConfigRr);
+    CallRunnerRegistratorIn(Dns, SharedCacheRr);
 
 #if HAVE_DISKIO_MODULE_IPCIO
     CallRunnerRegistrator(IpcIoRr);
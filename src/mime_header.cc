@@ -16,51 +16,31 @@
 size_t
 headersEnd(const char *mime, size_t l, bool &containsObsFold)
 {
-    size_t e = 0;
-    int state = 1;
     containsObsFold = false;
 
-    while (e < l && state < 3) {
-        switch (state) {
-
-        case 0:
-
-            if ('\n' == mime[e])
-                state = 1;
-
-            break;
-
-        case 1:
-            if ('\r' == mime[e])
-                state = 2;
-            else if ('\n' == mime[e])
-                state = 3;
-            else if (' ' == mime[e] || '\t' == mime[e]) {
-                containsObsFold = true;
-                state = 0;
-            } else
-                state = 0;
-
-            break;
-
-        case 2:
-            if ('\n' == mime[e])
-                state = 3;
-            else
-                state = 0;
-
-            break;
-
-        default:
-            break;
+    const auto end = mime + l;
+    auto line = mime;
+    while (line < end) {
+        // an empty line terminates the block
+        if (*line == '\n')
+            return line + 1 - mime;
+
+        if (*line == '\r') {
+            if (line + 1 == end)
+                return 0; // need more data
+            if (line[1] == '\n')
+                return line + 2 - mime;
+        } else if (*line == ' ' || *line == '\t') {
+            containsObsFold = true;
         }
 
-        ++e;
+        // skip the rest of a non-empty line; memchr(3) is usually vectorized
+        const auto lf = static_cast<const char *>(memchr(line, '\n', end - line));
+        if (!lf)
+            return 0;
+        line = lf + 1;
     }
 
-    if (3 == state)
-        return e;
-
     return 0;
 }
 
@@ -14,6 +14,8 @@
 
 #include "squid.h"
 #include "base/PackableStream.h"
+#include "base/RegexSet.h"
+#include "base/RunnersRegistry.h"
 #include "HttpHdrCc.h"
 #include "HttpReply.h"
 #include "HttpRequest.h"
@@ -25,6 +27,9 @@
 #include "Store.h"
 #include "util.h"
 
+#include <memory>
+#include <vector>
+
 typedef enum {
     rcHTTP,
     rcICP,
@@ -84,6 +89,64 @@ static int refreshStaleness(const StoreEntry * entry, time_t check_time, const t
 
 static RefreshPattern DefaultRefresh(nullptr);
 
+/// explicit refresh_pattern rules prepared for refreshLimits() lookups
+class RefreshRules
+{
+public:
+    explicit RefreshRules(const RefreshPattern *head);
+
+    /// Config.Refresh rules, in configuration order
+    std::vector<const RefreshPattern *> rules;
+
+    /// rules[] regexes, in the same order
+    RegexSet regexes;
+
+    /// the number of regexes a one-by-one search would have tested, per rule
+    std::vector<uint64_t> testCounts() const;
+
+    /// the number of set searches that stopped at the rule with the same
+    /// index; the last element counts searches that matched no rules
+    std::vector<uint64_t> searchEnds;
+};
+
+/// current Config.Refresh rules prepared for lookups or, when unavailable, nil
+static std::unique_ptr<RefreshRules> TheRefreshRules;
+
+RefreshRules::RefreshRules(const RefreshPattern *head)
+{
+    for (auto R = head; R; R = R->next) {
+        rules.push_back(R);
+        regexes.add(R->regex());
+    }
+    searchEnds.resize(rules.size() + 1, 0);
+    regexes.compile();
+    debugs(22, 2, "matching " << regexes.setMatched() << " out of " << rules.size() << " refresh_pattern regexes together");
+}
+
+/// manages TheRefreshRules
+class RefreshRr: public RegisteredRunner
+{
+public:
+    /* RegisteredRunner API */
+    void useConfig() override { TheRefreshRules = std::make_unique<RefreshRules>(Config.Refresh); }
+    void startReconfigure() override { TheRefreshRules.reset(); }
+    void syncConfig() override { useConfig(); }
+};
+DefineRunnerRegistrator(RefreshRr);
+
+std::vector<uint64_t>
+RefreshRules::testCounts() const
+{
+    // a search that stopped at rule N has tested rules 0 through N
+    std::vector<uint64_t> counts(rules.size(), 0);
+    uint64_t laterEnds = searchEnds.back();
+    for (auto i = rules.size(); i > 0; --i) {
+        laterEnds += searchEnds[i - 1];
+        counts[i - 1] = laterEnds;
+    }
+    return counts;
+}
+
 /** Locate the first refresh_pattern rule that matches the given URL by regex.
  *
  * \return A pointer to the refresh_pattern parameters to use, or nullptr if there is no match.
@@ -91,15 +154,29 @@ static RefreshPattern DefaultRefresh(nullptr);
 const RefreshPattern *
 refreshLimits(const char *url)
 {
-    for (auto R = Config.Refresh; R; R = R->next) {
-        ++(R->stats.matchTests);
-        if (R->regex().match(url)) {
-            ++(R->stats.matchCount);
-            return R;
+    if (!TheRefreshRules) {
+        for (auto R = Config.Refresh; R; R = R->next) {
+            ++(R->stats.matchTests);
+            if (R->regex().match(url)) {
+                ++(R->stats.matchCount);
+                return R;
+            }
         }
+        return nullptr;
     }
 
-    return nullptr;
+    const auto &rules = TheRefreshRules->rules;
+    const auto found = TheRefreshRules->regexes.firstMatch(url);
+
+    // refreshStats() derives per-rule matchTests from these counts
+    ++TheRefreshRules->searchEnds[found ? *found : rules.size()];
+
+    if (!found)
+        return nullptr;
+
+    const auto R = rules[*found];
+    ++(R->stats.matchCount);
+    return R;
 }
 
 /// the first explicit refresh_pattern rule that uses a "." regex (or nil)
@@ -687,15 +764,24 @@ refreshStats(StoreEntry * sentry)
     // display per-rule counts of usage and tests
     storeAppendPrintf(sentry, "\nRefresh pattern usage:\n\n");
     storeAppendPrintf(sentry, "  Used      \tChecks    \t%% Matches\tPattern\n");
-    for (const RefreshPattern *R = Config.Refresh; R; R = R->next) {
+    const auto setTests = TheRefreshRules ? TheRefreshRules->testCounts() : std::vector<uint64_t>();
+    size_t position = 0;
+    for (const RefreshPattern *R = Config.Refresh; R; R = R->next, ++position) {
+        auto tests = R->stats.matchTests;
+        if (position < setTests.size())
+            tests += setTests[position];
         storeAppendPrintf(sentry, "  %10" PRIu64 "\t%10" PRIu64 "\t%6.2f\t",
                           R->stats.matchCount,
-                          R->stats.matchTests,
-                          xpercent(R->stats.matchCount, R->stats.matchTests));
+                          tests,
+                          xpercent(R->stats.matchCount, tests));
         PackableStream os(*sentry);
         R->printPattern(os);
         os << "\n";
     }
+    if (TheRefreshRules) {
+        storeAppendPrintf(sentry, "\nPatterns matched together: %zu out of %zu\n",
+                          TheRefreshRules->regexes.setMatched(), TheRefreshRules->rules.size());
+    }
 
     int i;
     int total = 0;
@@ -730,6 +730,12 @@ SBuf::findFirstOf(const CharacterSet &set, size_type startPos) const
     if (startPos >= length())
         return npos;
 
+    if (set.soleMember() >= 0) {
+        // a single character search; memchr(3) is usually vectorized
+        const void *found = memchr(buf()+startPos, set.soleMember(), length()-startPos);
+        return found ? static_cast<const char *>(found)-buf() : npos;
+    }
+
     debugs(24, 7, "first of characterset " << set.name << " in id " << id);
     char *cur = buf()+startPos;
     const char *bufend = bufEnd();
@@ -753,6 +759,12 @@ SBuf::findFirstNotOf(const CharacterSet &set, size_type startPos) const
     if (startPos >= length())
         return npos;
 
+    if (set.soleNonMember() >= 0) {
+        // a single character search; memchr(3) is usually vectorized
+        const void *found = memchr(buf()+startPos, set.soleNonMember(), length()-startPos);
+        return found ? static_cast<const char *>(found)-buf() : npos;
+    }
+
     debugs(24, 7, "first not of characterset " << set.name << " in id " << id);
     char *cur = buf()+startPos;
     const char *bufend = bufEnd();
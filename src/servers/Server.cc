@@ -213,6 +213,9 @@ Server::clientWriteDone(const CommIoCbParams &io)
     debugs(33,5, io.conn);
     Must(writer != nullptr);
     writer = nullptr;
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+    sentFile = nullptr; // Comm is done with the file
+#endif
 
     /* Bail out quickly on Comm::ERR_CLOSING - close handlers will tidy up */
     if (io.flag == Comm::ERR_CLOSING || !Comm::IsConnOpen(clientConnection)) {
@@ -18,6 +18,7 @@
 #include "comm/Write.h"
 #include "CommCalls.h"
 #include "error/forward.h"
+#include "fs_io.h"
 #include "http/Stream.h"
 #include "log/forward.h"
 #include "Pipeline.h"
@@ -82,6 +83,25 @@ public:
         Comm::Write(clientConnection, buf, len, writer, nullptr);
     }
 
+    /// schedule a scatter-gather Comm::Write() of mb followed by
+    /// caller-owned extras that must stay intact until the write completes
+    void write(MemBuf *mb, const Comm::IoSegment *extras, int extrasCount) {
+        typedef CommCbMemFunT<Server, CommIoCbParams> Dialer;
+        writer = JobCallback(33, 5, Dialer, this, Server::clientWriteDone);
+        Comm::Write(clientConnection, mb, extras, extrasCount, writer);
+    }
+
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+    /// schedule a Comm::SendFile() of size file bytes starting at offset;
+    /// keeps the file open until the write callback
+    void sendFile(const SharedFile::Pointer &file, int64_t offset, int size) {
+        typedef CommCbMemFunT<Server, CommIoCbParams> Dialer;
+        writer = JobCallback(33, 5, Dialer, this, Server::clientWriteDone);
+        sentFile = file;
+        Comm::SendFile(clientConnection, file->fd, offset, size, writer);
+    }
+#endif
+
     /// processing to sync state after a Comm::Write()
     virtual void afterClientWrite(size_t) {}
 
@@ -129,6 +149,11 @@ protected:
 
     AsyncCall::Pointer reader; ///< set when we are reading
     AsyncCall::Pointer writer; ///< set when we are writing
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+    /// the file being sent by our pending sendFile(), if any; the sending
+    /// transaction may be gone before our write callback
+    SharedFile::Pointer sentFile;
+#endif
 };
 
 #endif /* SQUID_SRC_SERVERS_SERVER_H */
@@ -189,6 +189,9 @@ Store::Controller::configure()
 {
     disks->configure();
 
+    if (sharedMemStore)
+        sharedMemStore->configure(); // not yet created during startup
+
     store_swap_high = (long) (((float) maxSize() *
                                (float) Config.Swap.highWaterMark) / (float) 100);
     store_swap_low = (long) (((float) maxSize() *
@@ -613,6 +616,20 @@ Store::Controller::memoryDisconnect(StoreEntry &e)
     // else nothing to do for non-shared memory cache
 }
 
+bool
+Store::Controller::memoryCanRead(const StoreEntry &e, const int64_t offset) const
+{
+    return sharedMemStore && sharedMemStore->canReadFromShm(e, offset);
+    // else the non-shared memory cache keeps everything in MemObject
+}
+
+size_t
+Store::Controller::memoryRead(StoreEntry &e, const StoreIOBuffer &buf)
+{
+    Assure(sharedMemStore);
+    return sharedMemStore->readFromShm(e, buf);
+}
+
 void
 Store::Controller::noteStoppedSharedWriting(StoreEntry &e)
 {
@@ -13,6 +13,7 @@
 
 class MemObject;
 class RequestFlags;
+class StoreIOBuffer;
 class HttpRequestMethod;
 
 namespace Store {
@@ -123,6 +124,15 @@ public:
     /// disassociates the entry from the memory cache, preserving cached data
     void memoryDisconnect(StoreEntry &);
 
+    /// whether the memory cache can supply the entry byte at the given offset
+    /// that the entry MemObject lacks
+    bool memoryCanRead(const StoreEntry &, int64_t offset) const;
+
+    /// copies entry bytes directly from the memory cache into the buffer
+    /// \returns the number of bytes copied
+    /// \prec memoryCanRead(buf.offset) is true
+    size_t memoryRead(StoreEntry &, const StoreIOBuffer &buf);
+
     /// \returns an iterator for all Store entries
     StoreSearch *search();
 
@@ -160,6 +160,23 @@ Store::Disk::objectSizeIsAcceptable(int64_t objsize) const
     return minObjectSize() <= objsize && objsize <= maxObjectSize();
 }
 
+void
+Store::Disk::sizeClass(const int64_t min, const int64_t max)
+{
+    assert(min >= 0);
+    assert(max < 0 || min < max);
+    sizeClassMin_ = min;
+    sizeClassMax_ = max;
+}
+
+bool
+Store::Disk::sizeClassFits(const int64_t objSize) const
+{
+    // objects of unknown size do not belong to any size class
+    assert(objSize >= 0);
+    return sizeClassMin_ <= objSize && (sizeClassMax_ < 0 || objSize < sizeClassMax_);
+}
+
 bool
 Store::Disk::canStore(const StoreEntry &e, int64_t diskSpaceNeeded, int &load) const
 {
@@ -67,6 +67,24 @@ public:
     /// negative objSize means the object size is currently unknown
     bool objectSizeIsAcceptable(int64_t objSize) const;
 
+    /// The size of disk space allocation units (e.g., rock db slots) that
+    /// stored objects are split into or zero for unsplit objects. Used to
+    /// compute size classes; see Store::Disks::configure().
+    virtual int64_t allocationUnit() const { return 0; }
+
+    /// the smallest object size in our size class
+    int64_t sizeClassMin() const { return sizeClassMin_; }
+
+    /// the smallest object size above our size class (-1 for no limit)
+    int64_t sizeClassMax() const { return sizeClassMax_; }
+
+    /// configure the [min, max) object size class of this storage area;
+    /// a negative max means no upper limit
+    void sizeClass(int64_t min, int64_t max);
+
+    /// whether an object of the given (known) size belongs to our size class
+    bool sizeClassFits(int64_t objSize) const;
+
     /// called when the entry is about to forget its association with cache_dir
     virtual void disconnect(StoreEntry &) {}
 
@@ -93,6 +111,9 @@ private:
     void optionObjectSizeDump(StoreEntry * e) const;
     char const *theType;
 
+    int64_t sizeClassMin_ = 0; ///< \copydoc sizeClassMin()
+    int64_t sizeClassMax_ = -1; ///< \copydoc sizeClassMax()
+
 protected:
     uint64_t max_size;        ///< maximum allocatable size of the storage area
     int64_t min_objsize;      ///< minimum size of any object stored here (-1 for no limit)
@@ -122,6 +143,13 @@ public:
     virtual StoreIOState::Pointer createStoreIO(StoreEntry &, StoreIOState::STIOCB *, void *) = 0;
     virtual StoreIOState::Pointer openStoreIO(StoreEntry &, StoreIOState::STIOCB *, void *) = 0;
 
+    /// Opens the file storing the given swapped out entry for reading it
+    /// outside of the StoreIOState API (e.g., with sendfile(2)). The file
+    /// starts with swap metadata followed by the stored HTTP response.
+    /// \returns an fd_table-registered descriptor or -1 if entries are not
+    /// stored in individual files
+    virtual int openEntryFile(const StoreEntry &) { return -1; }
+
     bool canLog(StoreEntry const &e)const;
     virtual void openLog();
     virtual void closeLog();
@@ -25,7 +25,12 @@
 #include "swap_log_op.h"
 #include "tools.h"
 
-typedef SwapDir *STDIRSELECT(const StoreEntry *e);
+#include <algorithm>
+#include <vector>
+
+/// selects a cache_dir for storing the given entry, optionally ignoring
+/// cache_dirs outside the entry size class
+typedef SwapDir *STDIRSELECT(const StoreEntry *e, bool sizeClassOnly);
 
 static STDIRSELECT storeDirSelectSwapDirRoundRobin;
 static STDIRSELECT storeDirSelectSwapDirLeastLoad;
@@ -35,6 +40,10 @@ static STDIRSELECT storeDirSelectSwapDirLeastLoad;
  */
 static STDIRSELECT *storeDirSelectSwapDir = storeDirSelectSwapDirLeastLoad;
 
+/// whether store_dir_size_classes has assigned different size classes to
+/// some cache_dirs; see Store::Disks::configure()
+static bool SizeClassesConfigured = false;
+
 /// The entry size to use for Disk::canStore() size limit checks.
 /// This is an optimization to avoid similar calculations in every cache_dir.
 static int64_t
@@ -69,7 +78,7 @@ SwapDirByIndex(const size_t i)
  * overloaded.
  */
 static SwapDir *
-storeDirSelectSwapDirRoundRobin(const StoreEntry * e)
+storeDirSelectSwapDirRoundRobin(const StoreEntry * e, const bool sizeClassOnly)
 {
     const int64_t objsize = objectSizeForDirSelection(*e);
 
@@ -83,6 +92,9 @@ storeDirSelectSwapDirRoundRobin(const StoreEntry * e)
         const auto dirn = (firstCandidate + i) % Config.cacheSwap.n_configured;
         auto &dir = SwapDirByIndex(dirn);
 
+        if (sizeClassOnly && !dir.sizeClassFits(objsize))
+            continue;
+
         int load = 0;
         if (!dir.canStore(*e, objsize, load))
             continue;
@@ -111,7 +123,7 @@ storeDirSelectSwapDirRoundRobin(const StoreEntry * e)
  * we sort out the real usefulness of this algorithm.
  */
 static SwapDir *
-storeDirSelectSwapDirLeastLoad(const StoreEntry * e)
+storeDirSelectSwapDirLeastLoad(const StoreEntry * e, const bool sizeClassOnly)
 {
     int64_t most_free = 0;
     int64_t best_objsize = -1;
@@ -125,6 +137,9 @@ storeDirSelectSwapDirLeastLoad(const StoreEntry * e)
         auto &sd = SwapDirByIndex(i);
         sd.flags.selected = false;
 
+        if (sizeClassOnly && !sd.sizeClassFits(objsize))
+            continue;
+
         if (!sd.canStore(*e, objsize, load))
             continue;
 
@@ -164,6 +179,46 @@ storeDirSelectSwapDirLeastLoad(const StoreEntry * e)
     return selectedDir;
 }
 
+/// When store_dir_size_classes is on, assigns object size classes to
+/// cache_dirs with different allocation units so that, say, small objects go
+/// to rock cache_dirs with small slots while large objects go to cache_dirs
+/// with large slots (and need fewer disk I/Os). A cache_dir with allocation
+/// unit U gets objects of at least U bytes but smaller than the next larger
+/// unit. The smallest unit also gets smaller objects. Cache_dirs without
+/// allocation units get all objects.
+static void
+ConfigureSizeClasses()
+{
+    std::vector<int64_t> units;
+    if (Config.onoff.store_dir_size_classes) {
+        for (size_t i = 0; i < Config.cacheSwap.n_configured; ++i) {
+            const auto &disk = SwapDirByIndex(i);
+            if (disk.active() && disk.allocationUnit() > 0)
+                units.push_back(disk.allocationUnit());
+        }
+    }
+    std::sort(units.begin(), units.end());
+    units.erase(std::unique(units.begin(), units.end()), units.end());
+
+    SizeClassesConfigured = units.size() > 1;
+
+    for (size_t i = 0; i < Config.cacheSwap.n_configured; ++i) {
+        auto &disk = SwapDirByIndex(i);
+        disk.sizeClass(0, -1);
+
+        const auto unit = disk.allocationUnit();
+        if (!SizeClassesConfigured || unit <= 0)
+            continue;
+
+        const auto pos = std::find(units.begin(), units.end(), unit);
+        if (pos == units.end())
+            continue; // an inactive cache_dir
+
+        disk.sizeClass(pos == units.begin() ? 0 : unit, pos + 1 == units.end() ? -1 : *(pos + 1));
+        debugs(47, 2, "cache_dir " << disk.path << " size class: " << disk.sizeClassMin() << '-' << disk.sizeClassMax());
+    }
+}
+
 Store::Disks::Disks():
     largestMinimumObjectSize(-1),
     largestMaximumObjectSize(-1),
@@ -408,6 +463,8 @@ Store::Disks::configure()
             largestMaximumObjectSize = diskMaxObjectSize;
         }
     }
+
+    ConfigureSizeClasses();
 }
 
 void
@@ -656,7 +713,19 @@ Store::Disks::SmpAware()
 SwapDir *
 Store::Disks::SelectSwapDir(const StoreEntry *e)
 {
-    return storeDirSelectSwapDir(e);
+    if (!SizeClassesConfigured)
+        return storeDirSelectSwapDir(e, false);
+
+    // The bytes accumulated so far are only a lower bound of an object with
+    // unknown size, so they cannot place it in a size class. Such objects
+    // may go to any cache_dir that can store them.
+    if (e->mem_obj->expectedReplySize() < 0)
+        return storeDirSelectSwapDir(e, false);
+
+    // fall back to other cache_dirs when the best-fitting ones are unusable
+    if (const auto dir = storeDirSelectSwapDir(e, true))
+        return dir;
+    return storeDirSelectSwapDir(e, false);
 }
 
 bool
@@ -496,11 +496,17 @@ store_client::scheduleDiskRead()
 bool
 store_client::canReadFromMemory() const
 {
+    if (!parsingBuffer->spaceSize())
+        return false;
+
     const auto &mem = entry->mem();
     const auto memReadOffset = nextHttpReadOffset();
     // XXX: This (lo <= offset < end) logic does not support Content-Range gaps.
-    return mem.inmem_lo <= memReadOffset && memReadOffset < mem.endOffset() &&
-           parsingBuffer->spaceSize();
+    if (mem.inmem_lo <= memReadOffset && memReadOffset < mem.endOffset())
+        return true;
+
+    // shared memory cache hits may keep their body in shared memory
+    return Store::Root().memoryCanRead(*entry, memReadOffset);
 }
 
 /// The offset of the next stored HTTP response byte wanted by the client.
@@ -528,7 +534,9 @@ store_client::readFromMemory()
     const auto readInto = parsingBuffer->space().positionAt(nextHttpReadOffset());
 
     debugs(90, 3, "copying HTTP body bytes from memory into " << readInto);
-    const auto sz = entry->mem_obj->data_hdr.copy(readInto);
+    const auto sz = (readInto.offset < entry->mem_obj->endOffset()) ?
+                    entry->mem_obj->data_hdr.copy(readInto) :
+                    Store::Root().memoryRead(*entry, readInto);
     Assure(sz > 0); // our canReadFromMemory() precondition guarantees that
     parsingBuffer->appended(readInto.data, sz);
 }
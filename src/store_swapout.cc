@@ -408,6 +408,13 @@ StoreEntry::mayStartSwapOut()
         return false;
     }
 
+    // e.g., a shared memory cache hit that left its body in shared memory
+    if (store_status == STORE_OK && mem_obj->endOffset() < mem_obj->object_sz) {
+        debugs(20, 3, "storeSwapOut: not fully loaded: " << mem_obj->endOffset() << '/' << mem_obj->object_sz);
+        swapOutDecision(MemObject::SwapOut::swImpossible);
+        return false;
+    }
+
     // handle store_maxobjsize limit
     {
         // TODO: add estimated store metadata size to be conservative
@@ -18,6 +18,7 @@ public:
     TestSwapDir() : SwapDir("test"), statsCalled (false) {}
 
     bool statsCalled;
+    int64_t unit = 0; ///< the allocationUnit() to report
 
     /* Store::Disk API */
     uint64_t maxSize() const override;
@@ -37,6 +38,7 @@ public:
     void evictIfFound(const cache_key *) override {}
     bool hasReadableEntry(const StoreEntry &) const override { return false; }
     bool smpAware() const override { return false; }
+    int64_t allocationUnit() const override { return unit; }
 };
 
 typedef RefCount<TestSwapDir> TestSwapDirPointer;
@@ -15,10 +15,12 @@
 
 #include "HttpHeader.h"
 HttpHeaderEntry::HttpHeaderEntry(Http::HdrType, const SBuf &, const char *) {STUB}
+HttpHeaderEntry::HttpHeaderEntry(Http::HdrType, const SBuf &, const char *, size_t) {STUB}
 HttpHeaderEntry::~HttpHeaderEntry() {STUB}
 HttpHeaderEntry *HttpHeaderEntry::parse(const char *, const char *, const http_hdr_owner_type) STUB_RETVAL(nullptr)
 HttpHeaderEntry *HttpHeaderEntry::clone() const STUB_RETVAL(nullptr)
 void HttpHeaderEntry::packInto(Packable *) const STUB
+bool HttpHeaderEntry::packsInto(const char *, size_t) const STUB_RETVAL(false)
 int HttpHeaderEntry::getInt() const STUB_RETVAL(0)
 int64_t HttpHeaderEntry::getInt64() const STUB_RETVAL(0)
 HttpHeader::HttpHeader(const http_hdr_owner_type) {STUB}
@@ -38,6 +40,7 @@ int HttpHeader::delByName(const SBuf &) STUB_RETVAL(0)
 int HttpHeader::delById(Http::HdrType) STUB_RETVAL(0)
 void HttpHeader::delAt(HttpHeaderPos, int &) STUB
 void HttpHeader::refreshMask() STUB
+void HttpHeader::forgetRawFields() STUB
 void HttpHeader::addEntry(HttpHeaderEntry *) STUB
 String HttpHeader::getList(Http::HdrType) const STUB_RETVAL(String())
 bool HttpHeader::getList(Http::HdrType, String *) const STUB_RETVAL(false)
@@ -20,6 +20,9 @@ bool MemStore::keepInLocalMemory(const StoreEntry &) const STUB_RETVAL(false)
 void MemStore::write(StoreEntry &) STUB
 void MemStore::completeWriting(StoreEntry &) STUB
 void MemStore::disconnect(StoreEntry &) STUB
+void MemStore::configure() STUB
+bool MemStore::canReadFromShm(const StoreEntry &, int64_t) const STUB_RETVAL(false)
+size_t MemStore::readFromShm(StoreEntry &, const StoreIOBuffer &) STUB_RETVAL(0)
 void MemStore::reference(StoreEntry &) STUB
 void MemStore::updateHeaders(StoreEntry *) STUB
 void MemStore::maintain() STUB
@@ -14,6 +14,7 @@
 
 class StoreEntry;
 
+StatHist::StatHist(const StatHist &) STUB_NOP
 void StatHist::dump(StoreEntry *, StatHistBinDumper *) const STUB
 void StatHist::enumInit(unsigned int) STUB_NOP
 void StatHist::count(double) {/* STUB_NOP */}
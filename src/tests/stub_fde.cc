@@ -14,6 +14,8 @@
 #include "fde.h"
 void fde::Init() STUB
 void fde::setIo(READ_HANDLER *, WRITE_HANDLER *) STUB
+bool fde::readsDirectly() const STUB_RETVAL(false)
+bool fde::writesDirectly() const STUB_RETVAL(false)
 void fde::useDefaultIo() STUB
 void fde::useBufferedIo(READ_HANDLER *, WRITE_HANDLER *) STUB
 void fde::DumpStats(StoreEntry *) STUB
@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "fs_io.h"
+
+#define STUB_API "fs_io.cc"
+#include "tests/STUB.h"
+
+int file_open(const char *, int) STUB_RETVAL(-1)
+void file_close(int) STUB
+void file_write(int, off_t, void const *, int, DWCB *, void *, FREE *) STUB
+void file_read(int, char *, int, off_t, DRCB *, void *) STUB
+void safeunlink(const char *, int) STUB
+bool FileRename(const SBuf &, const SBuf &) STUB_RETVAL(false)
+int fsBlockSize(const char *, int *) STUB_RETVAL(0)
+int fsStats(const char *, int *, int *, int *, int *) STUB_RETVAL(0)
+
@@ -78,6 +78,10 @@ void Comm::ApplyTcpKeepAlive(int, const TcpKeepAlive &) STUB
 #include "comm/Write.h"
 void Comm::Write(const Comm::ConnectionPointer &, const char *, int, AsyncCall::Pointer &, FREE *) STUB
 void Comm::Write(const Comm::ConnectionPointer &, MemBuf *, AsyncCall::Pointer &) STUB
+void Comm::Write(const Comm::ConnectionPointer &, MemBuf *, const IoSegment *, int, AsyncCall::Pointer &) STUB
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+void Comm::SendFile(const Comm::ConnectionPointer &, int, int64_t, int, AsyncCall::Pointer &) STUB
+#endif
 void Comm::WriteCancel(const Comm::ConnectionPointer &, const char *) STUB
 /*PF*/ void Comm::HandleWrite(int, void*) STUB
 
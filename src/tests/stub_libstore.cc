@@ -52,6 +52,8 @@ void Controller::noteStoppedSharedWriting(StoreEntry &) STUB
 int Controller::transientReaders(const StoreEntry &) const STUB_RETVAL(0)
 void Controller::transientsDisconnect(StoreEntry &) STUB
 void Controller::memoryDisconnect(StoreEntry &) STUB
+bool Controller::memoryCanRead(const StoreEntry &, int64_t) const STUB_RETVAL(false)
+size_t Controller::memoryRead(StoreEntry &, const StoreIOBuffer &) STUB_RETVAL(0)
 StoreSearch *Controller::search() STUB_RETVAL(nullptr)
 bool Controller::SmpAware() STUB_RETVAL(false)
 int Controller::store_dirs_rebuilding = 0;
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "acl/DomainData.h"
+#include "anyp/PortCfg.h"
+#include "compat/cppunit.h"
+#include "ConfigParser.h"
+#include "unitTestMain.h"
+
+class TestACLDomainData : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestACLDomainData);
+    CPPUNIT_TEST(testExactNames);
+    CPPUNIT_TEST(testSubdomains);
+    CPPUNIT_TEST(testCaseFolding);
+    CPPUNIT_TEST(testWildcards);
+    CPPUNIT_TEST(testReparsing);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testExactNames();
+    void testSubdomains();
+    void testCaseFolding();
+    void testWildcards();
+    void testReparsing();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestACLDomainData );
+
+/* globals required to resolve link issues */
+AnyP::PortCfgPointer HttpPortList;
+
+/// ACLDomainData with the given parameters
+class TestedDomainData: public ACLDomainData
+{
+public:
+    TestedDomainData(const char *parameters, const bool prepare) {
+        add(parameters);
+        if (prepare)
+            prepareForUse();
+    }
+
+    /// parses more parameters
+    void add(const char *parameters) {
+        const auto line = xstrdup(parameters);
+        ConfigParser::SetCfgLine(line);
+        parse();
+        xfree(line);
+    }
+
+    using ACLDomainData::matchHost;
+};
+
+/// the same ACL parameters searched as parsed and as prepared for use
+class DomainDataTwins
+{
+public:
+    explicit DomainDataTwins(const char *parameters):
+        parsed(parameters, false),
+        prepared(parameters, true)
+    {}
+
+    /// whether the host matches; the prepared names must give the same
+    /// answer as a search of the parsed names
+    bool matches(const char *host, const bool honorWildcards = false) {
+        const auto answer = prepared.matchHost(host, honorWildcards);
+        CPPUNIT_ASSERT_EQUAL(parsed.matchHost(host, honorWildcards), answer);
+        return answer;
+    }
+
+    TestedDomainData parsed;
+    TestedDomainData prepared;
+};
+
+void
+TestACLDomainData::testExactNames()
+{
+    DomainDataTwins acl("www.example.com mail.example.net");
+
+    CPPUNIT_ASSERT(acl.matches("www.example.com"));
+    CPPUNIT_ASSERT(acl.matches("mail.example.net"));
+
+    // neither parent domains nor subdomains of configured names
+    CPPUNIT_ASSERT(!acl.matches("example.com"));
+    CPPUNIT_ASSERT(!acl.matches("x.www.example.com"));
+    CPPUNIT_ASSERT(!acl.matches("ww.example.com"));
+    CPPUNIT_ASSERT(!acl.matches("wwww.example.com"));
+    CPPUNIT_ASSERT(!acl.matches("www.example.co"));
+    CPPUNIT_ASSERT(!acl.matches("www.example.com.x"));
+    CPPUNIT_ASSERT(!acl.matches(""));
+}
+
+void
+TestACLDomainData::testSubdomains()
+{
+    DomainDataTwins acl(".example.com .org a.example.net");
+
+    // a dot-prefixed name matches the name itself and all its subdomains
+    CPPUNIT_ASSERT(acl.matches("example.com"));
+    CPPUNIT_ASSERT(acl.matches("www.example.com"));
+    CPPUNIT_ASSERT(acl.matches("a.b.c.example.com"));
+    CPPUNIT_ASSERT(acl.matches("x.org"));
+    CPPUNIT_ASSERT(acl.matches("org"));
+
+    // but not names that merely end with the same characters
+    CPPUNIT_ASSERT(!acl.matches("badexample.com"));
+    CPPUNIT_ASSERT(!acl.matches("example.com.net"));
+    CPPUNIT_ASSERT(!acl.matches("xorg"));
+    CPPUNIT_ASSERT(!acl.matches("com"));
+
+    // an exact name next to a dot-prefixed one
+    CPPUNIT_ASSERT(acl.matches("a.example.net"));
+    CPPUNIT_ASSERT(!acl.matches("b.a.example.net"));
+    CPPUNIT_ASSERT(!acl.matches("example.net"));
+
+    // like matchDomainName(), ignore leading dots in hosts
+    CPPUNIT_ASSERT(acl.matches(".www.example.com"));
+    CPPUNIT_ASSERT(acl.matches("..a.example.net"));
+}
+
+void
+TestACLDomainData::testCaseFolding()
+{
+    DomainDataTwins acl("WWW.Example.COM .Example.ORG");
+
+    CPPUNIT_ASSERT(acl.matches("www.example.com"));
+    CPPUNIT_ASSERT(acl.matches("WWW.EXAMPLE.COM"));
+    CPPUNIT_ASSERT(acl.matches("wWw.ExAmPlE.cOm"));
+    CPPUNIT_ASSERT(acl.matches("X.EXAMPLE.ORG"));
+    CPPUNIT_ASSERT(acl.matches("example.org"));
+    CPPUNIT_ASSERT(!acl.matches("X.WWW.EXAMPLE.COM"));
+
+    // dump() reports lowercased names
+    const auto dump = acl.prepared.dump();
+    CPPUNIT_ASSERT_EQUAL(size_t(2), dump.size());
+    for (const auto &name: dump)
+        CPPUNIT_ASSERT(name == SBuf("www.example.com") || name == SBuf(".example.org"));
+}
+
+void
+TestACLDomainData::testWildcards()
+{
+    DomainDataTwins acl("www.example.com .example.net");
+
+    // wildcards are literal characters unless honored
+    CPPUNIT_ASSERT(!acl.matches("*.example.com"));
+    CPPUNIT_ASSERT(acl.matches("*.example.com", true));
+    CPPUNIT_ASSERT(acl.matches("*.example.net"));
+    CPPUNIT_ASSERT(acl.matches("*.example.net", true));
+    CPPUNIT_ASSERT(!acl.matches("*.com"));
+    CPPUNIT_ASSERT(!acl.matches("*.org", true));
+    CPPUNIT_ASSERT(!acl.matches("*.www.example.com", true));
+}
+
+void
+TestACLDomainData::testReparsing()
+{
+    // names added after prepareForUse() are merged with the prepared ones
+    TestedDomainData data("www.example.com .example.org", true);
+    data.add("x.example.org .example.com");
+    data.prepareForUse();
+
+    CPPUNIT_ASSERT(data.matchHost("example.com", false));
+    CPPUNIT_ASSERT(data.matchHost("a.example.com", false));
+    CPPUNIT_ASSERT(data.matchHost("a.example.org", false));
+    CPPUNIT_ASSERT(!data.matchHost("example.net", false));
+
+    // .example.com covers www.example.com, and .example.org covers x.example.org
+    CPPUNIT_ASSERT_EQUAL(size_t(2), data.dump().size());
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "acl/Ip.h"
+#include "anyp/PortCfg.h"
+#include "compat/cppunit.h"
+#include "ConfigParser.h"
+#include "ip/tools.h"
+#include "unitTestMain.h"
+
+class TestACLIp : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestACLIp);
+    CPPUNIT_TEST(testHostsMasksRanges);
+    CPPUNIT_TEST(testOverlappingRanges);
+    CPPUNIT_TEST(testAddressFamilies);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testHostsMasksRanges();
+    void testOverlappingRanges();
+    void testAddressFamilies();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestACLIp );
+
+/* globals required to resolve link issues */
+AnyP::PortCfgPointer HttpPortList;
+
+/// an IP-based ACL with the given parameters
+class TestedIpAcl: public ACLIP
+{
+public:
+    TestedIpAcl(const char *parameters, const bool prepare) {
+        const auto line = xstrdup(parameters);
+        ConfigParser::SetCfgLine(line);
+        parse();
+        xfree(line);
+        if (prepare)
+            prepareForUse();
+    }
+
+    bool matches(const Ip::Address &ip) { return ACLIP::match(ip); }
+
+    /* Acl::Node API */
+    char const *typeString() const override { return "test_ip"; }
+    int match(ACLChecklist *) override { return 0; }
+};
+
+/// the same ACL parameters searched as parsed and as prepared for use
+class IpAclTwins
+{
+public:
+    explicit IpAclTwins(const char *parameters):
+        parsed(parameters, false),
+        prepared(parameters, true)
+    {}
+
+    /// whether the ACL matches the given address; the prepared ranges must
+    /// give the same answer as a search of the parsed data
+    bool matches(const char *address) {
+        Ip::Address ip;
+        const auto valid = (ip = address);
+        CPPUNIT_ASSERT(valid);
+        const auto answer = prepared.matches(ip);
+        CPPUNIT_ASSERT_EQUAL(parsed.matches(ip), answer);
+        return answer;
+    }
+
+private:
+    TestedIpAcl parsed;
+    TestedIpAcl prepared;
+};
+
+void
+TestACLIp::testHostsMasksRanges()
+{
+    IpAclTwins acl("10.0.0.1 192.168.0.0/16 172.16.0.0/255.255.255.0 10.1.0.10-10.1.0.20 10.2.0.0-10.2.3.0/24");
+
+    // a single host
+    CPPUNIT_ASSERT(acl.matches("10.0.0.1"));
+    CPPUNIT_ASSERT(!acl.matches("10.0.0.0"));
+    CPPUNIT_ASSERT(!acl.matches("10.0.0.2"));
+
+    // CIDR and dotted masks
+    CPPUNIT_ASSERT(acl.matches("192.168.0.0"));
+    CPPUNIT_ASSERT(acl.matches("192.168.255.255"));
+    CPPUNIT_ASSERT(!acl.matches("192.169.0.0"));
+    CPPUNIT_ASSERT(!acl.matches("192.167.255.255"));
+    CPPUNIT_ASSERT(acl.matches("172.16.0.255"));
+    CPPUNIT_ASSERT(!acl.matches("172.16.1.0"));
+
+    // range boundaries
+    CPPUNIT_ASSERT(!acl.matches("10.1.0.9"));
+    CPPUNIT_ASSERT(acl.matches("10.1.0.10"));
+    CPPUNIT_ASSERT(acl.matches("10.1.0.15"));
+    CPPUNIT_ASSERT(acl.matches("10.1.0.20"));
+    CPPUNIT_ASSERT(!acl.matches("10.1.0.21"));
+
+    // a masked range
+    CPPUNIT_ASSERT(acl.matches("10.2.0.0"));
+    CPPUNIT_ASSERT(acl.matches("10.2.3.255"));
+    CPPUNIT_ASSERT(!acl.matches("10.2.4.0"));
+    CPPUNIT_ASSERT(!acl.matches("10.1.255.255"));
+
+    // addresses below and above all entries
+    CPPUNIT_ASSERT(!acl.matches("1.1.1.1"));
+    CPPUNIT_ASSERT(!acl.matches("255.255.255.255"));
+}
+
+void
+TestACLIp::testOverlappingRanges()
+{
+    // overlapping, nested, and adjacent entries in no particular order
+    IpAclTwins acl("10.0.0.50-10.0.0.80 10.0.0.10-10.0.0.60 10.0.0.20-10.0.0.30 10.0.0.81 10.0.0.100-10.0.0.110 10.0.0.0/24");
+
+    CPPUNIT_ASSERT(acl.matches("10.0.0.0"));
+    CPPUNIT_ASSERT(acl.matches("10.0.0.10"));
+    CPPUNIT_ASSERT(acl.matches("10.0.0.55"));
+    CPPUNIT_ASSERT(acl.matches("10.0.0.81"));
+    CPPUNIT_ASSERT(acl.matches("10.0.0.90"));
+    CPPUNIT_ASSERT(acl.matches("10.0.0.255"));
+    CPPUNIT_ASSERT(!acl.matches("10.0.1.0"));
+    CPPUNIT_ASSERT(!acl.matches("9.255.255.255"));
+
+    // partially overlapping ranges with a gap between the groups
+    IpAclTwins gapped("10.0.0.10-10.0.0.20 10.0.0.15-10.0.0.25 10.0.0.27-10.0.0.30 10.0.0.29-10.0.0.40");
+    CPPUNIT_ASSERT(!gapped.matches("10.0.0.9"));
+    CPPUNIT_ASSERT(gapped.matches("10.0.0.10"));
+    CPPUNIT_ASSERT(gapped.matches("10.0.0.21"));
+    CPPUNIT_ASSERT(gapped.matches("10.0.0.25"));
+    CPPUNIT_ASSERT(!gapped.matches("10.0.0.26"));
+    CPPUNIT_ASSERT(gapped.matches("10.0.0.27"));
+    CPPUNIT_ASSERT(gapped.matches("10.0.0.35"));
+    CPPUNIT_ASSERT(gapped.matches("10.0.0.40"));
+    CPPUNIT_ASSERT(!gapped.matches("10.0.0.41"));
+}
+
+void
+TestACLIp::testAddressFamilies()
+{
+    IpAclTwins acl("10.0.0.0/8 2001:db8::/32 ::1 2001:db9::10-2001:db9::20");
+
+    CPPUNIT_ASSERT(acl.matches("10.1.2.3"));
+    CPPUNIT_ASSERT(!acl.matches("11.0.0.0"));
+
+    CPPUNIT_ASSERT(acl.matches("2001:db8::1"));
+    CPPUNIT_ASSERT(acl.matches("2001:db8:ffff:ffff:ffff:ffff:ffff:ffff"));
+    CPPUNIT_ASSERT(!acl.matches("2001:db7:ffff:ffff:ffff:ffff:ffff:ffff"));
+    CPPUNIT_ASSERT(acl.matches("::1"));
+    CPPUNIT_ASSERT(!acl.matches("::2"));
+    CPPUNIT_ASSERT(acl.matches("2001:db9::10"));
+    CPPUNIT_ASSERT(acl.matches("2001:db9::1a"));
+    CPPUNIT_ASSERT(!acl.matches("2001:db9::21"));
+
+    // IPv4 entries do not match IPv6 addresses with the same low bits
+    CPPUNIT_ASSERT(!acl.matches("::a01:203"));
+    CPPUNIT_ASSERT(!acl.matches("10::1"));
+    // but IPv4-mapped IPv6 addresses are IPv4 addresses
+    CPPUNIT_ASSERT(acl.matches("::ffff:10.1.2.3"));
+    // IPv6 entries do not match IPv4 addresses
+    CPPUNIT_ASSERT(!acl.matches("0.0.0.1"));
+    CPPUNIT_ASSERT(!acl.matches("32.1.13.184"));
+
+    // "ipv4" matches all IPv4 addresses but leaves IPv6 ones to other entries
+    IpAclTwins ipv4("ipv4 2001:db8::/32");
+    CPPUNIT_ASSERT(ipv4.matches("192.0.2.1"));
+    CPPUNIT_ASSERT(ipv4.matches("2001:db8::1"));
+    CPPUNIT_ASSERT(!ipv4.matches("2001:db9::1"));
+}
+
+/// customizes our test setup
+class MyTestProgram: public TestProgram
+{
+public:
+    /* TestProgram API */
+    void startup() override { Ip::EnableIpv6 = IPV6_ON; }
+};
+
+int
+main(int argc, char *argv[])
+{
+    return MyTestProgram().run(argc, argv);
+}
+
@@ -23,6 +23,7 @@ class TestCharacterSet : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST(CharacterSetConstants);
     CPPUNIT_TEST(CharacterSetUnion);
     CPPUNIT_TEST(CharacterSetSubtract);
+    CPPUNIT_TEST(CharacterSetSoleMembers);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -33,6 +34,7 @@ protected:
     void CharacterSetUnion();
     void CharacterSetEqualityOp();
     void CharacterSetSubtract();
+    void CharacterSetSoleMembers();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( TestCharacterSet );
@@ -143,6 +145,32 @@ TestCharacterSet::CharacterSetSubtract()
     CPPUNIT_ASSERT_EQUAL(CharacterSet::HEXDIG, sample - CharacterSet(nullptr, "qz"));
 }
 
+void
+TestCharacterSet::CharacterSetSoleMembers()
+{
+    CPPUNIT_ASSERT_EQUAL(int('\n'), CharacterSet::LF.soleMember());
+    CPPUNIT_ASSERT_EQUAL(-1, CharacterSet::LF.soleNonMember());
+    CPPUNIT_ASSERT_EQUAL(-1, CharacterSet::WSP.soleMember());
+    CPPUNIT_ASSERT_EQUAL(-1, CharacterSet().soleMember());
+
+    const auto nonLf = CharacterSet::LF.complement();
+    CPPUNIT_ASSERT_EQUAL(-1, nonLf.soleMember());
+    CPPUNIT_ASSERT_EQUAL(int('\n'), nonLf.soleNonMember());
+
+    CharacterSet sample(nullptr, "a");
+    sample.add('b');
+    CPPUNIT_ASSERT_EQUAL(-1, sample.soleMember());
+    sample.remove('a');
+    CPPUNIT_ASSERT_EQUAL(int('b'), sample.soleMember());
+    sample -= CharacterSet(nullptr, "b");
+    CPPUNIT_ASSERT_EQUAL(-1, sample.soleMember());
+
+    const CharacterSet all(nullptr, 0, 255);
+    CPPUNIT_ASSERT_EQUAL(-1, all.soleNonMember());
+    CPPUNIT_ASSERT_EQUAL(int(0xff), (all - CharacterSet(nullptr, 0, 254)).soleMember());
+    CPPUNIT_ASSERT_EQUAL(int(0), (all - CharacterSet(nullptr, 0, 0)).soleNonMember());
+}
+
 int
 main(int argc, char *argv[])
 {
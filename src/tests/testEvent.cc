@@ -11,8 +11,12 @@
 #include "compat/cppunit.h"
 #include "event.h"
 #include "MemBuf.h"
+#include "time/gadgets.h"
 #include "unitTestMain.h"
 
+#include <random>
+#include <vector>
+
 /*
  * test the event module.
  */
@@ -26,6 +30,7 @@ class TestEvent : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST(testCheckEvents);
     CPPUNIT_TEST(testSingleton);
     CPPUNIT_TEST(testCancel);
+    CPPUNIT_TEST(testManyEvents);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -35,6 +40,7 @@ protected:
     void testCheckEvents();
     void testSingleton();
     void testCancel();
+    void testManyEvents();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( TestEvent );
@@ -161,6 +167,73 @@ TestEvent::testCheckEvents()
     CPPUNIT_ASSERT_EQUAL(1, event.calls);
 }
 
+/// Helper for tests - an event that checks that it fires in schedule order
+class OrderedEvent
+{
+public:
+    static void Handler(void *data) {
+        const auto event = static_cast<OrderedEvent *>(data);
+        CPPUNIT_ASSERT(*event->lastFired <= event->when);
+        *event->lastFired = event->when;
+        ++event->calls;
+    }
+
+    double when = 0;
+    double *lastFired = nullptr;
+    int calls = 0;
+};
+
+/// Helper for tests - sets the current time and restores it when destroyed
+class CurrentTimeRestorer
+{
+public:
+    explicit CurrentTimeRestorer(const double now): savedTime(current_dtime) { current_dtime = now; }
+    ~CurrentTimeRestorer() { current_dtime = savedTime; }
+
+    CurrentTimeRestorer(CurrentTimeRestorer &&) = delete; // no copying of any kind
+
+private:
+    const double savedTime;
+};
+
+/* schedule, cancel, and dispatch a large number of events */
+void
+TestEvent::testManyEvents()
+{
+    const size_t eventCount = 100000;
+    const CurrentTimeRestorer timeRestorer(1000.0);
+
+    EventScheduler scheduler;
+    std::vector<OrderedEvent> events(eventCount);
+    double lastFired = 0;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<> delays(0.001, 3600.0);
+
+    for (auto &event: events) {
+        const auto delay = delays(rng);
+        event.when = current_dtime + delay;
+        event.lastFired = &lastFired;
+        scheduler.schedule("many events", OrderedEvent::Handler, &event, delay, 0, false);
+    }
+    CPPUNIT_ASSERT_EQUAL(eventCount, scheduler.size());
+
+    // cancel every other event
+    for (size_t i = 0; i < eventCount; i += 2)
+        scheduler.cancel(OrderedEvent::Handler, &events[i]);
+    CPPUNIT_ASSERT_EQUAL(eventCount/2, scheduler.size());
+    CPPUNIT_ASSERT(!scheduler.find(OrderedEvent::Handler, &events[0]));
+    CPPUNIT_ASSERT(scheduler.find(OrderedEvent::Handler, &events[1]));
+
+    // dispatch the rest, jumping the clock forward past all the deadlines
+    current_dtime += 3601.0;
+    CPPUNIT_ASSERT_EQUAL(int(AsyncEngine::EVENT_IDLE), scheduler.checkEvents(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.size());
+    AsyncCallQueue::Instance().fire();
+
+    for (size_t i = 0; i < eventCount; ++i)
+        CPPUNIT_ASSERT_EQUAL(i % 2 ? 1 : 0, events[i].calls);
+}
+
 /* for convenience we have a singleton scheduler */
 void
 TestEvent::testSingleton()
@@ -16,8 +16,10 @@
 #include "compat/cppunit.h"
 #include "debug/Stream.h"
 #include "http/one/RequestParser.h"
+#include "http/one/TeChunkedParser.h"
 #include "http/RequestMethod.h"
 #include "MemBuf.h"
+#include "mime_header.h"
 #include "SquidConfig.h"
 #include "unitTestMain.h"
 
@@ -32,6 +34,8 @@ class TestHttp1Parser : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST(testParseRequestLineTerminators);
     CPPUNIT_TEST(testParseRequestLineStrange);
     CPPUNIT_TEST(testParseRequestLineInvalid);
+    CPPUNIT_TEST(testHeadersEnd);
+    CPPUNIT_TEST(testTeChunkedParser);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -47,6 +51,10 @@ protected:
     void testParseRequestLineInvalid();      // rejection of invalid lines happens
 
     void testDripFeed();  // test incremental parse works
+
+    void testHeadersEnd();  // mime header block terminator detection
+
+    void testTeChunkedParser();  // chunked transfer coding decoding
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( TestHttp1Parser );
@@ -1194,6 +1202,120 @@ TestHttp1Parser::testDripFeed()
 
 }
 
+void
+TestHttp1Parser::testHeadersEnd()
+{
+    const auto end = [](const char *input, bool expectObsFold = false) {
+        bool containsObsFold = false;
+        const auto result = headersEnd(input, strlen(input), containsObsFold);
+        CPPUNIT_ASSERT_EQUAL(expectObsFold, containsObsFold);
+        return result;
+    };
+
+    // empty header blocks
+    CPPUNIT_ASSERT_EQUAL(size_t(2), end("\r\n"));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), end("\n"));
+
+    // complete header blocks, with and without CRs
+    CPPUNIT_ASSERT_EQUAL(size_t(8), end("A: b\r\n\r\n"));
+    CPPUNIT_ASSERT_EQUAL(size_t(6), end("A: b\n\n"));
+    CPPUNIT_ASSERT_EQUAL(size_t(14), end("A: b\r\nC: d\r\n\r\nbody"));
+
+    // incomplete header blocks
+    CPPUNIT_ASSERT_EQUAL(size_t(0), end(""));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), end("A: b"));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), end("A: b\r\n"));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), end("A: b\r\n\r"));
+
+    // obs-fold continuation lines
+    CPPUNIT_ASSERT_EQUAL(size_t(12), end("A: b\r\n c\r\n\r\n", true));
+    CPPUNIT_ASSERT_EQUAL(size_t(12), end("A: b\r\n\tc\r\n\r\n", true));
+}
+
+
+void
+TestHttp1Parser::testTeChunkedParser()
+{
+    // decodes the given input, feeding it and draining the output in steps
+    const auto decode = [](const SBuf &input, const SBuf::size_type step, const mb_size_t outSize) {
+        Http1::TeChunkedParser parser;
+        SBuf decoded;
+        SBuf fed;
+        SBuf::size_type offset = 0;
+        bool done = false;
+        while (!done) {
+            const auto feeding = offset < input.length();
+            if (feeding) {
+                fed.append(input.substr(offset, step));
+                offset += step;
+            }
+            MemBuf out;
+            out.init(outSize, outSize);
+            parser.setPayloadBuffer(&out);
+            done = parser.parse(fed);
+            fed = parser.remaining();
+            decoded.append(out.content(), out.contentSize());
+            if (!feeding && !done && !out.contentSize())
+                break; // stalled
+        }
+        CPPUNIT_ASSERT(done);
+        CPPUNIT_ASSERT(fed.isEmpty());
+        return decoded;
+    };
+
+    // many small chunks
+    SBuf tiny;
+    SBuf tinyBody;
+    for (int i = 0; i < 100; ++i) {
+        const auto size = 1 + i % 17;
+        tiny.appendf("%x\r\n", size);
+        for (int j = 0; j < size; ++j) {
+            const char c = 'a' + (i + j) % 26;
+            tiny.append(c);
+            tinyBody.append(c);
+        }
+        tiny.append("\r\n");
+    }
+    tiny.append("0\r\n\r\n");
+    CPPUNIT_ASSERT_EQUAL(tinyBody, decode(tiny, tiny.length(), 64*1024));
+    CPPUNIT_ASSERT_EQUAL(tinyBody, decode(tiny, 1, 64*1024));
+    CPPUNIT_ASSERT_EQUAL(tinyBody, decode(tiny, 7, 64*1024));
+    CPPUNIT_ASSERT_EQUAL(tinyBody, decode(tiny, tiny.length(), 8));
+
+    // simple chunks mixed with chunks that need the general parsing code
+    const SBuf mixed("3\r\nabc\r\n"
+                     "4;ext=value\r\ndefg\r\n"
+                     "00000000000000002\r\nhi\r\n"
+                     "1 \r\nj\r\n"
+                     "A\r\nklmnopqrst\r\n"
+                     "0;last=\"chunk\"\r\n"
+                     "Trailer: value\r\n"
+                     "\r\n");
+    const SBuf mixedBody("abcdefghijklmnopqrst");
+    CPPUNIT_ASSERT_EQUAL(mixedBody, decode(mixed, mixed.length(), 64*1024));
+    CPPUNIT_ASSERT_EQUAL(mixedBody, decode(mixed, 1, 64*1024));
+    CPPUNIT_ASSERT_EQUAL(mixedBody, decode(mixed, mixed.length(), 4));
+
+    // malformed chunks
+    const auto malformed = [](const char *input) {
+        Http1::TeChunkedParser parser;
+        MemBuf out;
+        out.init();
+        parser.setPayloadBuffer(&out);
+        try {
+            parser.parse(SBuf(input));
+        } catch (...) {
+            return true;
+        }
+        return false;
+    };
+    CPPUNIT_ASSERT(malformed("0x1\r\na\r\n0\r\n\r\n"));
+    CPPUNIT_ASSERT(malformed("1\r\na\r\n0X1\r\na\r\n0\r\n\r\n"));
+    CPPUNIT_ASSERT(malformed("1\r\naX\r\n0\r\n\r\n"));
+    CPPUNIT_ASSERT(malformed("g\r\n"));
+    CPPUNIT_ASSERT(!malformed("1\r\na\r\n0\r\n\r\n"));
+}
+
 int
 main(int argc, char *argv[])
 {
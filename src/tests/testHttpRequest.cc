@@ -8,9 +8,11 @@
 
 #include "squid.h"
 #include "compat/cppunit.h"
+#include "http/ContentLengthInterpreter.h"
 #include "HttpHeader.h"
 #include "HttpRequest.h"
 #include "MasterXaction.h"
+#include "MemBuf.h"
 #include "mime_header.h"
 #include "unitTestMain.h"
 
@@ -22,12 +24,14 @@ class TestHttpRequest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST(testCreateFromUrl);
     CPPUNIT_TEST(testIPv6HostColonBug);
     CPPUNIT_TEST(testSanityCheckStartLine);
+    CPPUNIT_TEST(testHeaderPacking);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
     void testCreateFromUrl();
     void testIPv6HostColonBug();
     void testSanityCheckStartLine();
+    void testHeaderPacking();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( TestHttpRequest );
@@ -214,6 +218,73 @@ TestHttpRequest::testSanityCheckStartLine()
     error = Http::scNone;
 }
 
+/// \returns the given header fields packed
+static SBuf
+repackHeader(const HttpHeader &header)
+{
+    MemBuf packed;
+    packed.init();
+    header.packInto(&packed);
+    const SBuf result(packed.content(), packed.contentSize());
+    packed.clean();
+    return result;
+}
+
+/*
+ * Test that packing parsed header fields reuses their bytes only while the
+ * result is the same as packing each field
+ */
+void
+TestHttpRequest::testHeaderPacking()
+{
+    const SBuf canonical("Host: example.com\r\nX-Custom: a b\r\nAccept: */*\r\n");
+
+    {
+        HttpHeader header(hoRequest);
+        Http::ContentLengthInterpreter clen;
+        CPPUNIT_ASSERT(header.parse(canonical.rawContent(), canonical.length(), clen));
+        CPPUNIT_ASSERT_EQUAL(canonical, repackHeader(header));
+        CPPUNIT_ASSERT_EQUAL(canonical.length(), static_cast<SBuf::size_type>(header.len));
+
+        // copies share the parsed fields
+        const HttpHeader copy(header);
+        CPPUNIT_ASSERT_EQUAL(canonical, repackHeader(copy));
+
+        // added fields follow the parsed ones
+        header.putStr(Http::HdrType::VIA, "1.1 proxy");
+        CPPUNIT_ASSERT_EQUAL(SBuf(canonical).append("Via: 1.1 proxy\r\n"), repackHeader(header));
+
+        // deleted fields are not packed
+        header.delById(Http::HdrType::HOST);
+        CPPUNIT_ASSERT_EQUAL(SBuf("X-Custom: a b\r\nAccept: */*\r\nVia: 1.1 proxy\r\n"), repackHeader(header));
+    }
+
+    {
+        // fields that need normalization
+        const SBuf raw("host:example.com\r\nX-Custom:  a b\r\nAccept: */*\n");
+        HttpHeader header(hoRequest);
+        Http::ContentLengthInterpreter clen;
+        CPPUNIT_ASSERT(header.parse(raw.rawContent(), raw.length(), clen));
+        CPPUNIT_ASSERT_EQUAL(canonical, repackHeader(header));
+    }
+
+    {
+        // a normalized field after parsed fields that need no normalization
+        const SBuf raw("Host: example.com\r\nX-Custom: a b\r\naccept: */*\r\n");
+        HttpHeader header(hoRequest);
+        Http::ContentLengthInterpreter clen;
+        CPPUNIT_ASSERT(header.parse(raw.rawContent(), raw.length(), clen));
+        CPPUNIT_ASSERT_EQUAL(canonical, repackHeader(header));
+
+        // fields changed in place
+        HttpHeaderPos pos = HttpHeaderInitPos;
+        const auto e = header.getEntry(&pos);
+        e->value = "example.net";
+        header.noteEntryChange();
+        CPPUNIT_ASSERT_EQUAL(SBuf("Host: example.net\r\nX-Custom: a b\r\nAccept: */*\r\n"), repackHeader(header));
+    }
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "base/TextException.h"
+#include "compat/cppunit.h"
+#include "DiskIO/IpcIo/ReplyOrder.h"
+#include "unitTestMain.h"
+
+#include <vector>
+
+class TestIpcIoReplyOrder : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestIpcIoReplyOrder);
+    CPPUNIT_TEST(testInOrderCompletions);
+    CPPUNIT_TEST(testOutOfOrderCompletions);
+    CPPUNIT_TEST(testIndependentWorkers);
+    CPPUNIT_TEST(testHeadOfLineBlocking);
+    CPPUNIT_TEST(testTagReuse);
+    CPPUNIT_TEST(testUnknownRequests);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override { Sent.clear(); }
+
+protected:
+    void testInOrderCompletions();
+    void testOutOfOrderCompletions();
+    void testIndependentWorkers();
+    void testHeadOfLineBlocking();
+    void testTagReuse();
+    void testUnknownRequests();
+
+    /// tags of the replies sent so far, in the order they were sent
+    static std::vector<size_t> Sent;
+
+    /// IpcIo::ReplyOrder::Sender that records the sent reply
+    static void Send(const size_t tag) { Sent.push_back(tag); }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestIpcIoReplyOrder );
+
+std::vector<size_t> TestIpcIoReplyOrder::Sent;
+
+void
+TestIpcIoReplyOrder::testInOrderCompletions()
+{
+    IpcIo::ReplyOrder order;
+    order.started(1, 0);
+    order.started(1, 1);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(1), order.finished(1, 0, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), order.finished(1, 1, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.held());
+
+    const std::vector<size_t> expected = { 0, 1 };
+    CPPUNIT_ASSERT(Sent == expected);
+}
+
+void
+TestIpcIoReplyOrder::testOutOfOrderCompletions()
+{
+    // requests for three adjacent slot batches of the same entry, with
+    // concurrent I/Os completing in reverse order
+    IpcIo::ReplyOrder order;
+    order.started(1, 3);
+    order.started(1, 0);
+    order.started(1, 2);
+    order.started(1, 1);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.finished(1, 1, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.finished(1, 2, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), order.held());
+    CPPUNIT_ASSERT(Sent.empty());
+
+    // the earliest request unblocks the later ones that have finished
+    CPPUNIT_ASSERT_EQUAL(size_t(1), order.finished(1, 3, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), order.held());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), order.finished(1, 0, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.held());
+
+    const std::vector<size_t> expected = { 3, 0, 2, 1 };
+    CPPUNIT_ASSERT(Sent == expected);
+}
+
+void
+TestIpcIoReplyOrder::testIndependentWorkers()
+{
+    IpcIo::ReplyOrder order;
+    order.started(1, 0);
+    order.started(2, 1);
+    order.started(1, 2);
+    order.started(2, 3);
+
+    // a slow request of one worker does not delay replies to another worker
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.finished(1, 2, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.finished(2, 3, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), order.finished(2, 1, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), order.held());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), order.finished(1, 0, &Send));
+
+    const std::vector<size_t> expected = { 1, 3, 0, 2 };
+    CPPUNIT_ASSERT(Sent == expected);
+}
+
+void
+TestIpcIoReplyOrder::testHeadOfLineBlocking()
+{
+    // one slow request and as many later ones as the remaining I/O slots allow
+    const size_t depth = 8;
+    IpcIo::ReplyOrder order;
+    for (size_t tag = 0; tag < depth; ++tag)
+        order.started(1, tag);
+
+    // all later requests finish first and keep their slots while held
+    for (size_t tag = 1; tag < depth; ++tag) {
+        CPPUNIT_ASSERT_EQUAL(size_t(0), order.finished(1, tag, &Send));
+        CPPUNIT_ASSERT_EQUAL(tag, order.held());
+    }
+    CPPUNIT_ASSERT(Sent.empty());
+
+    // the slow request releases everything it was holding back
+    CPPUNIT_ASSERT_EQUAL(depth, order.finished(1, 0, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.held());
+
+    std::vector<size_t> expected;
+    for (size_t tag = 0; tag < depth; ++tag)
+        expected.push_back(tag);
+    CPPUNIT_ASSERT(Sent == expected);
+}
+
+void
+TestIpcIoReplyOrder::testTagReuse()
+{
+    IpcIo::ReplyOrder order;
+    order.started(1, 0);
+    order.started(1, 1);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), order.finished(1, 0, &Send));
+
+    // the sent request tag (i.e. I/O slot) is reused for a newer request
+    order.started(1, 0);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.finished(1, 0, &Send));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), order.finished(1, 1, &Send));
+
+    const std::vector<size_t> expected = { 0, 1, 0 };
+    CPPUNIT_ASSERT(Sent == expected);
+}
+
+void
+TestIpcIoReplyOrder::testUnknownRequests()
+{
+    IpcIo::ReplyOrder order;
+    order.started(1, 0);
+
+    CPPUNIT_ASSERT_THROW(order.finished(2, 0, &Send), TextException);
+    CPPUNIT_ASSERT_THROW(order.finished(1, 1, &Send), TextException);
+
+    order.started(1, 1);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.finished(1, 1, &Send));
+    CPPUNIT_ASSERT_THROW(order.finished(1, 1, &Send), TextException);
+
+    // clear() forgets held requests
+    order.clear();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), order.held());
+    CPPUNIT_ASSERT_THROW(order.finished(1, 0, &Send), TextException);
+    CPPUNIT_ASSERT(Sent.empty());
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "compat/cppunit.h"
+#include "ipc/mem/PageStack.h"
+#include "unitTestMain.h"
+
+#include <vector>
+
+class TestIpcMemIdSet : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestIpcMemIdSet);
+    CPPUNIT_TEST(testDefaultOrder);
+    CPPUNIT_TEST(testPreferredId);
+    CPPUNIT_TEST(testExhaustedPreferredLeaf);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testDefaultOrder();
+    void testPreferredId();
+    void testExhaustedPreferredLeaf();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestIpcMemIdSet );
+
+using IdSet = Ipc::Mem::IdSet;
+
+/// an IdSet in regular (rather than shared) memory, full of IDs
+class TestSet
+{
+public:
+    /// IDs in [0, capacity) spread over 64-ID leaves of an eight-leaf tree
+    static const IdSet::size_type Capacity = 300;
+
+    TestSet():
+        storage((IdSet::MemorySize(Capacity) + sizeof(uint64_t) - 1)/sizeof(uint64_t)),
+        ids(*new (storage.data()) IdSet(Capacity))
+    {
+        ids.makeFullBeforeSharing();
+    }
+
+    /// pops an ID, asserting that one was available
+    IdSet::size_type pop(const IdSet::size_type preferred = 0) {
+        IdSet::size_type id = 0;
+        CPPUNIT_ASSERT(ids.pop(id, preferred));
+        return id;
+    }
+
+private:
+    std::vector<uint64_t> storage; ///< aligned memory for IdSet nodes
+
+public:
+    IdSet &ids;
+};
+
+void
+TestIpcMemIdSet::testDefaultOrder()
+{
+    TestSet set;
+
+    // without a preference, IDs come out lowest first, crossing leaf nodes
+    for (IdSet::size_type expected = 0; expected < TestSet::Capacity; ++expected)
+        CPPUNIT_ASSERT_EQUAL(expected, set.pop());
+
+    IdSet::size_type id = 0;
+    CPPUNIT_ASSERT(!set.ids.pop(id));
+
+    // returned IDs are reused, still lowest first
+    set.ids.push(200);
+    set.ids.push(7);
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(7), set.pop());
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(200), set.pop());
+}
+
+void
+TestIpcMemIdSet::testPreferredId()
+{
+    TestSet set;
+
+    // a free preferred ID is returned as is, even in a distant leaf
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(200), set.pop(200));
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(5), set.pop(5));
+
+    // a taken preferred ID yields the next free ID above it
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(201), set.pop(200));
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(202), set.pop(200));
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(6), set.pop(5));
+
+    // the preferred ID wins over lower free IDs once it is free again
+    set.ids.push(200);
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(200), set.pop(200));
+
+    // the default preference still starts with the lowest free ID
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(0), set.pop());
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(1), set.pop());
+}
+
+void
+TestIpcMemIdSet::testExhaustedPreferredLeaf()
+{
+    TestSet set;
+
+    // empty the leaf with IDs 192-255
+    for (IdSet::size_type id = 192; id < 256; ++id)
+        CPPUNIT_ASSERT_EQUAL(id, set.pop(id));
+
+    // above the preferred ID, the leaf has no IDs left; the descent strays
+    // into the sibling leaf and takes its ID closest to the preferred one
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(191), set.pop(200));
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(190), set.pop(255));
+
+    // empty the leaf with IDs 256-299 (the rest of its leaf is unusable)
+    for (IdSet::size_type id = 256; id < TestSet::Capacity; ++id)
+        CPPUNIT_ASSERT_EQUAL(id, set.pop(id));
+
+    // a preference for the exhausted right half of the tree gets the
+    // highest free ID of the left half
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(189), set.pop(260));
+
+    // out-of-capacity preferences are satisfied with the closest free ID
+    CPPUNIT_ASSERT_EQUAL(IdSet::size_type(188), set.pop(511));
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
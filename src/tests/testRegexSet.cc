@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "base/RegexSet.h"
+#include "compat/cppunit.h"
+#include "unitTestMain.h"
+
+#include <list>
+#include <memory>
+
+class TestRegexSet : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestRegexSet);
+    CPPUNIT_TEST(testFirstMatch);
+    CPPUNIT_TEST(testFallbacks);
+    CPPUNIT_TEST(testSameAsRegexec);
+    CPPUNIT_TEST(testIdenticalSets);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testFirstMatch();
+    void testFallbacks();
+    void testSameAsRegexec();
+    void testIdenticalSets();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestRegexSet );
+
+/// RegexSet with patterns it owns
+class TestedSet
+{
+public:
+    void add(const char *pattern, const int extraFlags = 0) {
+        patterns.emplace_back(std::make_unique<RegexPattern>(SBuf(pattern), REG_EXTENDED | REG_NOSUB | extraFlags));
+        set.add(*patterns.back());
+    }
+
+    /// the answer of a one-by-one search
+    std::optional<size_t> slowMatch(const char *str) const {
+        size_t position = 0;
+        for (const auto &pattern: patterns) {
+            if (pattern->match(str))
+                return position;
+            ++position;
+        }
+        return std::nullopt;
+    }
+
+    std::list< std::unique_ptr<RegexPattern> > patterns;
+    RegexSet set;
+};
+
+void
+TestRegexSet::testFirstMatch()
+{
+    TestedSet t;
+    t.add("example\\.com");
+    t.add("^http://");
+    t.add("\\.com/");
+    t.add("MIXED", REG_ICASE);
+    t.set.compile();
+
+    CPPUNIT_ASSERT_EQUAL(size_t(4), t.set.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), *t.set.firstMatch("http://example.com/"));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), *t.set.firstMatch("http://example.org/"));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), *t.set.firstMatch("ftp://a.com/"));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), *t.set.firstMatch("ftp://a.net/mixed"));
+    CPPUNIT_ASSERT(!t.set.firstMatch("ftp://a.net/"));
+}
+
+void
+TestRegexSet::testFallbacks()
+{
+    TestedSet t;
+    t.add("\\<word"); // a GNU extension
+    t.add("[\\.]x"); // a literal backslash inside a POSIX bracket expression
+    t.add("\\d9"); // a literal 'd' for regcomp(3), a digit for others
+    t.add("^z{,2}y"); // "{0,2}" for regcomp(3), a literal "{,2}" for RE2
+    t.add("word");
+    t.set.compile();
+
+#if HAVE_LIBRE2 && HAVE_RE2_SET_H
+    // only "word" is matched together with other patterns
+    CPPUNIT_ASSERT_EQUAL(size_t(1), t.set.setMatched());
+#endif
+
+    CPPUNIT_ASSERT_EQUAL(size_t(0), *t.set.firstMatch("a word"));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), *t.set.firstMatch("a\\x"));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), *t.set.firstMatch("d9"));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), *t.set.firstMatch("zzy"));
+    CPPUNIT_ASSERT_EQUAL(size_t(4), *t.set.firstMatch("aword"));
+    CPPUNIT_ASSERT(!t.set.firstMatch("1"));
+}
+
+void
+TestRegexSet::testSameAsRegexec()
+{
+    TestedSet t;
+    t.add("^ftp:");
+    t.add("/cgi-bin/|\\?");
+    t.add("\\.(jpg|jpeg|png|gif)$", REG_ICASE);
+    t.add("[[:digit:]]{3,}\\.html$");
+    t.add("[]a-c]+z");
+    t.add("^[^/]+//[^/]*\\.example\\.(com|net)/");
+    t.add("x*");
+    t.add(".");
+    t.set.compile();
+
+    const char *inputs[] = {
+        "ftp://example.com/",
+        "http://example.com/cgi-bin/x",
+        "http://example.com/a?b",
+        "http://example.com/IMAGE.PNG",
+        "http://example.com/123.html",
+        "http://example.com/]bz",
+        "http://www.example.net/",
+        "",
+        "http://example.com/12.html",
+        nullptr
+    };
+    for (auto input = inputs; *input; ++input)
+        CPPUNIT_ASSERT_EQUAL(*t.slowMatch(*input), *t.set.firstMatch(*input));
+}
+
+void
+TestRegexSet::testIdenticalSets()
+{
+    TestedSet first;
+    first.add("^http://");
+    first.add("\\<word");
+    first.add("\\.com/");
+
+    TestedSet second;
+    second.add("^http://");
+    second.add("\\<word");
+    second.add("\\.com/", REG_ICASE); // differs from the first set pattern
+
+    // uncompiled sets match patterns one by one
+    CPPUNIT_ASSERT_EQUAL(size_t(0), first.set.setMatched());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), *first.set.firstMatch("ftp://a.com/"));
+    CPPUNIT_ASSERT(!first.set.firstMatch("ftp://a.COM/"));
+
+    first.set.compile();
+    second.set.compile();
+    CPPUNIT_ASSERT_EQUAL(first.set.setMatched(), second.set.setMatched());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), *first.set.firstMatch("ftp://a/word"));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), *second.set.firstMatch("ftp://a/word"));
+    CPPUNIT_ASSERT(!first.set.firstMatch("ftp://a.COM/"));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), *second.set.firstMatch("ftp://a.COM/"));
+
+    // a set with the same patterns as the first one
+    TestedSet third;
+    third.add("^http://");
+    third.add("\\<word");
+    third.add("\\.com/");
+    third.set.compile();
+    CPPUNIT_ASSERT_EQUAL(first.set.setMatched(), third.set.setMatched());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), *third.set.firstMatch("ftp://a.com/"));
+    CPPUNIT_ASSERT(!third.set.firstMatch("ftp://a.COM/"));
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
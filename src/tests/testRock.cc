@@ -8,15 +8,20 @@
 
 #include "squid.h"
 #include "compat/cppunit.h"
+#include "base/RunnersRegistry.h"
 #include "ConfigParser.h"
 #include "DiskIO/DiskIOModule.h"
 #include "fde.h"
+#include "fs/rock/RockIndexCheckpoint.h"
 #include "fs/rock/RockSwapDir.h"
 #include "globals.h"
 #include "HttpHeader.h"
 #include "HttpReply.h"
+#include "ipc/mem/Pages.h"
 #include "MemObject.h"
+#include "MemStore.h"
 #include "RequestFlags.h"
+#include "sbuf/Stream.h"
 #include "SquidConfig.h"
 #include "Store.h"
 #include "store/Disk.h"
@@ -26,7 +31,9 @@
 #include "testStoreSupport.h"
 #include "unitTestMain.h"
 
+#include <memory>
 #include <stdexcept>
+#include <string>
 #if HAVE_SYS_STAT_H
 #include <sys/stat.h>
 #endif
@@ -45,6 +52,8 @@ class TestRock : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST_SUITE(TestRock);
     CPPUNIT_TEST(testRockCreate);
     CPPUNIT_TEST(testRockSwapOut);
+    CPPUNIT_TEST(testFreeSlotPreference);
+    CPPUNIT_TEST(testSharedMemoryHit);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -60,8 +69,11 @@ protected:
     StoreEntry *createEntry(const int i);
     StoreEntry *addEntry(const int i);
     StoreEntry *getEntry(const int i);
+    void checkIndexCheckpoint(const int expectedEntries);
     void testRockCreate();
     void testRockSwapOut();
+    void testFreeSlotPreference();
+    void testSharedMemoryHit();
 
 private:
     SwapDirPointer store;
@@ -196,6 +208,40 @@ TestRock::getEntry(const int i)
     return storeGetPublic(storeId(i), Http::METHOD_GET);
 }
 
+/// saves the store index and loads it into a fresh index
+void
+TestRock::checkIndexCheckpoint(const int expectedEntries)
+{
+    Rock::IndexCheckpoint::Save(*store);
+    auto checkpointPath = ToSBuf(TESTDIR, "/rock.index");
+    struct stat sb;
+    CPPUNIT_ASSERT_EQUAL(0, ::stat(checkpointPath.c_str(), &sb));
+
+    const auto slotLimit = store->slotLimitActual();
+    const SBuf mapPath("checkpoint_test_map");
+    const std::unique_ptr<Ipc::StoreMap::Owner> mapOwner(Ipc::StoreMap::Init(mapPath, slotLimit));
+    Ipc::StoreMap map(mapPath);
+
+    Ipc::Mem::PageStack::Config config;
+    config.poolId = Ipc::Mem::PageStack::IdForSwapDirSpace(store->index);
+    config.pageSize = 0;
+    config.capacity = slotLimit;
+    config.createFull = false;
+    const std::unique_ptr<Ipc::Mem::Owner<Ipc::Mem::PageStack>> freeSlotsOwner(shm_new(Ipc::Mem::PageStack)("checkpoint_test_slots", config));
+    const std::unique_ptr<Ipc::Mem::Owner<Rock::Rebuild::Stats>> statsOwner(shm_new(Rock::Rebuild::Stats)("checkpoint_test_stats"));
+    auto &freeSlots = *freeSlotsOwner->object();
+    auto &stats = *statsOwner->object();
+
+    CPPUNIT_ASSERT(Rock::IndexCheckpoint::Load(*store, map, freeSlots, stats));
+    CPPUNIT_ASSERT_EQUAL(expectedEntries, map.entryCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(slotLimit - expectedEntries), freeSlots.size());
+    CPPUNIT_ASSERT(stats.completed(*store));
+
+    // the loaded checkpoint is removed
+    CPPUNIT_ASSERT(::stat(checkpointPath.c_str(), &sb) != 0);
+    CPPUNIT_ASSERT(!Rock::IndexCheckpoint::Load(*store, map, freeSlots, stats));
+}
+
 void
 TestRock::testRockCreate()
 {
@@ -297,6 +343,8 @@ TestRock::testRockSwapOut()
 
     CPPUNIT_ASSERT_EQUAL((uint64_t)6, store->currentCount());
 
+    checkIndexCheckpoint(6);
+
     // try to get and release all entries
     for (int i = 0; i < 6; ++i) {
         StoreEntry *const pe = getEntry(i);
@@ -309,6 +357,124 @@ TestRock::testRockSwapOut()
     }
 }
 
+void
+TestRock::testFreeSlotPreference()
+{
+    Ipc::Mem::PageStack::Config config;
+    config.poolId = Ipc::Mem::PageStack::IdForSwapDirSpace(store->index);
+    config.pageSize = 0;
+    config.capacity = 300;
+    config.createFull = true;
+    const std::unique_ptr<Ipc::Mem::Owner<Ipc::Mem::PageStack>> freeSlotsOwner(shm_new(Ipc::Mem::PageStack)("preference_test_slots", config));
+    auto &freeSlots = *freeSlotsOwner->object();
+
+    const auto popNumber = [&freeSlots](const uint32_t preferred) {
+        Ipc::Mem::PageId page;
+        CPPUNIT_ASSERT(freeSlots.pop(page, preferred));
+        return page.number;
+    };
+
+    // without a preference, the lowest free number is used
+    Ipc::Mem::PageId page;
+    CPPUNIT_ASSERT(freeSlots.pop(page));
+    CPPUNIT_ASSERT_EQUAL(1U, page.number);
+
+    // a free preferred number is used as is
+    CPPUNIT_ASSERT_EQUAL(100U, popNumber(100));
+    // otherwise, the nearest higher number in the same tree leaf is used
+    CPPUNIT_ASSERT_EQUAL(101U, popNumber(100));
+
+    for (uint32_t number = 129; number <= 300; ++number)
+        CPPUNIT_ASSERT_EQUAL(number, popNumber(number));
+
+    // with no higher numbers left, the nearest lower number is used
+    CPPUNIT_ASSERT_EQUAL(128U, popNumber(200));
+    CPPUNIT_ASSERT_EQUAL(127U, popNumber(300));
+    // out-of-range preferences are ignored
+    CPPUNIT_ASSERT_EQUAL(2U, popNumber(301));
+    CPPUNIT_ASSERT_EQUAL(300U - 178U, freeSlots.size());
+}
+
+void
+TestRock::testSharedMemoryHit()
+{
+    Config.memShared.configure(true);
+    const auto savedMemMaxSize = Config.memMaxSize;
+    const auto savedMaxInMemObjSize = Config.Store.maxInMemObjSize;
+    const auto savedMaxReplyHeaderSize = Config.maxReplyHeaderSize;
+    const auto pageSize = Ipc::Mem::PageSize();
+    Config.memMaxSize = 16 * pageSize;
+    Config.Store.maxInMemObjSize = Config.memMaxSize;
+    Config.maxReplyHeaderSize = 64*1024;
+
+    CallRunnerRegistrator(SharedMemPagesRr);
+    CallRunnerRegistrator(MemStoreRr);
+    RunRegisteredHere(RegisteredRunner::claimMemoryNeeds);
+    RunRegisteredHere(RegisteredRunner::useConfig);
+
+    {
+        MemStore memStore;
+        memStore.init();
+
+        // cache an entry with a body spanning several shared memory pages
+        StoreEntry *const writer = createEntry(100);
+        writer->buffer();
+        writer->mem().freshestReply().packHeadersUsingSlowPacker(*writer);
+        const auto hdrSize = writer->mem().endOffset();
+        std::string body(3*pageSize + 123, '\0');
+        for (size_t i = 0; i < body.size(); ++i)
+            body[i] = 'a' + (i + i/pageSize) % 26;
+        writer->append(body.data(), body.size());
+        writer->flush();
+        writer->timestampsSet();
+        writer->complete();
+        memStore.write(*writer);
+        CPPUNIT_ASSERT_EQUAL(Store::ioDone, writer->mem_obj->memCache.io);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), memStore.currentCount());
+
+        // a hit keeps its body in shared memory
+        StoreEntry *const hit = memStore.get(reinterpret_cast<const cache_key *>(writer->key));
+        CPPUNIT_ASSERT(hit);
+        const auto &mem = hit->mem();
+        CPPUNIT_ASSERT_EQUAL(IN_MEMORY, hit->mem_status);
+        CPPUNIT_ASSERT_EQUAL(STORE_OK, hit->store_status);
+        CPPUNIT_ASSERT_EQUAL(hdrSize + static_cast<int64_t>(body.size()), mem.object_sz);
+        CPPUNIT_ASSERT(mem.endOffset() < mem.object_sz);
+
+        // sequential reads cross shared page boundaries
+        char buf[1000];
+        std::string readBody;
+        for (auto offset = mem.endOffset(); offset < mem.object_sz;) {
+            CPPUNIT_ASSERT(memStore.canReadFromShm(*hit, offset));
+            const auto copied = memStore.readFromShm(*hit, StoreIOBuffer(sizeof(buf), offset, buf));
+            CPPUNIT_ASSERT(copied > 0);
+            readBody.append(buf, copied);
+            offset += copied;
+        }
+        CPPUNIT_ASSERT_EQUAL(body.substr(body.size() - readBody.size()), readBody);
+        CPPUNIT_ASSERT(!memStore.canReadFromShm(*hit, mem.object_sz));
+
+        // random access, including reads before the previously read page
+        for (const auto bodyOffset: {body.size() - 1, size_t(0), pageSize - 1, 2*pageSize + 5, pageSize}) {
+            const auto copied = memStore.readFromShm(*hit, StoreIOBuffer(3, hdrSize + bodyOffset, buf));
+            CPPUNIT_ASSERT_EQUAL(std::min(size_t(3), body.size() - bodyOffset), copied);
+            CPPUNIT_ASSERT_EQUAL(body.substr(bodyOffset, copied), std::string(buf, copied));
+        }
+
+        // the body is no longer available after the hit releases its lock
+        memStore.disconnect(*hit);
+        CPPUNIT_ASSERT(!memStore.canReadFromShm(*hit, hdrSize));
+
+        writer->unlock("TestRock::testSharedMemoryHit");
+    }
+
+    RunRegisteredHere(RegisteredRunner::finishShutdown);
+    Config.maxReplyHeaderSize = savedMaxReplyHeaderSize;
+    Config.Store.maxInMemObjSize = savedMaxInMemObjSize;
+    Config.memMaxSize = savedMemMaxSize;
+    Config.memShared.configure(false);
+}
+
 /// customizes our test setup
 class MyTestProgram: public TestProgram
 {
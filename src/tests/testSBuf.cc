@@ -1087,6 +1087,16 @@ TestSBuf::testFindFirstOf()
     //found in the middle of haystack
     idx=haystack.findFirstOf(CharacterSet("t4","QWERqYV"));
     CPPUNIT_ASSERT_EQUAL(4U,idx);
+
+    // single-character sets
+    idx=haystack.findFirstOf(CharacterSet("t5","q"));
+    CPPUNIT_ASSERT_EQUAL(4U,idx);
+    idx=haystack.findFirstOf(CharacterSet("t6","o"), 13);
+    CPPUNIT_ASSERT_EQUAL(17U,idx);
+    idx=haystack.findFirstOf(CharacterSet("t7","Z"));
+    CPPUNIT_ASSERT_EQUAL(SBuf::npos,idx);
+    idx=haystack.findFirstOf(CharacterSet("t8","g"), haystack.length());
+    CPPUNIT_ASSERT_EQUAL(SBuf::npos,idx);
 }
 
 void
@@ -1110,6 +1120,14 @@ TestSBuf::testFindFirstNotOf()
     //found in the middle of haystack
     idx=haystack.findFirstNotOf(CharacterSet("t4","The"));
     CPPUNIT_ASSERT_EQUAL(3U,idx);
+
+    // sets with a single non-member character
+    idx=haystack.findFirstNotOf(CharacterSet("t5"," ").complement());
+    CPPUNIT_ASSERT_EQUAL(3U,idx);
+    idx=haystack.findFirstNotOf(CharacterSet("t6","o").complement(), 13);
+    CPPUNIT_ASSERT_EQUAL(17U,idx);
+    idx=haystack.findFirstNotOf(CharacterSet("t7","Z").complement());
+    CPPUNIT_ASSERT_EQUAL(SBuf::npos,idx);
 }
 
 void
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 1996-2026 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "compat/cppunit.h"
+#include "http/RequestMethod.h"
+#include "MemObject.h"
+#include "SquidConfig.h"
+#include "Store.h"
+#include "store/Disks.h"
+#include "TestSwapDir.h"
+
+/*
+ * test store_dir_size_classes
+ */
+
+class TestStoreSizeClasses : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestStoreSizeClasses);
+    CPPUNIT_TEST(testOffByDefault);
+    CPPUNIT_TEST(testClassBoundaries);
+    CPPUNIT_TEST(testKnownSizeSelection);
+    CPPUNIT_TEST(testUnknownSizeSelection);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+protected:
+    void testOffByDefault();
+    void testClassBoundaries();
+    void testKnownSizeSelection();
+    void testUnknownSizeSelection();
+};
+CPPUNIT_TEST_SUITE_REGISTRATION(TestStoreSizeClasses);
+
+/// adds a cache_dir with the given allocation unit
+static TestSwapDirPointer
+addSwapDir(const int64_t unit)
+{
+    TestSwapDirPointer dir(new TestSwapDir);
+    dir->unit = unit;
+    allocate_new_swapdir(Config.cacheSwap);
+    Config.cacheSwap.swapDirs[Config.cacheSwap.n_configured] = dir.getRaw();
+    ++Config.cacheSwap.n_configured;
+    return dir;
+}
+
+/// computes size classes of the configured cache_dirs
+static void
+configureDisks(const bool sizeClasses)
+{
+    Config.onoff.store_dir_size_classes = sizeClasses ? 1 : 0;
+    Store::Disks().configure();
+}
+
+/// whether some of the given number of cache_dir selections for the entry
+/// picks the given cache_dir; repeated selections let both least-load and
+/// round-robin algorithms reach every suitable cache_dir
+static bool
+mayBeSelected(const StoreEntry *e, const TestSwapDirPointer &dir)
+{
+    for (size_t i = 0; i < Config.cacheSwap.n_configured; ++i) {
+        if (Store::Disks::SelectSwapDir(e) == dir.getRaw())
+            return true;
+    }
+    return false;
+}
+
+/// a new entry of the given size (or of unknown size if the size is negative)
+static StoreEntry *
+entryOfSize(const int64_t size)
+{
+    const auto e = new StoreEntry();
+    e->createMemObject("dummy_storeId", nullptr, HttpRequestMethod());
+    e->store_status = STORE_PENDING;
+    e->mem_obj->object_sz = size;
+    return e;
+}
+
+void
+TestStoreSizeClasses::setUp()
+{
+    Config.Store.maxObjectSize = 1024*1024;
+}
+
+void
+TestStoreSizeClasses::tearDown()
+{
+    free_cachedir(&Config.cacheSwap);
+    Config.onoff.store_dir_size_classes = 0;
+}
+
+void
+TestStoreSizeClasses::testOffByDefault()
+{
+    const auto small = addSwapDir(4096);
+    const auto large = addSwapDir(32768);
+    configureDisks(false);
+
+    for (const auto &dir: { small, large }) {
+        CPPUNIT_ASSERT_EQUAL(int64_t(0), dir->sizeClassMin());
+        CPPUNIT_ASSERT_EQUAL(int64_t(-1), dir->sizeClassMax());
+    }
+
+    // without size classes, any cache_dir may get a small object
+    CPPUNIT_ASSERT(mayBeSelected(entryOfSize(100), large));
+}
+
+void
+TestStoreSizeClasses::testClassBoundaries()
+{
+    const auto medium = addSwapDir(16384);
+    const auto small = addSwapDir(4096);
+    const auto unsplit = addSwapDir(0);
+    const auto large = addSwapDir(32768);
+    const auto small2 = addSwapDir(4096);
+    configureDisks(true);
+
+    // the smallest unit also gets objects smaller than all units
+    for (const auto &dir: { small, small2 }) {
+        CPPUNIT_ASSERT_EQUAL(int64_t(0), dir->sizeClassMin());
+        CPPUNIT_ASSERT_EQUAL(int64_t(16384), dir->sizeClassMax());
+    }
+    CPPUNIT_ASSERT_EQUAL(int64_t(16384), medium->sizeClassMin());
+    CPPUNIT_ASSERT_EQUAL(int64_t(32768), medium->sizeClassMax());
+    // the largest unit also gets objects larger than all units
+    CPPUNIT_ASSERT_EQUAL(int64_t(32768), large->sizeClassMin());
+    CPPUNIT_ASSERT_EQUAL(int64_t(-1), large->sizeClassMax());
+    // cache_dirs without allocation units get all objects
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), unsplit->sizeClassMin());
+    CPPUNIT_ASSERT_EQUAL(int64_t(-1), unsplit->sizeClassMax());
+
+    CPPUNIT_ASSERT(small->sizeClassFits(0));
+    CPPUNIT_ASSERT(small->sizeClassFits(16383));
+    CPPUNIT_ASSERT(!small->sizeClassFits(16384));
+    CPPUNIT_ASSERT(medium->sizeClassFits(16384));
+    CPPUNIT_ASSERT(!medium->sizeClassFits(32768));
+    CPPUNIT_ASSERT(!large->sizeClassFits(32767));
+    CPPUNIT_ASSERT(large->sizeClassFits(1024*1024*1024));
+    CPPUNIT_ASSERT(unsplit->sizeClassFits(0));
+
+    // reconfiguration with the option turned off removes the classes
+    configureDisks(false);
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), large->sizeClassMin());
+    CPPUNIT_ASSERT_EQUAL(int64_t(-1), small->sizeClassMax());
+}
+
+void
+TestStoreSizeClasses::testKnownSizeSelection()
+{
+    const auto small = addSwapDir(4096);
+    const auto large = addSwapDir(32768);
+    configureDisks(true);
+
+    CPPUNIT_ASSERT(!mayBeSelected(entryOfSize(0), large));
+    CPPUNIT_ASSERT(!mayBeSelected(entryOfSize(32767), large));
+    CPPUNIT_ASSERT(!mayBeSelected(entryOfSize(32768), small));
+    CPPUNIT_ASSERT(!mayBeSelected(entryOfSize(500000), small));
+    CPPUNIT_ASSERT_EQUAL(static_cast<SwapDir*>(small.getRaw()), Store::Disks::SelectSwapDir(entryOfSize(100)));
+    CPPUNIT_ASSERT_EQUAL(static_cast<SwapDir*>(large.getRaw()), Store::Disks::SelectSwapDir(entryOfSize(100000)));
+}
+
+void
+TestStoreSizeClasses::testUnknownSizeSelection()
+{
+    const auto small = addSwapDir(4096);
+    const auto large = addSwapDir(32768);
+    configureDisks(true);
+
+    // Zero accumulated bytes would place the object in the smallest class,
+    // but objects of unknown size are selected as if there were no classes.
+    const auto e = entryOfSize(-1);
+    CPPUNIT_ASSERT_EQUAL(int64_t(-1), e->mem_obj->expectedReplySize());
+    CPPUNIT_ASSERT(mayBeSelected(e, large));
+    CPPUNIT_ASSERT(mayBeSelected(e, small));
+}
+
+// This test uses main() from ./testStore.cc.
+
@@ -7,10 +7,19 @@
  */
 
 #include "squid.h"
+#include "base/AsyncCallQueue.h"
+#include "comm/Connection.h"
+#include "comm/IoCallback.h"
+#include "comm/Write.h"
+#include "CommCalls.h"
 #include "compat/cppunit.h"
 #include "DiskIO/DiskIOModule.h"
+#include "fd.h"
 #include "fde.h"
+#include "fs_io.h"
+#include "fs/ufs/RebuildReader.h"
 #include "fs/ufs/UFSSwapDir.h"
+#include "fs/ufs/UFSSwapLogParser.h"
 #include "globals.h"
 #include "HttpHeader.h"
 #include "HttpReply.h"
@@ -19,10 +28,19 @@
 #include "SquidConfig.h"
 #include "Store.h"
 #include "store/Disks.h"
+#include "StoreSwapLogData.h"
+#include "swap_log_op.h"
 #include "testStoreSupport.h"
 #include "unitTestMain.h"
 
+#include <cstdio>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#if HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#include <sys/stat.h>
 
 #define TESTDIR "TestUfs_Store"
 
@@ -35,6 +53,12 @@ class TestUfs : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST_SUITE(TestUfs);
     CPPUNIT_TEST(testUfsSearch);
     CPPUNIT_TEST(testUfsDefaultEngine);
+    CPPUNIT_TEST(testRebuildReaderDirectories);
+    CPPUNIT_TEST(testRebuildReaderSwapLog);
+    CPPUNIT_TEST(testSharedFile);
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+    CPPUNIT_TEST(testSendFile);
+#endif
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -42,6 +66,12 @@ protected:
     void commonInit();
     void testUfsSearch();
     void testUfsDefaultEngine();
+    void testRebuildReaderDirectories();
+    void testRebuildReaderSwapLog();
+    void testSharedFile();
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+    void testSendFile();
+#endif
 };
 CPPUNIT_TEST_SUITE_REGISTRATION(TestUfs);
 
@@ -200,6 +230,17 @@ TestUfs::testUfsSearch()
     CPPUNIT_ASSERT_EQUAL(false, search->isDone());
     CPPUNIT_ASSERT(search->currentItem() != nullptr);
 
+    /* the entry file is what disk_hit_zero_copy sends hit bodies from */
+    {
+        const auto &found = *search->currentItem();
+        const auto fd = aStore->openEntryFile(found);
+        CPPUNIT_ASSERT(fd >= 0);
+        struct stat sb;
+        CPPUNIT_ASSERT_EQUAL(0, fstat(fd, &sb));
+        CPPUNIT_ASSERT_EQUAL(static_cast<off_t>(found.swap_file_sz), sb.st_size);
+        file_close(fd);
+    }
+
     /* trigger another callback */
     cbcalled = false;
     search->next(searchCallback, nullptr);
@@ -255,6 +296,240 @@ TestUfs::testUfsDefaultEngine()
         throw std::runtime_error("Failed to clean test work directory");
 }
 
+/// creates a file with the given number of bytes
+static void
+makeTestFile(const char *name, const size_t size)
+{
+    const auto fp = fopen(name, "wb");
+    CPPUNIT_ASSERT(fp);
+    const std::string content(size, 'x');
+    CPPUNIT_ASSERT_EQUAL(size, fwrite(content.data(), 1, content.size(), fp));
+    fclose(fp);
+}
+
+/// RebuildReader threads load files from all given directories
+void
+TestUfs::testRebuildReaderDirectories()
+{
+    if (0 > system ("rm -rf " TESTDIR " && mkdir -p " TESTDIR "/00/00 " TESTDIR "/00/01"))
+        throw std::runtime_error("Failed to prepare test work directory");
+
+    makeTestFile(TESTDIR "/00/00/00000000", 3);
+    makeTestFile(TESTDIR "/00/01/00000001", 5000);
+    makeTestFile(TESTDIR "/00/01/not-a-cache-file", 1);
+
+    std::vector<Fs::Ufs::RebuildReader::Directory> directories(3);
+    directories[0].path = TESTDIR "/00/00";
+    directories[1].path = TESTDIR "/00/01";
+    directories[1].l2 = 1;
+    directories[2].path = TESTDIR "/00/02"; // missing
+    directories[2].l2 = 2;
+
+    size_t scanned = 0;
+    size_t loaded = 0;
+    size_t failed = 0;
+    {
+        Fs::Ufs::RebuildReader reader(directories, 2);
+        Fs::Ufs::RebuildReader::Batch batch;
+        while (reader.get(batch, true)) {
+            scanned += batch.scannedDirectories;
+            for (const auto &file: batch.files) {
+                if (file.failedCall) {
+                    CPPUNIT_ASSERT_EQUAL(std::string("opendir"), std::string(file.failedCall));
+                    CPPUNIT_ASSERT_EQUAL(2, file.directory->l2);
+                    ++failed;
+                    continue;
+                }
+
+                ++loaded;
+                if (file.fileno == 0) {
+                    CPPUNIT_ASSERT_EQUAL(uint64_t(3), file.size);
+                    CPPUNIT_ASSERT_EQUAL(size_t(3), file.meta.size());
+                } else {
+                    CPPUNIT_ASSERT_EQUAL(1, file.fileno);
+                    CPPUNIT_ASSERT_EQUAL(1, file.directory->l2);
+                    CPPUNIT_ASSERT_EQUAL(uint64_t(5000), file.size);
+                    CPPUNIT_ASSERT_EQUAL(size_t(SM_PAGE_SIZE - 1), file.meta.size());
+                }
+            }
+        }
+        CPPUNIT_ASSERT(reader.exhausted());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3), scanned);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), loaded);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), failed);
+
+    if (0 > system ("rm -rf " TESTDIR))
+        throw std::runtime_error("Failed to clean test work directory");
+}
+
+/// a RebuildReader thread loads all swap.state records in their log order
+void
+TestUfs::testRebuildReaderSwapLog()
+{
+    if (0 > system ("rm -rf " TESTDIR " && mkdir -p " TESTDIR))
+        throw std::runtime_error("Failed to prepare test work directory");
+
+    const int recordCount = 2500; // more than one batch
+    {
+        const auto fp = fopen(TESTDIR "/swap.state", "wb");
+        CPPUNIT_ASSERT(fp);
+        const StoreSwapLogHeader header;
+        std::string headerRecord(header.record_size, '\0');
+        memcpy(&headerRecord[0], &header, sizeof(header));
+        CPPUNIT_ASSERT_EQUAL(size_t(1), fwrite(headerRecord.data(), headerRecord.size(), 1, fp));
+        for (int i = 0; i < recordCount; ++i) {
+            StoreSwapLogData record;
+            record.op = SWAP_LOG_ADD;
+            record.swap_filen = i;
+            CPPUNIT_ASSERT_EQUAL(size_t(1), fwrite(&record, sizeof(record), 1, fp));
+        }
+        fclose(fp);
+    }
+
+    const auto fp = fopen(TESTDIR "/swap.state", "rb");
+    CPPUNIT_ASSERT(fp);
+    const std::unique_ptr<Fs::Ufs::UFSSwapLogParser> parser(Fs::Ufs::UFSSwapLogParser::GetUFSSwapLogParser(fp));
+    CPPUNIT_ASSERT(parser);
+
+    int loaded = 0;
+    {
+        Fs::Ufs::RebuildReader reader(*parser);
+        Fs::Ufs::RebuildReader::Batch batch;
+        while (reader.get(batch, true)) {
+            CPPUNIT_ASSERT(batch.files.empty());
+            for (const auto &record: batch.records) {
+                CPPUNIT_ASSERT_EQUAL(loaded, record.swap_filen);
+                ++loaded;
+            }
+        }
+        CPPUNIT_ASSERT(reader.exhausted());
+    }
+    CPPUNIT_ASSERT_EQUAL(recordCount, loaded);
+    parser->Close();
+
+    if (0 > system ("rm -rf " TESTDIR))
+        throw std::runtime_error("Failed to clean test work directory");
+}
+
+/// creates a file with the given content and opens it for reading
+static int
+OpenTestFile(const char *path, const std::string &content)
+{
+    const auto fp = fopen(path, "wb");
+    CPPUNIT_ASSERT(fp);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), fwrite(content.data(), content.size(), 1, fp));
+    fclose(fp);
+    const auto fd = file_open(path, O_RDONLY | O_BINARY);
+    CPPUNIT_ASSERT(fd >= 0);
+    return fd;
+}
+
+/// the last file is closed by the last SharedFile user
+void
+TestUfs::testSharedFile()
+{
+    commonInit();
+    if (0 > system ("rm -rf " TESTDIR " && mkdir -p " TESTDIR))
+        throw std::runtime_error("Failed to prepare test work directory");
+
+    const auto fd = OpenTestFile(TESTDIR "/shared", "content");
+    SharedFile::Pointer file = new SharedFile(fd);
+    SharedFile::Pointer sender = file; // e.g., a pending Comm::SendFile()
+    CPPUNIT_ASSERT(fd_table[fd].flags.open);
+
+    file = nullptr; // e.g., the transaction is gone
+    CPPUNIT_ASSERT(fd_table[fd].flags.open);
+
+    sender = nullptr;
+    CPPUNIT_ASSERT(!fd_table[fd].flags.open);
+
+    if (0 > system ("rm -rf " TESTDIR))
+        throw std::runtime_error("Failed to clean test work directory");
+}
+
+#if HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+
+/// the results of the last Comm::SendFile() reported to SendFileDone()
+static Comm::Flag SentFlag = Comm::COMM_ERROR;
+static size_t SentSize = 0;
+
+static void
+SendFileDone(const Comm::ConnectionPointer &, char *, size_t size, Comm::Flag flag, int, void *)
+{
+    SentFlag = flag;
+    SentSize = size;
+}
+
+/// Comm::SendFile() sends the requested file region, even when the socket
+/// accepts it in many small pieces
+void
+TestUfs::testSendFile()
+{
+    commonInit();
+    if (0 > system ("rm -rf " TESTDIR " && mkdir -p " TESTDIR))
+        throw std::runtime_error("Failed to prepare test work directory");
+
+    std::string content(200*1024, '\0');
+    for (size_t i = 0; i < content.size(); ++i)
+        content[i] = 'a' + (i % 23);
+    const SharedFile::Pointer file = new SharedFile(OpenTestFile(TESTDIR "/body", content));
+
+    int sockets[2];
+    CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    const int sendBufSize = 4096; // force partial sendfile(2) calls
+    CPPUNIT_ASSERT_EQUAL(0, setsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &sendBufSize, sizeof(sendBufSize)));
+    CPPUNIT_ASSERT_EQUAL(0, fcntl(sockets[0], F_SETFL, O_NONBLOCK));
+    CPPUNIT_ASSERT_EQUAL(0, fcntl(sockets[1], F_SETFL, O_NONBLOCK));
+    fd_open(sockets[0], FD_SOCKET, "TestUfs::testSendFile");
+    CPPUNIT_ASSERT(fd_table[sockets[0]].writesDirectly());
+
+    Comm::ConnectionPointer conn = new Comm::Connection;
+    conn->fd = sockets[0];
+
+    const int64_t offset = 1000;
+    const int size = 150*1024;
+    SentFlag = Comm::COMM_ERROR;
+    SentSize = 0;
+    AsyncCall::Pointer callback = commCbCall(5, 5, "SendFileDone", CommIoCbPtrFun(&SendFileDone, nullptr));
+    Comm::SendFile(conn, file->fd, offset, size, callback);
+
+    // emulate write readiness notifications while draining the socket
+    std::string received;
+    auto state = COMMIO_FD_WRITECB(sockets[0]);
+    for (int steps = 0; state->active() && steps < 10000; ++steps) {
+        Comm::HandleWrite(sockets[0], state);
+        char buf[16*1024];
+        const auto readSize = read(sockets[1], buf, sizeof(buf));
+        if (readSize > 0)
+            received.append(buf, readSize);
+    }
+    CPPUNIT_ASSERT(!state->active());
+    AsyncCallQueue::Instance().fire();
+    CPPUNIT_ASSERT_EQUAL(Comm::OK, SentFlag);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(size), SentSize);
+
+    for (char buf[16*1024];;) {
+        const auto readSize = read(sockets[1], buf, sizeof(buf));
+        if (readSize <= 0)
+            break;
+        received.append(buf, readSize);
+    }
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(size), received.size());
+    CPPUNIT_ASSERT(received == content.substr(offset, size));
+
+    conn->noteClosure();
+    fd_close(sockets[0]);
+    close(sockets[0]);
+    close(sockets[1]);
+
+    if (0 > system ("rm -rf " TESTDIR))
+        throw std::runtime_error("Failed to clean test work directory");
+}
+
+#endif /* HAVE_SENDFILE && HAVE_SYS_SENDFILE_H */
+
 int
 main(int argc, char *argv[])
 {
@@ -22,8 +22,10 @@
 #include "comm.h"
 #include "comm/Connection.h"
 #include "comm/ConnOpener.h"
+#include "comm/Loops.h"
 #include "comm/Read.h"
 #include "comm/Write.h"
+#include "compat/unistd.h"
 #include "errorpage.h"
 #include "fd.h"
 #include "fde.h"
@@ -57,6 +59,9 @@
 
 #include <climits>
 #include <cerrno>
+#if HAVE_SPLICE
+#include <fcntl.h>
+#endif
 
 /**
  * TunnelStateData is the state engine performing the tasks for
@@ -178,6 +183,30 @@ public:
         TunnelStateData *readPending;
         EVH *readPendingFunc;
 
+#if HAVE_SPLICE
+        /// whether we have a pipe for zero-copy relaying of our bytes
+        bool hasPipe() const { return pipeFds[0] >= 0; }
+
+        /// creates a pipe for zero-copy relaying of our bytes (if possible)
+        bool openPipe();
+
+        /// kernel pipe with bytes read from us but not yet written to the
+        /// other side; an alternative to buf
+        int pipeFds[2] = { -1, -1 };
+
+        /// whether our len bytes are stored in pipeFds rather than buf
+        bool piped = false;
+
+        /// how many of our len piped bytes are yet to be written
+        size_t pipeLeft = 0;
+
+        /// a pending splice(2)-based read completion callback
+        AsyncCall::Pointer pipeReader;
+
+        /// whether an event checks our splice(2)-based writes for write_timeout
+        bool spliceWriteTimeoutScheduled = false;
+#endif
+
 #if USE_DELAY_POOLS
 
         DelayId delayId;
@@ -289,6 +318,20 @@ public:
     void copyClientBytes();
     void copyServerBytes();
 
+#if HAVE_SPLICE
+    bool canSplice(Connection &from, const Connection &to) const;
+    void spliceRead(Connection &from, IOCB *completion, int size);
+    void spliceWrite(Connection &from, Connection &to, IOCB *completion);
+    /// the descriptor of the `from` connection has bytes to splice(2)
+    void noteSpliceReadable(Connection &from);
+    /// the descriptor of the `to` connection has space for spliced bytes
+    void noteSpliceWritable(Connection &from, Connection &to);
+    /// checks the pending splice(2)-based write to `to` after `delay` seconds
+    void scheduleSpliceWriteTimeout(Connection &to, double delay);
+    /// fails the pending splice(2)-based write to `to` if it exceeded write_timeout
+    void noteSpliceWriteTimeout(Connection &from, Connection &to);
+#endif
+
     /// handles client-to-Squid connection closure; may destroy us
     void clientClosed();
 
@@ -306,6 +349,14 @@ static CLCB tunnelClientClosed;
 static CTCB tunnelTimeout;
 static EVH tunnelDelayedClientRead;
 static EVH tunnelDelayedServerRead;
+#if HAVE_SPLICE
+static PF tunnelSpliceFromClient;
+static PF tunnelSpliceFromServer;
+static PF tunnelSpliceToClient;
+static PF tunnelSpliceToServer;
+static EVH tunnelSpliceToClientTimeout;
+static EVH tunnelSpliceToServerTimeout;
+#endif
 
 static std::ostream &
 operator <<(std::ostream &os, const TunnelStateData::Connection &c)
@@ -319,6 +370,11 @@ operator <<(std::ostream &os, const TunnelStateData::Connection &c)
     if (c.len)
         os << " buf=" << c.len;
 
+#if HAVE_SPLICE
+    if (c.piped)
+        os << " piped";
+#endif
+
     if (c.writer)
         os << " writing";
     else if (!c.dirty)
@@ -496,9 +552,43 @@ TunnelStateData::Connection::~Connection()
     if (readPending)
         eventDelete(readPendingFunc, readPending);
 
+#if HAVE_SPLICE
+    for (const auto pipeFd: pipeFds) {
+        if (pipeFd >= 0) {
+            fd_close(pipeFd);
+            xclose(pipeFd);
+        }
+    }
+#endif
+
     safe_free(buf);
 }
 
+#if HAVE_SPLICE
+bool
+TunnelStateData::Connection::openPipe()
+{
+    if (hasPipe())
+        return true;
+
+    // leave enough descriptors for regular connections
+    if (fdNFree() < RESERVED_FD + 2)
+        return false;
+
+    if (pipe2(pipeFds, O_NONBLOCK|O_CLOEXEC) != 0) {
+        const auto xerrno = errno;
+        debugs(26, 3, "cannot open a splice pipe for " << *this << ": " << xstrerr(xerrno));
+        pipeFds[0] = pipeFds[1] = -1;
+        return false;
+    }
+
+    fd_open(pipeFds[0], FD_PIPE, "tunnel splice pipe reader");
+    fd_open(pipeFds[1], FD_PIPE, "tunnel splice pipe writer");
+    debugs(26, 5, *this << " splices via FDs " << pipeFds[0] << ", " << pipeFds[1]);
+    return true;
+}
+#endif
+
 const char *
 TunnelStateData::checkRetry()
 {
@@ -760,6 +850,14 @@ TunnelStateData::keepGoingAfterRead(size_t len, Comm::Flag errcode, int xerrno,
 void
 TunnelStateData::copy(size_t len, Connection &from, Connection &to, IOCB *completion)
 {
+#if HAVE_SPLICE
+    if (from.piped) {
+        Assure(len == from.pipeLeft);
+        spliceWrite(from, to, completion);
+        return;
+    }
+#endif
+
     debugs(26, 3, "Schedule Write");
     AsyncCall::Pointer call = commCbCall(5,5, "TunnelBlindCopyWriteHandler",
                                          CommIoCbPtrFun(completion, this));
@@ -999,11 +1097,233 @@ TunnelStateData::copyRead(Connection &from, Connection &to, IOCB * const complet
         return;
     }
 
+#if HAVE_SPLICE
+    if (canSplice(from, to)) {
+        spliceRead(from, completion, bw);
+        return;
+    }
+#endif
+
     AsyncCall::Pointer call = commCbCall(5,4, "TunnelBlindCopyReadHandler",
                                          CommIoCbPtrFun(completion, this));
     comm_read(from.conn, from.buf, bw, call);
 }
 
+#if HAVE_SPLICE
+/// whether we should relay the next `from` bytes using splice(2)
+bool
+TunnelStateData::canSplice(Connection &from, const Connection &to) const
+{
+    if (!Config.onoff.tunnel_zero_copy)
+        return false;
+
+    // splice(2) bypasses any read/write transformations (e.g., TLS)
+    if (!fd_table[from.conn->fd].readsDirectly() || !Comm::IsConnOpen(to.conn) ||
+            !fd_table[to.conn->fd].writesDirectly())
+        return false;
+
+    return from.openPipe();
+}
+
+/// waits for `from` bytes to splice(2) into its pipe, emulating comm_read()
+void
+TunnelStateData::spliceRead(Connection &from, IOCB *completion, const int size)
+{
+    debugs(26, 5, from << " up to " << size << " bytes");
+    Assure(!from.piped);
+    Assure(size > 0);
+    from.pipeReader = commCbCall(5,4, "TunnelSpliceReadHandler",
+                                 CommIoCbPtrFun(completion, this));
+    Comm::SetSelect(from.conn->fd, COMM_SELECT_READ,
+                    (&from == &client ? tunnelSpliceFromClient : tunnelSpliceFromServer), this, 0);
+}
+
+void
+TunnelStateData::noteSpliceReadable(Connection &from)
+{
+    Assure(from.pipeReader);
+
+    // delay pools may have changed their mind since spliceRead()
+    const auto size = from.bytesWanted(1, SQUID_TCP_SO_RCVBUF);
+    const auto result = splice(from.conn->fd, nullptr, from.pipeFds[1], nullptr, size,
+                               SPLICE_F_MOVE|SPLICE_F_NONBLOCK);
+    const auto xerrno = errno;
+    ++statCounter.syscalls.sock.reads;
+    debugs(26, 5, from << " spliced " << result << " out of " << size << " bytes");
+
+    if (result < 0 && ignoreErrno(xerrno)) {
+        Comm::SetSelect(from.conn->fd, COMM_SELECT_READ,
+                        (&from == &client ? tunnelSpliceFromClient : tunnelSpliceFromServer), this, 0);
+        return;
+    }
+
+    auto &params = GetCommParams<CommIoCbParams>(from.pipeReader);
+    params.conn = from.conn;
+    params.buf = nullptr;
+    if (result < 0) {
+        params.flag = Comm::COMM_ERROR;
+        params.xerrno = xerrno;
+        params.size = 0;
+    } else {
+        params.flag = Comm::OK;
+        params.size = result;
+        if (result > 0) {
+            from.piped = true;
+            from.pipeLeft = result;
+        }
+        fd_bytes(from.conn->fd, result, IoDirection::Read);
+    }
+    ScheduleCallHere(from.pipeReader);
+    from.pipeReader = nullptr;
+}
+
+/// waits for `to` to accept bytes piped from `from`, emulating Comm::Write()
+void
+TunnelStateData::spliceWrite(Connection &from, Connection &to, IOCB *completion)
+{
+    debugs(26, 5, from.pipeLeft << " bytes from " << from << " to " << to);
+    to.writer = commCbCall(5,5, "TunnelSpliceWriteHandler",
+                           CommIoCbPtrFun(completion, this));
+    to.dirty = true;
+    // Comm::Write() timeouts do not cover us; see noteSpliceWriteTimeout()
+    fd_table[to.conn->fd].writeStart = squid_curtime;
+    scheduleSpliceWriteTimeout(to, Config.Timeout.write);
+    Comm::SetSelect(to.conn->fd, COMM_SELECT_WRITE,
+                    (&to == &client ? tunnelSpliceToClient : tunnelSpliceToServer), this, 0);
+}
+
+void
+TunnelStateData::scheduleSpliceWriteTimeout(Connection &to, const double delay)
+{
+    if (to.spliceWriteTimeoutScheduled)
+        return; // the already scheduled check will reschedule itself as needed
+    to.spliceWriteTimeoutScheduled = true;
+    eventAdd("tunnelSpliceWriteTimeout",
+             (&to == &client ? tunnelSpliceToClientTimeout : tunnelSpliceToServerTimeout),
+             this, delay, 0, true);
+}
+
+/// Emulates the comm.cc write_timeout check for splice(2)-based writes:
+/// fails the write if `to` has not accepted any piped bytes for too long.
+void
+TunnelStateData::noteSpliceWriteTimeout(Connection &from, Connection &to)
+{
+    to.spliceWriteTimeoutScheduled = false;
+
+    if (!from.piped || !to.writer || !Comm::IsConnOpen(to.conn))
+        return; // no splice(2)-based write is pending
+
+    const auto idle = squid_curtime - fd_table[to.conn->fd].writeStart;
+    if (idle < Config.Timeout.write) {
+        scheduleSpliceWriteTimeout(to, Config.Timeout.write - idle);
+        return;
+    }
+
+    debugs(26, 3, to << " accepted no piped bytes for " << idle << " seconds");
+    Comm::SetSelect(to.conn->fd, COMM_SELECT_WRITE, nullptr, nullptr, 0);
+    auto &params = GetCommParams<CommIoCbParams>(to.writer);
+    params.conn = to.conn;
+    params.buf = nullptr;
+    params.flag = Comm::COMM_ERROR;
+    params.xerrno = ETIMEDOUT;
+    params.size = 0;
+    ScheduleCallHere(to.writer);
+    // to.writer is cleared by the write completion handler
+}
+
+void
+TunnelStateData::noteSpliceWritable(Connection &from, Connection &to)
+{
+    Assure(from.piped);
+
+    const auto result = splice(from.pipeFds[0], nullptr, to.conn->fd, nullptr, from.pipeLeft,
+                               SPLICE_F_MOVE|SPLICE_F_NONBLOCK);
+    const auto xerrno = errno;
+    ++statCounter.syscalls.sock.writes;
+    debugs(26, 5, to << " took " << result << " out of " << from.pipeLeft << " piped bytes");
+
+    if (result > 0) {
+        fd_bytes(to.conn->fd, result, IoDirection::Write);
+        from.pipeLeft -= result;
+        fd_table[to.conn->fd].writeStart = squid_curtime;
+    }
+
+    if ((result > 0 && from.pipeLeft) || (result < 0 && ignoreErrno(xerrno))) {
+        Comm::SetSelect(to.conn->fd, COMM_SELECT_WRITE,
+                        (&to == &client ? tunnelSpliceToClient : tunnelSpliceToServer), this, 0);
+        return;
+    }
+
+    if (!to.writer)
+        return; // to.conn closure is in progress
+
+    auto &params = GetCommParams<CommIoCbParams>(to.writer);
+    params.conn = to.conn;
+    params.buf = nullptr;
+    if (result <= 0) {
+        // like Comm::Write(), treat zero-size writes of pending bytes as errors
+        params.flag = Comm::COMM_ERROR;
+        params.xerrno = result < 0 ? xerrno : 0;
+        params.size = 0;
+        // the pipe contents are useless now; the tunnel is going to end
+    } else {
+        params.flag = Comm::OK;
+        params.size = from.len;
+        from.piped = false;
+    }
+    ScheduleCallHere(to.writer);
+    // to.writer is cleared by the write completion handler
+}
+
+/// Comm::SetSelect() handler for splice(2)-based reads from the client
+static void
+tunnelSpliceFromClient(int, void *data)
+{
+    const auto tunnel = static_cast<TunnelStateData *>(data);
+    tunnel->noteSpliceReadable(tunnel->client);
+}
+
+/// Comm::SetSelect() handler for splice(2)-based reads from the server
+static void
+tunnelSpliceFromServer(int, void *data)
+{
+    const auto tunnel = static_cast<TunnelStateData *>(data);
+    tunnel->noteSpliceReadable(tunnel->server);
+}
+
+/// Comm::SetSelect() handler for splice(2)-based writes to the client
+static void
+tunnelSpliceToClient(int, void *data)
+{
+    const auto tunnel = static_cast<TunnelStateData *>(data);
+    tunnel->noteSpliceWritable(tunnel->server, tunnel->client);
+}
+
+/// Comm::SetSelect() handler for splice(2)-based writes to the server
+static void
+tunnelSpliceToServer(int, void *data)
+{
+    const auto tunnel = static_cast<TunnelStateData *>(data);
+    tunnel->noteSpliceWritable(tunnel->client, tunnel->server);
+}
+
+/// eventAdd() handler checking splice(2)-based writes to the client
+static void
+tunnelSpliceToClientTimeout(void *data)
+{
+    const auto tunnel = static_cast<TunnelStateData *>(data);
+    tunnel->noteSpliceWriteTimeout(tunnel->server, tunnel->client);
+}
+
+/// eventAdd() handler checking splice(2)-based writes to the server
+static void
+tunnelSpliceToServerTimeout(void *data)
+{
+    const auto tunnel = static_cast<TunnelStateData *>(data);
+    tunnel->noteSpliceWriteTimeout(tunnel->client, tunnel->server);
+}
+#endif /* HAVE_SPLICE */
+
 void
 TunnelStateData::copyClientBytes()
 {